@@ -0,0 +1,65 @@
+/** @file ConstexprEnumBenchmarks.cpp
+ *
+ *  Benchmarks for pistis::typeutil::ConstexprEnum
+ */
+
+#include <pistis/typeutil/ConstexprEnum.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <string>
+
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  class Level : public ConstexprEnum<Level> {
+  public:
+    static const Level TRACE;
+    static const Level DEBUG;
+    static const Level INFO;
+    static const Level WARN;
+    static const Level ERROR;
+    static const Level FATAL;
+
+    static constexpr auto TABLE = makeConstexprEnumTable<int>({
+      { 0, "TRACE" }, { 1, "DEBUG" }, { 2, "INFO" }, { 3, "WARN" },
+      { 4, "ERROR" }, { 5, "FATAL" }
+    });
+
+  private:
+    friend class ConstexprEnum<Level>;
+    constexpr Level(uint32_t ordinal): ConstexprEnum(ordinal) { }
+  };
+
+  constexpr decltype(Level::TABLE) Level::TABLE;
+  constexpr Level Level::TRACE(TABLE.findName("TRACE"));
+  constexpr Level Level::DEBUG(TABLE.findName("DEBUG"));
+  constexpr Level Level::INFO(TABLE.findName("INFO"));
+  constexpr Level Level::WARN(TABLE.findName("WARN"));
+  constexpr Level Level::ERROR(TABLE.findName("ERROR"));
+  constexpr Level Level::FATAL(TABLE.findName("FATAL"));
+
+  const std::string NAMES[] = {
+    "TRACE", "DEBUG", "INFO", "WARN", "ERROR", "FATAL", "VERBOSE"
+  };
+}
+
+PISTIS_BENCHMARK(ConstexprEnum, FromValue) {
+  for (size_t i = 0; i < iterations; ++i) {
+    Level l = Level::fromValue((int)(i % 6));
+    doNotOptimize(l);
+  }
+}
+
+PISTIS_BENCHMARK(ConstexprEnum, TryFromName) {
+  for (size_t i = 0; i < iterations; ++i) {
+    Optional<Level> l = Level::tryFromName(NAMES[i % 7]);
+    doNotOptimize(l);
+  }
+}
+
+PISTIS_BENCHMARK(ConstexprEnum, Name) {
+  for (size_t i = 0; i < iterations; ++i) {
+    auto name = Level::fromOrdinal((uint32_t)(i % 6)).name();
+    doNotOptimize(name);
+  }
+}
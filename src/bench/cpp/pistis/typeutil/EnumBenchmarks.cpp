@@ -0,0 +1,284 @@
+/** @file EnumBenchmarks.cpp
+ *
+ *  Benchmarks for pistis::typeutil::Enum
+ */
+
+#include <pistis/typeutil/Enum.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <vector>
+#include <ctype.h>
+
+using namespace pistis::exceptions;
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  class Color : public Enum<Color> {
+  public:
+    static const Color RED;
+    static const Color GREEN;
+    static const Color BLUE;
+
+  public:
+    Color(): Enum<Color>(RED) { }
+
+  private:
+    Color(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const Color Color::RED(1, "RED");
+  const Color Color::GREEN(2, "GREEN");
+  const Color Color::BLUE(3, "BLUE");
+
+  // Enough members that their impls do not all stay in cache
+  template <typename ImplT>
+  class Code : public Enum<Code<ImplT>, ImplT> {
+  public:
+    static const std::vector< Code<ImplT> > ALL;
+
+  public:
+    static std::vector< Code<ImplT> > create(int n) {
+      std::vector< Code<ImplT> > codes;
+      for (int i = 0; i < n; ++i) {
+	std::ostringstream name;
+	name << "CODE_" << i;
+	codes.push_back(Code<ImplT>(i, name.str()));
+      }
+      return codes;
+    }
+
+  private:
+    Code(int value, const std::string& name):
+	Enum<Code<ImplT>, ImplT>(value, name) {
+    }
+  };
+
+  template <typename ImplT>
+  const std::vector< Code<ImplT> > Code<ImplT>::ALL =
+      Code<ImplT>::create(1 << 17);
+
+  // A column of one million names or values, one in eight invalid
+  const size_t COLUMN_SIZE= 1 << 20;
+
+  // Names stored back to back, as in an Arrow string column
+  struct NameColumn {
+    std::string data;
+    std::vector<uint32_t> offsets;
+
+    NameColumn(): offsets(1, 0) {
+      static const char* const NAMES[]= {
+	"RED", "GREEN", "BLUE", "RED", "GREEN", "BLUE", "RED", "PURPLE"
+      };
+      std::mt19937 rng(1);
+      for (size_t i= 0; i < COLUMN_SIZE; ++i) {
+	data+= NAMES[rng() % 8];
+	offsets.push_back((uint32_t)data.size());
+      }
+    }
+
+    size_t size() const { return offsets.size() - 1; }
+  };
+
+  std::vector<int> valueColumn() {
+    std::mt19937 rng(1);
+    std::vector<int> column;
+    for (size_t i= 0; i < COLUMN_SIZE; ++i) {
+      column.push_back(rng() % 8 ? 1 + (int)(rng() % 3) : 4);
+    }
+    return column;
+  }
+
+  template <typename ImplT>
+  void sortCodes(size_t iterations) {
+    std::vector< Code<ImplT> > shuffled(Code<ImplT>::ALL);
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(1));
+
+    for (size_t i = 0; i < iterations; ++i) {
+      std::vector< Code<ImplT> > v(shuffled);
+      std::sort(v.begin(), v.end());
+      doNotOptimize(v);
+    }
+  }
+}
+
+PISTIS_BENCHMARK(Enum, FromValueHit) {
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(Color::fromValue(1 + (int)(i % 3)));
+  }
+}
+
+PISTIS_BENCHMARK(Enum, FromValueMissThrows) {
+  for (size_t i = 0; i < iterations; ++i) {
+    try {
+      doNotOptimize(Color::fromValue(4 + (int)(i % 3)));
+    } catch(const NoSuchItem&) {
+    }
+  }
+}
+
+PISTIS_BENCHMARK(Enum, TryFromValueMiss) {
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(Color::tryFromValue(4 + (int)(i % 3)));
+  }
+}
+
+PISTIS_BENCHMARK(Enum, FromNameHit) {
+  static const char* const NAMES[] = { "RED", "GREEN", "BLUE" };
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(Color::fromName(NAMES[i % 3]));
+  }
+}
+
+PISTIS_BENCHMARK(Enum, FromNameMissThrows) {
+  static const char* const NAMES[] = { "CYAN", "MAGENTA", "YELLOW" };
+  for (size_t i = 0; i < iterations; ++i) {
+    try {
+      doNotOptimize(Color::fromName(NAMES[i % 3]));
+    } catch(const NoSuchItem&) {
+    }
+  }
+}
+
+PISTIS_BENCHMARK(Enum, TryFromNameMiss) {
+  static const char* const NAMES[] = { "CYAN", "MAGENTA", "YELLOW" };
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(Color::tryFromName(NAMES[i % 3]));
+  }
+}
+
+// User input whose case may not match the member names
+PISTIS_BENCHMARK(Enum, FromNameIgnoringCaseByUpperCasing) {
+  static const char* const NAMES[] = { "red", "Green", "blue", "Purple" };
+  for (size_t i = 0; i < iterations; ++i) {
+    std::string name(NAMES[i % 4]);
+    for (char& c : name) {
+      c = (char)toupper(c);
+    }
+    doNotOptimize(Color::tryFromName(name));
+  }
+}
+
+PISTIS_BENCHMARK(Enum, FromNameIgnoringCaseWithTrie) {
+  static const char* const NAMES[] = { "red", "Green", "blue", "Purple" };
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(Color::tryFromNameIgnoringCase(NAMES[i % 4]));
+  }
+}
+
+PISTIS_BENCHMARK(Enum, FromPrefixByScanningNames) {
+  static const char* const PREFIXES[] = { "r", "GR", "Blu", "bl" };
+  for (size_t i = 0; i < iterations; ++i) {
+    const StringView prefix(PREFIXES[i % 4]);
+    Optional<Color> found;
+    bool ambiguous = false;
+    for (const Color& c : Color::values()) {
+      const std::string& name = c.name();
+      bool match = name.size() >= prefix.size();
+      for (size_t j = 0; match && (j < prefix.size()); ++j) {
+	match = toupper(prefix.data()[j]) == name[j];
+      }
+      if (match) {
+	ambiguous = !found.empty();
+	found = makeOptional(c);
+      }
+    }
+    doNotOptimize(ambiguous ? Optional<Color>() : found);
+  }
+}
+
+PISTIS_BENCHMARK(Enum, FromPrefixWithTrie) {
+  static const char* const PREFIXES[] = { "r", "GR", "Blu", "bl" };
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(Color::tryFromPrefix(PREFIXES[i % 4]));
+  }
+}
+
+PISTIS_BENCHMARK(Enum, Sort128KPointerLayout) {
+  sortCodes< BasicEnumImpl<int> >(iterations);
+}
+
+PISTIS_BENCHMARK(Enum, Sort128KInlineLayout) {
+  sortCodes< InlineEnumImpl<int> >(iterations);
+}
+
+PISTIS_BENCHMARK(Enum, Decode1MNamesOneAtATime) {
+  static const NameColumn COLUMN;
+  std::vector<uint32_t> ordinals(COLUMN.size());
+  for (size_t i= 0; i < iterations; ++i) {
+    for (size_t j= 0; j < COLUMN.size(); ++j) {
+      Optional<Color> c= Color::tryFromName(
+	  COLUMN.data.data() + COLUMN.offsets[j],
+	  COLUMN.offsets[j + 1] - COLUMN.offsets[j]
+      );
+      ordinals[j]= c ? (uint32_t)c.value().ordinal() : ~(uint32_t)0;
+    }
+    doNotOptimize(ordinals);
+  }
+}
+
+PISTIS_BENCHMARK(Enum, Decode1MNamesInBulk) {
+  static const NameColumn COLUMN;
+  std::vector<uint32_t> ordinals(COLUMN.size());
+  std::vector<uint64_t> invalid((COLUMN.size() + 63) / 64);
+  for (size_t i= 0; i < iterations; ++i) {
+    doNotOptimize(Color::decodeNames(COLUMN.data.data(),
+				     COLUMN.offsets.data(), COLUMN.size(),
+				     ordinals.data(), invalid.data()));
+  }
+}
+
+PISTIS_BENCHMARK(Enum, Decode1MValuesOneAtATime) {
+  static const std::vector<int> COLUMN= valueColumn();
+  std::vector<uint32_t> ordinals(COLUMN.size());
+  for (size_t i= 0; i < iterations; ++i) {
+    for (size_t j= 0; j < COLUMN.size(); ++j) {
+      Optional<Color> c= Color::tryFromValue(COLUMN[j]);
+      ordinals[j]= c ? (uint32_t)c.value().ordinal() : ~(uint32_t)0;
+    }
+    doNotOptimize(ordinals);
+  }
+}
+
+PISTIS_BENCHMARK(Enum, Decode1MValuesInBulk) {
+  static const std::vector<int> COLUMN= valueColumn();
+  std::vector<uint32_t> ordinals(COLUMN.size());
+  std::vector<uint64_t> invalid((COLUMN.size() + 63) / 64);
+  for (size_t i= 0; i < iterations; ++i) {
+    doNotOptimize(Color::decodeValues(COLUMN.data(), COLUMN.size(),
+				      ordinals.data(), invalid.data()));
+  }
+}
+
+PISTIS_BENCHMARK(Enum, FormatWithOstream) {
+  std::ostringstream out;
+  for (size_t i= 0; i < iterations; ++i) {
+    out.str(std::string());
+    out << Color::values()[i % 3] << ' ' << Color::values()[(i + 1) % 3];
+    doNotOptimize(out);
+  }
+}
+
+PISTIS_BENCHMARK(Enum, FormatWithAppendTo) {
+  std::string out;
+  for (size_t i= 0; i < iterations; ++i) {
+    out.clear();
+    Color::values()[i % 3].appendTo(out);
+    out+= ' ';
+    Color::values()[(i + 1) % 3].appendTo(out);
+    doNotOptimize(out);
+  }
+}
+
+PISTIS_BENCHMARK(Enum, FormatWithFormatTo) {
+  char buffer[64];
+  for (size_t i= 0; i < iterations; ++i) {
+    size_t n= Color::values()[i % 3].formatTo(buffer, sizeof(buffer));
+    buffer[n++]= ' ';
+    n+= Color::values()[(i + 1) % 3].formatTo(buffer + n,
+					       sizeof(buffer) - n);
+    doNotOptimize(buffer);
+  }
+}
@@ -0,0 +1,111 @@
+/** @file EnumCatalogBenchmarks.cpp
+ *
+ *  Benchmarks for pistis::typeutil::EnumCatalog and CatalogEnum, against
+ *  an Enum with the same members registered at startup
+ */
+
+#include <pistis/typeutil/EnumCatalog.hpp>
+#include <pistis/typeutil/Enum.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  const int NUM_MEMBERS = 1 << 17;
+
+  std::string instrumentName(int i) {
+    std::ostringstream name;
+    name << "INSTRUMENT_" << i;
+    return name.str();
+  }
+
+  class StaticInstrument : public Enum<StaticInstrument> {
+  public:
+    static const std::vector<StaticInstrument> ALL;
+
+  public:
+    static std::vector<StaticInstrument> create() {
+      std::vector<StaticInstrument> instruments;
+      for (int i = 0; i < NUM_MEMBERS; ++i) {
+	instruments.push_back(StaticInstrument(i * 3, instrumentName(i)));
+      }
+      return instruments;
+    }
+
+  private:
+    StaticInstrument(int value, const std::string& name):
+	Enum(value, name) {
+    }
+  };
+
+  const std::vector<StaticInstrument> StaticInstrument::ALL =
+      StaticInstrument::create();
+
+  class Instrument : public CatalogEnum<Instrument, int> {
+  private:
+    friend class CatalogEnum<Instrument, int>;
+    Instrument(uint32_t ordinal): CatalogEnum(ordinal) { }
+  };
+
+  // Written and attached at startup, like the members of
+  // StaticInstrument, so the benchmarks time only the lookups
+  std::string writeCatalog() {
+    const std::string path = "/tmp/EnumCatalogBenchmarks.cat";
+    EnumCatalogWriter writer;
+    for (int i = 0; i < NUM_MEMBERS; ++i) {
+      writer.add(i * 3, instrumentName(i));
+    }
+    writer.write(path);
+    Instrument::load(path);
+    return path;
+  }
+
+  const std::string CATALOG_PATH = writeCatalog();
+
+  std::vector<std::string> lookupNames() {
+    std::vector<std::string> names;
+    for (int i = 0; i < 4096; ++i) {
+      names.push_back(instrumentName((i * 7919) % NUM_MEMBERS));
+    }
+    StaticInstrument::freeze();
+    return names;
+  }
+
+  const std::vector<std::string> NAMES = lookupNames();
+}
+
+PISTIS_BENCHMARK(EnumCatalog, Open128KMemberCatalog) {
+  for (size_t i = 0; i < iterations; ++i) {
+    const EnumCatalog catalog = EnumCatalog::open(CATALOG_PATH);
+    doNotOptimize(catalog.findName("INSTRUMENT_77"));
+  }
+}
+
+PISTIS_BENCHMARK(EnumCatalog, FromNameStaticEnum) {
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(StaticInstrument::fromName(NAMES[i % NAMES.size()]));
+  }
+}
+
+PISTIS_BENCHMARK(EnumCatalog, FromNameCatalogEnum) {
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(Instrument::fromName(NAMES[i % NAMES.size()]));
+  }
+}
+
+PISTIS_BENCHMARK(EnumCatalog, FromValueStaticEnum) {
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(StaticInstrument::fromValue((int)(i * 7919 % NUM_MEMBERS) * 3));
+  }
+}
+
+PISTIS_BENCHMARK(EnumCatalog, FromValueCatalogEnum) {
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(Instrument::fromValue((int)(i * 7919 % NUM_MEMBERS) * 3));
+  }
+}
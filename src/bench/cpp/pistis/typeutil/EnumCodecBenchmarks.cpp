@@ -0,0 +1,103 @@
+/** @file EnumCodecBenchmarks.cpp
+ *
+ *  Benchmarks for pistis::typeutil::EnumCodec
+ */
+
+#include <pistis/typeutil/EnumCodec.hpp>
+#include <pistis/typeutil/Enum.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  class Level : public Enum<Level> {
+  public:
+    static const Level TRACE;
+    static const Level DEBUG;
+    static const Level INFO;
+    static const Level WARNING;
+    static const Level ERROR;
+
+  public:
+    Level(): Enum<Level>(INFO) { }
+
+  private:
+    Level(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const Level Level::TRACE(-20, "TRACE");
+  const Level Level::DEBUG(-10, "DEBUG");
+  const Level Level::INFO(0, "INFO");
+  const Level Level::WARNING(10, "WARNING");
+  const Level Level::ERROR(20, "ERROR");
+
+  std::vector<Level> randomLevels() {
+    std::mt19937 rng(1);
+    std::vector<Level> levels;
+    for (size_t i = 0; i < (1 << 20); ++i) {
+      levels.push_back(Level::values()[rng() % Level::values().size()]);
+    }
+    return levels;
+  }
+}
+
+PISTIS_BENCHMARK(EnumCodec, Write1MNamesToOstream) {
+  static const std::vector<Level> LEVELS = randomLevels();
+  for (size_t i = 0; i < iterations; ++i) {
+    std::ostringstream out;
+    for (const Level& level : LEVELS) {
+      out << level << ' ';
+    }
+    doNotOptimize(out);
+  }
+}
+
+PISTIS_BENCHMARK(EnumCodec, Encode1MOrdinals) {
+  static const std::vector<Level> LEVELS = randomLevels();
+  std::vector<uint8_t> buffer;
+  for (size_t i = 0; i < iterations; ++i) {
+    buffer.clear();
+    EnumCodec<Level>::encodeOrdinals(LEVELS.data(), LEVELS.size(), buffer);
+    doNotOptimize(buffer);
+  }
+}
+
+PISTIS_BENCHMARK(EnumCodec, Decode1MOrdinals) {
+  static const std::vector<Level> LEVELS = randomLevels();
+  std::vector<uint8_t> buffer;
+  EnumCodec<Level>::encodeOrdinals(LEVELS.data(), LEVELS.size(), buffer);
+  std::vector<Level> decoded(LEVELS.size());
+  for (size_t i = 0; i < iterations; ++i) {
+    const uint8_t* p = buffer.data();
+    EnumCodec<Level>::decodeOrdinals(p, p + buffer.size(), decoded.data(),
+				     decoded.size());
+    doNotOptimize(decoded);
+  }
+}
+
+PISTIS_BENCHMARK(EnumCodec, Encode1MValues) {
+  static const std::vector<Level> LEVELS = randomLevels();
+  std::vector<uint8_t> buffer;
+  for (size_t i = 0; i < iterations; ++i) {
+    buffer.clear();
+    EnumCodec<Level>::encodeValues(LEVELS.data(), LEVELS.size(), buffer);
+    doNotOptimize(buffer);
+  }
+}
+
+PISTIS_BENCHMARK(EnumCodec, Decode1MValues) {
+  static const std::vector<Level> LEVELS = randomLevels();
+  std::vector<uint8_t> buffer;
+  EnumCodec<Level>::encodeValues(LEVELS.data(), LEVELS.size(), buffer);
+  std::vector<Level> decoded(LEVELS.size());
+  for (size_t i = 0; i < iterations; ++i) {
+    const uint8_t* p = buffer.data();
+    EnumCodec<Level>::decodeValues(p, p + buffer.size(), decoded.data(),
+				   decoded.size());
+    doNotOptimize(decoded);
+  }
+}
@@ -0,0 +1,120 @@
+/** @file EnumKeyedHashMapBenchmarks.cpp
+ *
+ *  Benchmarks for pistis::typeutil::EnumKeyedHashMap, against the
+ *  standard associative containers keyed by the same members
+ */
+
+#include <pistis/typeutil/EnumKeyedHashMap.hpp>
+#include <pistis/typeutil/Enum.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  // Enough members that a per-member array would mostly sit empty
+  class Sensor : public Enum<Sensor> {
+  public:
+    static const std::vector<Sensor> ALL;
+
+  public:
+    static std::vector<Sensor> create(int n) {
+      std::vector<Sensor> sensors;
+      for (int i = 0; i < n; ++i) {
+	std::ostringstream name;
+	name << "SENSOR_" << i;
+	sensors.push_back(Sensor(i, name.str()));
+      }
+      return sensors;
+    }
+
+  private:
+    Sensor(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const std::vector<Sensor> Sensor::ALL = Sensor::create(1 << 17);
+
+  // State is kept for 1024 of the members, which are then looked up in
+  // random order
+  const size_t NUM_KEYS = 1024;
+  const size_t NUM_LOOKUPS = 1 << 16;
+
+  std::vector<Sensor> keys() {
+    std::vector<Sensor> k(Sensor::ALL);
+    std::shuffle(k.begin(), k.end(), std::mt19937(1));
+    k.resize(NUM_KEYS, Sensor::ALL[0]);
+    return k;
+  }
+
+  std::vector<Sensor> lookups() {
+    static const std::vector<Sensor> KEYS = keys();
+    std::mt19937 rng(2);
+    std::vector<Sensor> l;
+    for (size_t i = 0; i < NUM_LOOKUPS; ++i) {
+      l.push_back(KEYS[rng() % NUM_KEYS]);
+    }
+    return l;
+  }
+
+  template <typename Map>
+  void insertKeys(size_t iterations) {
+    static const std::vector<Sensor> KEYS = keys();
+    for (size_t i = 0; i < iterations; ++i) {
+      Map m;
+      for (size_t j = 0; j < KEYS.size(); ++j) {
+	m[KEYS[j]] = (int)j;
+      }
+      doNotOptimize(m);
+    }
+  }
+
+  template <typename Map>
+  void lookUpKeys(size_t iterations) {
+    static const std::vector<Sensor> KEYS = keys();
+    static const std::vector<Sensor> LOOKUPS = lookups();
+    Map m;
+    for (size_t j = 0; j < KEYS.size(); ++j) {
+      m[KEYS[j]] = (int)j;
+    }
+
+    for (size_t i = 0; i < iterations; ++i) {
+      int total = 0;
+      for (const Sensor& s : LOOKUPS) {
+	total += m[s];
+      }
+      doNotOptimize(total);
+    }
+  }
+}
+
+PISTIS_ENUM_HASH(Sensor)
+
+PISTIS_BENCHMARK(EnumKeyedHashMap, Insert1KStdMap) {
+  insertKeys< std::map<Sensor, int> >(iterations);
+}
+
+PISTIS_BENCHMARK(EnumKeyedHashMap, Insert1KStdUnorderedMap) {
+  insertKeys< std::unordered_map<Sensor, int> >(iterations);
+}
+
+PISTIS_BENCHMARK(EnumKeyedHashMap, Insert1KEnumKeyedHashMap) {
+  insertKeys< EnumKeyedHashMap<Sensor, int> >(iterations);
+}
+
+PISTIS_BENCHMARK(EnumKeyedHashMap, LookUp64KStdMap) {
+  lookUpKeys< std::map<Sensor, int> >(iterations);
+}
+
+PISTIS_BENCHMARK(EnumKeyedHashMap, LookUp64KStdUnorderedMap) {
+  lookUpKeys< std::unordered_map<Sensor, int> >(iterations);
+}
+
+PISTIS_BENCHMARK(EnumKeyedHashMap, LookUp64KEnumKeyedHashMap) {
+  lookUpKeys< EnumKeyedHashMap<Sensor, int> >(iterations);
+}
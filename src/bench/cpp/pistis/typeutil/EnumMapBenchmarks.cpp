@@ -0,0 +1,74 @@
+/** @file EnumMapBenchmarks.cpp
+ *
+ *  Benchmarks for pistis::typeutil::EnumMap, against std::map
+ */
+
+#include <pistis/typeutil/EnumMap.hpp>
+#include <pistis/typeutil/Enum.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <map>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  class Counter : public Enum<Counter> {
+  public:
+    static const std::vector<Counter> ALL;
+
+  public:
+    static std::vector<Counter> create(int n) {
+      std::vector<Counter> counters;
+      for (int i = 0; i < n; ++i) {
+	std::ostringstream name;
+	name << "COUNTER_" << i;
+	counters.push_back(Counter(i, name.str()));
+      }
+      return counters;
+    }
+
+  private:
+    Counter(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const std::vector<Counter> Counter::ALL = Counter::create(64);
+
+  // Counters are incremented in random order
+  const size_t NUM_INCREMENTS = 4096;
+
+  std::vector<Counter> increments() {
+    std::mt19937 rng(1);
+    std::vector<Counter> v;
+    for (size_t i = 0; i < NUM_INCREMENTS; ++i) {
+      v.push_back(Counter::ALL[rng() % Counter::ALL.size()]);
+    }
+    return v;
+  }
+
+  const std::vector<Counter> INCREMENTS = increments();
+
+  template <typename Map>
+  void incrementCounters(size_t iterations) {
+    Map m;
+    for (const Counter& c : Counter::ALL) {
+      m[c] = 0;
+    }
+    for (size_t i = 0; i < iterations; ++i) {
+      for (const Counter& c : INCREMENTS) {
+	++m[c];
+      }
+      doNotOptimize(m);
+    }
+  }
+}
+
+PISTIS_BENCHMARK(EnumMap, Increment4KStdMap) {
+  incrementCounters< std::map<Counter, long> >(iterations);
+}
+
+PISTIS_BENCHMARK(EnumMap, Increment4KEnumMap) {
+  incrementCounters< EnumMap<Counter, long> >(iterations);
+}
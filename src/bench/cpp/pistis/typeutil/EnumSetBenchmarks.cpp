@@ -0,0 +1,119 @@
+/** @file EnumSetBenchmarks.cpp
+ *
+ *  Benchmarks for pistis::typeutil::EnumSet, against std::set
+ */
+
+#include <pistis/typeutil/EnumSet.hpp>
+#include <pistis/typeutil/Enum.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <random>
+#include <set>
+#include <sstream>
+#include <vector>
+
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  class Feature : public Enum<Feature> {
+  public:
+    static const std::vector<Feature> ALL;
+
+  public:
+    static std::vector<Feature> create(int n) {
+      std::vector<Feature> features;
+      for (int i = 0; i < n; ++i) {
+	std::ostringstream name;
+	name << "FEATURE_" << i;
+	features.push_back(Feature(i, name.str()));
+      }
+      return features;
+    }
+
+  private:
+    Feature(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const std::vector<Feature> Feature::ALL = Feature::create(512);
+
+  // Members are inserted and then looked up in random order
+  const size_t NUM_MEMBERS = 256;
+
+  std::vector<Feature> members(unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<Feature> m;
+    for (size_t i = 0; i < NUM_MEMBERS; ++i) {
+      m.push_back(Feature::ALL[rng() % Feature::ALL.size()]);
+    }
+    return m;
+  }
+
+  const std::vector<Feature> INSERTS = members(1);
+  const std::vector<Feature> LOOKUPS = members(2);
+
+  template <typename Set>
+  Set makeSet() {
+    Set s;
+    for (const Feature& f : INSERTS) {
+      s.insert(f);
+    }
+    return s;
+  }
+
+  const std::set<Feature> STD_SET = makeSet< std::set<Feature> >();
+  const EnumSet<Feature> ENUM_SET = makeSet< EnumSet<Feature> >();
+}
+
+PISTIS_BENCHMARK(EnumSet, Insert256StdSet) {
+  for (size_t i = 0; i < iterations; ++i) {
+    std::set<Feature> s = makeSet< std::set<Feature> >();
+    doNotOptimize(s);
+  }
+}
+
+PISTIS_BENCHMARK(EnumSet, Insert256EnumSet) {
+  for (size_t i = 0; i < iterations; ++i) {
+    EnumSet<Feature> s = makeSet< EnumSet<Feature> >();
+    doNotOptimize(s);
+  }
+}
+
+PISTIS_BENCHMARK(EnumSet, Contains256StdSet) {
+  for (size_t i = 0; i < iterations; ++i) {
+    size_t count = 0;
+    for (const Feature& f : LOOKUPS) {
+      count += STD_SET.count(f);
+    }
+    doNotOptimize(count);
+  }
+}
+
+PISTIS_BENCHMARK(EnumSet, Contains256EnumSet) {
+  for (size_t i = 0; i < iterations; ++i) {
+    size_t count = 0;
+    for (const Feature& f : LOOKUPS) {
+      count += ENUM_SET.contains(f);
+    }
+    doNotOptimize(count);
+  }
+}
+
+PISTIS_BENCHMARK(EnumSet, IterateStdSet) {
+  for (size_t i = 0; i < iterations; ++i) {
+    int total = 0;
+    for (const Feature& f : STD_SET) {
+      total += f.value();
+    }
+    doNotOptimize(total);
+  }
+}
+
+PISTIS_BENCHMARK(EnumSet, IterateEnumSet) {
+  for (size_t i = 0; i < iterations; ++i) {
+    int total = 0;
+    for (const Feature& f : ENUM_SET) {
+      total += f.value();
+    }
+    doNotOptimize(total);
+  }
+}
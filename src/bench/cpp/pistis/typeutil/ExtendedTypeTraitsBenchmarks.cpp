@@ -0,0 +1,66 @@
+/** @file ExtendedTypeTraitsBenchmarks.cpp
+ *
+ *  Benchmarks for copying blocks of values chosen by
+ *  pistis::typeutil::IsBitCopyable, and for the allocator helpers in
+ *  pistis/typeutil/AllocatorUtil.hpp
+ */
+
+#include <pistis/typeutil/ExtendedTypeTraits.hpp>
+#include <pistis/typeutil/AllocatorUtil.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <string.h>
+
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  struct Point {
+    double x;
+    double y;
+    double z;
+  };
+
+  static_assert(IsBitCopyable<Point>::value, "Point is not bit-copyable");
+
+  const size_t NUM_POINTS = 1 << 14;
+
+  const std::vector<Point> POINTS(NUM_POINTS, Point{ 1.0, 2.0, 3.0 });
+
+  template <typename T>
+  void copyBlock(T* to, const T* from, size_t n, std::true_type) {
+    ::memcpy(to, from, n * sizeof(T));
+  }
+
+  template <typename T>
+  void copyBlock(T* to, const T* from, size_t n, std::false_type) {
+    std::copy(from, from + n, to);
+  }
+}
+
+PISTIS_BENCHMARK(ExtendedTypeTraits, Copy16KPointsOneAtATime) {
+  std::vector<Point> to(NUM_POINTS);
+  for (size_t i = 0; i < iterations; ++i) {
+    copyBlock(to.data(), POINTS.data(), POINTS.size(), std::false_type());
+    doNotOptimize(to);
+  }
+}
+
+PISTIS_BENCHMARK(ExtendedTypeTraits, Copy16KPointsBitCopyable) {
+  std::vector<Point> to(NUM_POINTS);
+  for (size_t i = 0; i < iterations; ++i) {
+    copyBlock(to.data(), POINTS.data(), POINTS.size(),
+	      IsBitCopyable<Point>());
+    doNotOptimize(to);
+  }
+}
+
+PISTIS_BENCHMARK(AllocatorUtil, PropagateOnCopyAssignment) {
+  const std::allocator<Point> a;
+  for (size_t i = 0; i < iterations; ++i) {
+    std::allocator<Point> b = propagateOnCopyAssignment(a);
+    doNotOptimize(b);
+  }
+}
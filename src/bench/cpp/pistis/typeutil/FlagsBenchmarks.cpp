@@ -0,0 +1,183 @@
+/** @file FlagsBenchmarks.cpp
+ *
+ *  Benchmarks for pistis::typeutil::Flags, against std::set
+ */
+
+#include <pistis/typeutil/Flags.hpp>
+#include <pistis/typeutil/Enum.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  class Permission : public Enum<Permission> {
+  public:
+    static const std::vector<Permission> ALL;
+
+  public:
+    static std::vector<Permission> create(int n) {
+      std::vector<Permission> permissions;
+      for (int i = 0; i < n; ++i) {
+	std::ostringstream name;
+	name << "PERMISSION_" << i;
+	permissions.push_back(Permission(i, name.str()));
+      }
+      return permissions;
+    }
+
+  private:
+    Permission(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const std::vector<Permission> Permission::ALL = Permission::create(256);
+
+  typedef Flags<Permission> SmallFlags;       // The first 64 members
+  typedef Flags<Permission, 256> LargeFlags;
+
+  // 4096 random sets of the first 64 members, as std::set and as Flags
+  const size_t NUM_SETS = 4096;
+
+  std::vector< std::set<Permission> > randomStdSets() {
+    std::mt19937 rng(1);
+    std::vector< std::set<Permission> > sets(NUM_SETS);
+    for (std::set<Permission>& s : sets) {
+      for (int i = 0; i < 64; ++i) {
+	if (rng() % 4 == 0) {
+	  s.insert(Permission::ALL[i]);
+	}
+      }
+    }
+    return sets;
+  }
+
+  template <typename F>
+  std::vector<F> toFlags(const std::vector< std::set<Permission> >& sets) {
+    std::vector<F> flags;
+    for (const std::set<Permission>& s : sets) {
+      F f;
+      for (const Permission& p : s) {
+	f.insert(p);
+      }
+      flags.push_back(f);
+    }
+    return flags;
+  }
+
+  std::vector<LargeFlags> randomLargeFlags(size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<LargeFlags> flags;
+    for (size_t i = 0; i < n; ++i) {
+      uint64_t words[LargeFlags::NUM_WORDS];
+      for (uint64_t& w : words) {
+	w = rng();
+      }
+      flags.push_back(LargeFlags::fromWords(words));
+    }
+    return flags;
+  }
+
+  const std::vector< std::set<Permission> > STD_SETS = randomStdSets();
+  const std::vector<SmallFlags> SMALL_FLAGS = toFlags<SmallFlags>(STD_SETS);
+  const std::vector<LargeFlags> LARGE_A = randomLargeFlags(1 << 16, 1);
+  const std::vector<LargeFlags> LARGE_B = randomLargeFlags(1 << 16, 2);
+}
+
+PISTIS_BENCHMARK(Flags, UnionStdSet) {
+  for (size_t i = 0; i < iterations; ++i) {
+    const std::set<Permission>& a = STD_SETS[i % NUM_SETS];
+    const std::set<Permission>& b = STD_SETS[(i + 1) % NUM_SETS];
+    std::set<Permission> u;
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+		   std::inserter(u, u.end()));
+    doNotOptimize(u);
+  }
+}
+
+PISTIS_BENCHMARK(Flags, UnionFlags) {
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(SMALL_FLAGS[i % NUM_SETS] |
+		    SMALL_FLAGS[(i + 1) % NUM_SETS]);
+  }
+}
+
+PISTIS_BENCHMARK(Flags, SubsetStdSet) {
+  for (size_t i = 0; i < iterations; ++i) {
+    const std::set<Permission>& a = STD_SETS[i % NUM_SETS];
+    const std::set<Permission>& b = STD_SETS[(i + 1) % NUM_SETS];
+    doNotOptimize(std::includes(b.begin(), b.end(), a.begin(), a.end()));
+  }
+}
+
+PISTIS_BENCHMARK(Flags, SubsetFlags) {
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(SMALL_FLAGS[i % NUM_SETS].isSubsetOf(
+		      SMALL_FLAGS[(i + 1) % NUM_SETS]));
+  }
+}
+
+// Bulk kernels over 64K sets of 256 members, one set at a time and in
+// one call
+PISTIS_BENCHMARK(Flags, Union64KLargeOneAtATime) {
+  std::vector<LargeFlags> out(LARGE_A.size());
+  for (size_t i = 0; i < iterations; ++i) {
+    for (size_t j = 0; j < out.size(); ++j) {
+      out[j] = LARGE_A[j] | LARGE_B[j];
+    }
+    doNotOptimize(out);
+  }
+}
+
+PISTIS_BENCHMARK(Flags, Union64KLargeInBulk) {
+  std::vector<LargeFlags> out(LARGE_A.size());
+  for (size_t i = 0; i < iterations; ++i) {
+    LargeFlags::unionOf(LARGE_A.data(), LARGE_B.data(), out.data(),
+			out.size());
+    doNotOptimize(out);
+  }
+}
+
+PISTIS_BENCHMARK(Flags, Select4KOneAtATime) {
+  const SmallFlags required{ Permission::ALL[3], Permission::ALL[9] };
+  std::vector<uint64_t> bitmap(NUM_SETS / 64);
+  for (size_t i = 0; i < iterations; ++i) {
+    for (size_t j = 0; j < NUM_SETS; ++j) {
+      if (SMALL_FLAGS[j].containsAll(required)) {
+	bitmap[j / 64] |= (uint64_t)1 << (j % 64);
+      }
+    }
+    doNotOptimize(bitmap);
+  }
+}
+
+PISTIS_BENCHMARK(Flags, Select4KInBulk) {
+  const SmallFlags required{ Permission::ALL[3], Permission::ALL[9] };
+  std::vector<uint64_t> bitmap(NUM_SETS / 64);
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(SmallFlags::selectContainingAll(
+		      SMALL_FLAGS.data(), NUM_SETS, required, bitmap.data()));
+  }
+}
+
+PISTIS_BENCHMARK(Flags, ParseThreeNames) {
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(SmallFlags::parse(
+		      "PERMISSION_3|PERMISSION_17|PERMISSION_60"));
+  }
+}
+
+PISTIS_BENCHMARK(Flags, FormatThreeNames) {
+  const SmallFlags f{ Permission::ALL[3], Permission::ALL[17],
+		      Permission::ALL[60] };
+  char buffer[64];
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(f.formatTo(buffer, sizeof(buffer)));
+  }
+}
@@ -0,0 +1,67 @@
+/** @file InvokeWithTupleBenchmarks.cpp
+ *
+ *  Benchmarks for pistis::typeutil::invokeWithTuple, against calling the
+ *  function with the arguments directly
+ */
+
+#include <pistis/typeutil/InvokeWithTuple.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  typedef std::tuple<int, double, std::string> Args;
+
+  const size_t NUM_CALLS = 1024;
+
+  std::vector<Args> args() {
+    std::vector<Args> a;
+    for (size_t i = 0; i < NUM_CALLS; ++i) {
+      a.push_back(Args((int)i, i * 0.5, std::string(i % 32, 'x')));
+    }
+    return a;
+  }
+
+  const std::vector<Args> ARGS = args();
+
+  double combine(int n, double x, const std::string& s) {
+    return n + x + s.size();
+  }
+}
+
+PISTIS_BENCHMARK(InvokeWithTuple, Direct1K) {
+  for (size_t i = 0; i < iterations; ++i) {
+    double total = 0;
+    for (const Args& a : ARGS) {
+      total += combine(std::get<0>(a), std::get<1>(a), std::get<2>(a));
+    }
+    doNotOptimize(total);
+  }
+}
+
+PISTIS_BENCHMARK(InvokeWithTuple, InvokeWithTuple1K) {
+  for (size_t i = 0; i < iterations; ++i) {
+    double total = 0;
+    for (const Args& a : ARGS) {
+      total += invokeWithTuple(combine, a);
+    }
+    doNotOptimize(total);
+  }
+}
+
+PISTIS_BENCHMARK(InvokeWithTuple, InvokeLambdaWithTuple1K) {
+  for (size_t i = 0; i < iterations; ++i) {
+    double total = 0;
+    for (const Args& a : ARGS) {
+      total += invokeWithTuple(
+	  [](int n, double x, const std::string& s) { return n * x - s.size(); },
+	  a
+      );
+    }
+    doNotOptimize(total);
+  }
+}
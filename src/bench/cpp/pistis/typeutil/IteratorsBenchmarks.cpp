@@ -0,0 +1,95 @@
+/** @file IteratorsBenchmarks.cpp
+ *
+ *  Benchmarks for the iterators declared with the macros in
+ *  pistis/typeutil/Iterators.hpp, against the raw pointers they wrap
+ */
+
+#include <pistis/typeutil/Iterators.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  // The macros paste the implementation type after "const", so pointer
+  // types must be given names
+  typedef const int* ConstIntPointer;
+  typedef int* IntPointer;
+
+  class IntArray {
+  public:
+    DECLARE_RANDOM_ACCESS_ITERATORS(Iterator, IntArray, ConstIntPointer,
+				    IntPointer);
+
+  public:
+    IntArray(const std::vector<int>& values): values_(values) { }
+
+    ConstIterator begin() const { return ConstIterator(values_.data()); }
+    ConstIterator end() const {
+      return ConstIterator(values_.data() + values_.size());
+    }
+    Iterator begin() { return Iterator(values_.data()); }
+    Iterator end() { return Iterator(values_.data() + values_.size()); }
+
+    int* data() { return values_.data(); }
+    const int* data() const { return values_.data(); }
+    size_t size() const { return values_.size(); }
+
+  private:
+    std::vector<int> values_;
+  };
+
+  const size_t NUM_VALUES = 1 << 16;
+
+  std::vector<int> values() {
+    std::mt19937 rng(1);
+    std::vector<int> v;
+    for (size_t i = 0; i < NUM_VALUES; ++i) {
+      v.push_back((int)(rng() % 1000000));
+    }
+    return v;
+  }
+
+  const IntArray VALUES(values());
+}
+
+PISTIS_BENCHMARK(Iterators, Sum64KRawPointers) {
+  for (size_t i = 0; i < iterations; ++i) {
+    long total = 0;
+    for (const int* p = VALUES.data(); p != VALUES.data() + VALUES.size();
+	 ++p) {
+      total += *p;
+    }
+    doNotOptimize(total);
+  }
+}
+
+PISTIS_BENCHMARK(Iterators, Sum64KIterators) {
+  for (size_t i = 0; i < iterations; ++i) {
+    long total = 0;
+    for (IntArray::ConstIterator p = VALUES.begin(); p != VALUES.end(); ++p) {
+      total += *p;
+    }
+    doNotOptimize(total);
+  }
+}
+
+PISTIS_BENCHMARK(Iterators, Sort64KRawPointers) {
+  for (size_t i = 0; i < iterations; ++i) {
+    IntArray a(VALUES);
+    std::sort(a.data(), a.data() + a.size());
+    doNotOptimize(a);
+  }
+}
+
+PISTIS_BENCHMARK(Iterators, Sort64KIterators) {
+  for (size_t i = 0; i < iterations; ++i) {
+    IntArray a(VALUES);
+    std::sort(a.begin(), a.end());
+    doNotOptimize(a);
+  }
+}
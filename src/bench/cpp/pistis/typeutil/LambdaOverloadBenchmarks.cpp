@@ -0,0 +1,52 @@
+/** @file LambdaOverloadBenchmarks.cpp
+ *
+ *  Benchmarks for pistis::typeutil::overloadLambda, against calling the
+ *  lambdas it combines directly
+ */
+
+#include <pistis/typeutil/LambdaOverload.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <random>
+#include <vector>
+
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  const size_t NUM_VALUES = 4096;
+
+  std::vector<int> ints() {
+    std::mt19937 rng(1);
+    std::vector<int> v;
+    for (size_t i = 0; i < NUM_VALUES; ++i) {
+      v.push_back((int)(rng() % 1000));
+    }
+    return v;
+  }
+
+  const std::vector<int> INTS = ints();
+}
+
+PISTIS_BENCHMARK(LambdaOverload, SeparateLambdas4K) {
+  auto onInt = [](int x) { return x * 3; };
+  auto onDouble = [](double x) { return x * 0.5; };
+  for (size_t i = 0; i < iterations; ++i) {
+    double total = 0;
+    for (int x : INTS) {
+      total += onInt(x) + onDouble(x);
+    }
+    doNotOptimize(total);
+  }
+}
+
+PISTIS_BENCHMARK(LambdaOverload, OverloadSet4K) {
+  auto f = overloadLambda([](int x) { return x * 3; },
+			  [](double x) { return x * 0.5; });
+  for (size_t i = 0; i < iterations; ++i) {
+    double total = 0;
+    for (int x : INTS) {
+      total += f(x) + f((double)x);
+    }
+    doNotOptimize(total);
+  }
+}
@@ -0,0 +1,55 @@
+/** @file NameOfBenchmarks.cpp
+ *
+ *  Benchmarks for pistis::typeutil::nameOf, cachedNameOf and typeName,
+ *  as called when building an error message
+ */
+
+#include <pistis/typeutil/NameOf.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <map>
+#include <sstream>
+#include <string>
+
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  typedef std::map<std::string, int> Registry;
+}
+
+PISTIS_BENCHMARK(NameOf, NameOf) {
+  for (size_t i = 0; i < iterations; ++i) {
+    std::string name = nameOf<Registry>();
+    doNotOptimize(name);
+  }
+}
+
+PISTIS_BENCHMARK(NameOf, CachedNameOf) {
+  for (size_t i = 0; i < iterations; ++i) {
+    const std::string& name = cachedNameOf<Registry>();
+    doNotOptimize(name);
+  }
+}
+
+PISTIS_BENCHMARK(NameOf, TypeName) {
+  for (size_t i = 0; i < iterations; ++i) {
+    StringView name = typeName<Registry>();
+    doNotOptimize(name);
+  }
+}
+
+PISTIS_BENCHMARK(NameOf, MessageWithNameOf) {
+  for (size_t i = 0; i < iterations; ++i) {
+    std::ostringstream msg;
+    msg << "Member of " << nameOf<Registry>() << " with value " << i;
+    doNotOptimize(msg);
+  }
+}
+
+PISTIS_BENCHMARK(NameOf, MessageWithTypeName) {
+  for (size_t i = 0; i < iterations; ++i) {
+    std::ostringstream msg;
+    msg << "Member of " << typeName<Registry>() << " with value " << i;
+    doNotOptimize(msg);
+  }
+}
@@ -0,0 +1,192 @@
+/** @file OptionalBenchmarks.cpp
+ *
+ *  Benchmarks for pistis::typeutil::Optional
+ */
+
+#include <pistis/typeutil/Optional.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <string>
+#include <vector>
+
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  // One value in three is absent.  The strings are too long for the
+  // small string optimization, so copying one allocates.
+  const size_t NUM_VALUES = 1024;
+
+  std::vector< Optional<int> > ints() {
+    std::vector< Optional<int> > v;
+    for (size_t i = 0; i < NUM_VALUES; ++i) {
+      v.push_back((i % 3) ? Optional<int>((int)i) : Optional<int>());
+    }
+    return v;
+  }
+
+  std::vector< Optional<std::string> > strings() {
+    std::vector< Optional<std::string> > v;
+    for (size_t i = 0; i < NUM_VALUES; ++i) {
+      v.push_back((i % 3) ? Optional<std::string>(
+				"a string of more than sixteen characters " +
+				    std::to_string(i)
+			    )
+			  : Optional<std::string>());
+    }
+    return v;
+  }
+
+  typedef Optional<double, NanNiche<double> > OptionalPrice;
+
+  // Enough prices to overflow the cache, so summing them is limited by
+  // the size of each optional
+  const size_t NUM_PRICES = 1 << 20;
+
+  template <typename T>
+  std::vector<T> prices() {
+    std::vector<T> v;
+    for (size_t i = 0; i < NUM_PRICES; ++i) {
+      v.push_back((i % 3) ? T(100.0 + (i % 100)) : T());
+    }
+    return v;
+  }
+
+  template <typename T>
+  double sumOf(const std::vector<T>& prices) {
+    double sum = 0.0;
+    for (const T& p : prices) {
+      sum += p.valueOr(0.0);
+    }
+    return sum;
+  }
+
+  const std::vector< Optional<int> > INTS = ints();
+  const std::vector< Optional<std::string> > STRINGS = strings();
+  const std::vector< Optional<double> > PRICES = prices< Optional<double> >();
+  const std::vector<OptionalPrice> NICHE_PRICES = prices<OptionalPrice>();
+}
+
+PISTIS_BENCHMARK(Optional, Copy1KInts) {
+  for (size_t i = 0; i < iterations; ++i) {
+    std::vector< Optional<int> > copy(INTS);
+    doNotOptimize(copy);
+  }
+}
+
+PISTIS_BENCHMARK(Optional, Assign1KInts) {
+  std::vector< Optional<int> > copy(INTS.size());
+  for (size_t i = 0; i < iterations; ++i) {
+    copy = INTS;
+    doNotOptimize(copy);
+  }
+}
+
+PISTIS_BENCHMARK(Optional, Copy1KStrings) {
+  for (size_t i = 0; i < iterations; ++i) {
+    std::vector< Optional<std::string> > copy(STRINGS);
+    doNotOptimize(copy);
+  }
+}
+
+PISTIS_BENCHMARK(Optional, ValueOr1KInts) {
+  for (size_t i = 0; i < iterations; ++i) {
+    int total = 0;
+    for (const Optional<int>& v : INTS) {
+      total += v.valueOr(0);
+    }
+    doNotOptimize(total);
+  }
+}
+
+PISTIS_BENCHMARK(Optional, Map1KInts) {
+  for (size_t i = 0; i < iterations; ++i) {
+    int total = 0;
+    for (const Optional<int>& v : INTS) {
+      total += v.map([](int x) { return x * 2; }).valueOr(0);
+    }
+    doNotOptimize(total);
+  }
+}
+
+PISTIS_BENCHMARK(Optional, Map1KStrings) {
+  for (size_t i = 0; i < iterations; ++i) {
+    size_t total = 0;
+    for (const Optional<std::string>& v : STRINGS) {
+      total += v.map([](const std::string& s) { return s.size(); })
+		.valueOr(0);
+    }
+    doNotOptimize(total);
+  }
+}
+
+// Growing a vector reallocates it about ten times on the way to 1K
+// elements.  Whether the elements are moved or copied to the new
+// storage depends on whether their move constructor is noexcept.
+PISTIS_BENCHMARK(Optional, Grow1KStrings) {
+  for (size_t i = 0; i < iterations; ++i) {
+    std::vector<std::string> v;
+    for (const Optional<std::string>& s : STRINGS) {
+      v.push_back(s.valueOr(std::string()));
+    }
+    doNotOptimize(v);
+  }
+}
+
+PISTIS_BENCHMARK(Optional, Grow1KOptionalStrings) {
+  for (size_t i = 0; i < iterations; ++i) {
+    std::vector< Optional<std::string> > v;
+    for (const Optional<std::string>& s : STRINGS) {
+      v.push_back(s);
+    }
+    doNotOptimize(v);
+  }
+}
+
+PISTIS_BENCHMARK(Optional, Swap1KOptionalStrings) {
+  std::vector< Optional<std::string> > v(STRINGS);
+  for (size_t i = 0; i < iterations; ++i) {
+    for (size_t j = 1; j < v.size(); ++j) {
+      using std::swap;
+      swap(v[j - 1], v[j]);
+    }
+    doNotOptimize(v);
+  }
+}
+
+PISTIS_BENCHMARK(Optional, Sum1MPrices) {
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(sumOf(PRICES));
+  }
+}
+
+PISTIS_BENCHMARK(Optional, Sum1MNichePrices) {
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(sumOf(NICHE_PRICES));
+  }
+}
+
+// Each step of the chain takes its string by value.  Chaining on a
+// temporary optional can move the string from step to step rather than
+// copy it.
+PISTIS_BENCHMARK(Optional, MapChain1KStrings) {
+  auto append = [](std::string s) { return std::move(s) += " and more"; };
+  for (size_t i = 0; i < iterations; ++i) {
+    for (const Optional<std::string>& s : STRINGS) {
+      doNotOptimize(
+	  s.map(append).map(append).map(append).valueOrCall([]() {
+	    return std::string();
+	  })
+      );
+    }
+  }
+}
+
+PISTIS_BENCHMARK(Optional, Emplace1KStrings) {
+  Optional<std::string> s;
+  for (size_t i = 0; i < iterations; ++i) {
+    for (size_t j = 0; j < NUM_VALUES; ++j) {
+      s.emplace(48, 'x');
+      doNotOptimize(s);
+    }
+  }
+}
@@ -0,0 +1,95 @@
+/** @file OptionalColumnBenchmarks.cpp
+ *
+ *  Benchmarks for pistis::typeutil::OptionalColumn, against a
+ *  std::vector of Optional values.
+ */
+#include <pistis/typeutil/OptionalColumn.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <vector>
+
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  // One price in three is absent
+  const size_t NUM_PRICES = 1 << 16;
+
+  std::vector< Optional<double> > optionalPrices() {
+    std::vector< Optional<double> > v;
+    for (size_t i = 0; i < NUM_PRICES; ++i) {
+      v.push_back((i % 3) ? Optional<double>(100.0 + (i % 100))
+			  : Optional<double>());
+    }
+    return v;
+  }
+
+  const std::vector< Optional<double> > OPTIONALS = optionalPrices();
+  const OptionalColumn<double> COLUMN(OPTIONALS.begin(), OPTIONALS.end());
+}
+
+PISTIS_BENCHMARK(OptionalColumn, Sum64KOptionals) {
+  for (size_t i = 0; i < iterations; ++i) {
+    double sum = 0.0;
+    for (const Optional<double>& p : OPTIONALS) {
+      sum += p.valueOr(0.0);
+    }
+    doNotOptimize(sum);
+  }
+}
+
+PISTIS_BENCHMARK(OptionalColumn, Sum64K) {
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(COLUMN.sum());
+  }
+}
+
+PISTIS_BENCHMARK(OptionalColumn, ValueOr64KOptionals) {
+  for (size_t i = 0; i < iterations; ++i) {
+    std::vector<double> v(OPTIONALS.size());
+    for (size_t j = 0; j < OPTIONALS.size(); ++j) {
+      v[j] = OPTIONALS[j].valueOr(0.0);
+    }
+    doNotOptimize(v);
+  }
+}
+
+PISTIS_BENCHMARK(OptionalColumn, ValueOr64K) {
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(COLUMN.valueOr(0.0));
+  }
+}
+
+PISTIS_BENCHMARK(OptionalColumn, Map64KOptionals) {
+  for (size_t i = 0; i < iterations; ++i) {
+    std::vector< Optional<double> > v;
+    v.reserve(OPTIONALS.size());
+    for (const Optional<double>& p : OPTIONALS) {
+      v.push_back(p.map([](double x) { return x * 1.1; }));
+    }
+    doNotOptimize(v);
+  }
+}
+
+PISTIS_BENCHMARK(OptionalColumn, Map64K) {
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(COLUMN.map([](double x) { return x * 1.1; }));
+  }
+}
+
+PISTIS_BENCHMARK(OptionalColumn, Filter64KOptionals) {
+  for (size_t i = 0; i < iterations; ++i) {
+    std::vector< Optional<double> > v;
+    v.reserve(OPTIONALS.size());
+    for (const Optional<double>& p : OPTIONALS) {
+      v.push_back(p.present() && (p.value() > 150.0) ? p
+						     : Optional<double>());
+    }
+    doNotOptimize(v);
+  }
+}
+
+PISTIS_BENCHMARK(OptionalColumn, Filter64K) {
+  for (size_t i = 0; i < iterations; ++i) {
+    doNotOptimize(COLUMN.filter([](double x) { return x > 150.0; }));
+  }
+}
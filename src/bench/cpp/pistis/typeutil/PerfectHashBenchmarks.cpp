@@ -0,0 +1,91 @@
+/** @file PerfectHashBenchmarks.cpp
+ *
+ *  Benchmarks for pistis::typeutil::PerfectHashIndex, against
+ *  std::unordered_map keyed by std::string
+ */
+
+#include <pistis/typeutil/PerfectHash.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  const size_t NUM_KEYS = 1024;
+  const size_t NUM_LOOKUPS = 4096;
+
+  std::vector<std::string> keys() {
+    std::vector<std::string> k;
+    for (size_t i = 0; i < NUM_KEYS; ++i) {
+      k.push_back("KEY_NUMBER_" + std::to_string(i));
+    }
+    return k;
+  }
+
+  const std::vector<std::string> KEYS = keys();
+
+  PerfectHashIndex makeIndex() {
+    std::vector<StringView> views(KEYS.begin(), KEYS.end());
+    std::vector<uint32_t> ids;
+    for (size_t i = 0; i < KEYS.size(); ++i) {
+      ids.push_back((uint32_t)i);
+    }
+    PerfectHashIndex index;
+    index.build(views.data(), ids.data(), views.size());
+    return index;
+  }
+
+  std::unordered_map<std::string, uint32_t> makeMap() {
+    std::unordered_map<std::string, uint32_t> m;
+    for (size_t i = 0; i < KEYS.size(); ++i) {
+      m[KEYS[i]] = (uint32_t)i;
+    }
+    return m;
+  }
+
+  std::vector<std::string> lookups() {
+    std::mt19937 rng(1);
+    std::vector<std::string> l;
+    for (size_t i = 0; i < NUM_LOOKUPS; ++i) {
+      l.push_back(KEYS[rng() % KEYS.size()]);
+    }
+    return l;
+  }
+
+  const PerfectHashIndex INDEX = makeIndex();
+  const std::unordered_map<std::string, uint32_t> MAP = makeMap();
+  const std::vector<std::string> LOOKUPS = lookups();
+}
+
+PISTIS_BENCHMARK(PerfectHash, LookUp4KUnorderedMap) {
+  for (size_t i = 0; i < iterations; ++i) {
+    uint32_t total = 0;
+    for (const std::string& k : LOOKUPS) {
+      total += MAP.find(k)->second;
+    }
+    doNotOptimize(total);
+  }
+}
+
+PISTIS_BENCHMARK(PerfectHash, LookUp4KPerfectHashIndex) {
+  for (size_t i = 0; i < iterations; ++i) {
+    uint32_t total = 0;
+    for (const std::string& k : LOOKUPS) {
+      // The index only names the key that k could be
+      const uint32_t id = INDEX.find(k);
+      total += (KEYS[id] == k) ? id : 0;
+    }
+    doNotOptimize(total);
+  }
+}
+
+PISTIS_BENCHMARK(PerfectHash, Build1K) {
+  for (size_t i = 0; i < iterations; ++i) {
+    PerfectHashIndex index = makeIndex();
+    doNotOptimize(index);
+  }
+}
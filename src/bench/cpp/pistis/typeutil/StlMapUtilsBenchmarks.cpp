@@ -0,0 +1,118 @@
+/** @file StlMapUtilsBenchmarks.cpp
+ *
+ *  Benchmarks for the functions in pistis::typeutil::stl_map_utils,
+ *  against calling find() on the map directly
+ */
+
+#include <pistis/typeutil/StlMapUtils.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  // Half of the lookups miss
+  const int NUM_KEYS = 1024;
+  const size_t NUM_LOOKUPS = 4096;
+
+  template <typename Map>
+  Map makeMap() {
+    Map m;
+    for (int i = 0; i < NUM_KEYS; ++i) {
+      m[2 * i] = i;
+    }
+    return m;
+  }
+
+  std::vector<int> lookups() {
+    std::mt19937 rng(1);
+    std::vector<int> l;
+    for (size_t i = 0; i < NUM_LOOKUPS; ++i) {
+      l.push_back((int)(rng() % (2 * NUM_KEYS)));
+    }
+    return l;
+  }
+
+  const std::map<int, int> MAP = makeMap< std::map<int, int> >();
+  const std::unordered_map<int, int> HASH_MAP =
+      makeMap< std::unordered_map<int, int> >();
+  const std::vector<int> LOOKUPS = lookups();
+
+  template <typename Map>
+  void findWithDefault(size_t iterations, const Map& m) {
+    for (size_t i = 0; i < iterations; ++i) {
+      int total = 0;
+      for (int k : LOOKUPS) {
+	auto j = m.find(k);
+	total += (j != m.end()) ? j->second : -1;
+      }
+      doNotOptimize(total);
+    }
+  }
+
+  template <typename Map>
+  void getWithDefault(size_t iterations, const Map& m) {
+    const int missing = -1;
+    for (size_t i = 0; i < iterations; ++i) {
+      int total = 0;
+      for (int k : LOOKUPS) {
+	total += stl_map_utils::get(m, k, missing);
+      }
+      doNotOptimize(total);
+    }
+  }
+}
+
+PISTIS_BENCHMARK(StlMapUtils, Find4KStdMap) {
+  findWithDefault(iterations, MAP);
+}
+
+PISTIS_BENCHMARK(StlMapUtils, GetWithDefault4KStdMap) {
+  getWithDefault(iterations, MAP);
+}
+
+PISTIS_BENCHMARK(StlMapUtils, Find4KUnorderedMap) {
+  findWithDefault(iterations, HASH_MAP);
+}
+
+PISTIS_BENCHMARK(StlMapUtils, GetWithDefault4KUnorderedMap) {
+  getWithDefault(iterations, HASH_MAP);
+}
+
+PISTIS_BENCHMARK(StlMapUtils, GetOrCall4KStdMap) {
+  for (size_t i = 0; i < iterations; ++i) {
+    int total = 0;
+    for (int k : LOOKUPS) {
+      total += stl_map_utils::getOrCall(MAP, k, [k]() { return -k; });
+    }
+    doNotOptimize(total);
+  }
+}
+
+PISTIS_BENCHMARK(StlMapUtils, GetHitStdMap) {
+  for (size_t i = 0; i < iterations; ++i) {
+    int total = 0;
+    for (int k = 0; k < 2 * NUM_KEYS; k += 2) {
+      total += stl_map_utils::get(MAP, k);
+    }
+    doNotOptimize(total);
+  }
+}
+
+PISTIS_BENCHMARK(StlMapUtils, Keys1KStdMap) {
+  for (size_t i = 0; i < iterations; ++i) {
+    std::vector<int> keys = stl_map_utils::keys(MAP);
+    doNotOptimize(keys);
+  }
+}
+
+PISTIS_BENCHMARK(StlMapUtils, Values1KStdMap) {
+  for (size_t i = 0; i < iterations; ++i) {
+    std::vector<int> values = stl_map_utils::values(MAP);
+    doNotOptimize(values);
+  }
+}
@@ -0,0 +1,67 @@
+/** @file StringViewBenchmarks.cpp
+ *
+ *  Benchmarks for pistis::typeutil::StringView, against passing the same
+ *  characters as a std::string
+ */
+
+#include <pistis/typeutil/StringView.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <string>
+#include <vector>
+
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  // Names in a parse buffer, separated by spaces
+  const size_t NUM_NAMES = 1024;
+
+  std::string buffer() {
+    std::string b;
+    for (size_t i = 0; i < NUM_NAMES; ++i) {
+      b += "SOME_LONGER_NAME_" + std::to_string(i % 16) + " ";
+    }
+    return b;
+  }
+
+  const std::string BUFFER = buffer();
+  const std::string TARGET = "SOME_LONGER_NAME_7";
+
+  __attribute__((noinline)) bool matches(const std::string& s) {
+    return s == TARGET;
+  }
+
+  __attribute__((noinline)) bool matches(const StringView& s) {
+    return s == StringView(TARGET);
+  }
+
+  template <typename String>
+  void matchNames(size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+      size_t count = 0;
+      size_t start = 0;
+      for (size_t end = BUFFER.find(' '); end != std::string::npos;
+	   start = end + 1, end = BUFFER.find(' ', start)) {
+	count += matches(String(BUFFER.data() + start, end - start));
+      }
+      doNotOptimize(count);
+    }
+  }
+}
+
+PISTIS_BENCHMARK(StringView, Match1KNamesAsStrings) {
+  matchNames<std::string>(iterations);
+}
+
+PISTIS_BENCHMARK(StringView, Match1KNamesAsViews) {
+  matchNames<StringView>(iterations);
+}
+
+PISTIS_BENCHMARK(StringView, Compare) {
+  const StringView a("SOME_LONGER_NAME_15");
+  const StringView b("SOME_LONGER_NAME_16");
+  for (size_t i = 0; i < iterations; ++i) {
+    int c = a.compare(b);
+    doNotOptimize(c);
+  }
+}
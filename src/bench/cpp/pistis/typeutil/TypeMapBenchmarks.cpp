@@ -0,0 +1,113 @@
+/** @file TypeMapBenchmarks.cpp
+ *
+ *  Benchmarks for pistis::typeutil::TypeMap, against the standard hash
+ *  map keyed by std::type_index or by type name
+ */
+
+#include <pistis/typeutil/TypeMap.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <random>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  // Handlers are registered for 64 message types, then looked up for a
+  // stream of messages of random types
+  template <int N>
+  struct Message { };
+
+  const size_t NUM_TYPES = 64;
+  const size_t NUM_LOOKUPS = 1 << 16;
+
+  template <size_t... N>
+  std::vector<std::type_index> typeIndexes(std::index_sequence<N...>) {
+    return std::vector<std::type_index>{ typeid(Message<N>)... };
+  }
+
+  template <size_t... N>
+  std::vector<std::string> typeNames(std::index_sequence<N...>) {
+    return std::vector<std::string>{ nameOf< Message<N> >()... };
+  }
+
+  template <size_t... N>
+  std::vector<TypeId> typeIds(std::index_sequence<N...>) {
+    return std::vector<TypeId>{ typeId< Message<N> >()... };
+  }
+
+  template <typename Key>
+  std::vector<Key> lookups(const std::vector<Key>& keys) {
+    std::mt19937 rng(1);
+    std::vector<Key> l;
+    for (size_t i = 0; i < NUM_LOOKUPS; ++i) {
+      l.push_back(keys[rng() % keys.size()]);
+    }
+    return l;
+  }
+
+  const std::vector<std::type_index> TYPE_INDEXES =
+      typeIndexes(std::make_index_sequence<NUM_TYPES>());
+  const std::vector<std::string> TYPE_NAMES =
+      typeNames(std::make_index_sequence<NUM_TYPES>());
+  const std::vector<TypeId> TYPE_IDS =
+      typeIds(std::make_index_sequence<NUM_TYPES>());
+
+  const std::vector<std::type_index> TYPE_INDEX_LOOKUPS =
+      lookups(TYPE_INDEXES);
+  const std::vector<std::string> TYPE_NAME_LOOKUPS = lookups(TYPE_NAMES);
+  const std::vector<TypeId> TYPE_ID_LOOKUPS = lookups(TYPE_IDS);
+
+  template <typename Map, typename Key>
+  void lookUpKeys(size_t iterations, const std::vector<Key>& keys,
+		  const std::vector<Key>& lookups) {
+    Map m;
+    for (size_t j = 0; j < keys.size(); ++j) {
+      m[keys[j]] = (int)j;
+    }
+
+    for (size_t i = 0; i < iterations; ++i) {
+      int total = 0;
+      for (const Key& k : lookups) {
+	total += m[k];
+      }
+      doNotOptimize(total);
+    }
+  }
+}
+
+PISTIS_BENCHMARK(TypeMap, LookUp64KByTypeIndex) {
+  lookUpKeys< std::unordered_map<std::type_index, int> >(
+      iterations, TYPE_INDEXES, TYPE_INDEX_LOOKUPS
+  );
+}
+
+PISTIS_BENCHMARK(TypeMap, LookUp64KByTypeName) {
+  lookUpKeys< std::unordered_map<std::string, int> >(
+      iterations, TYPE_NAMES, TYPE_NAME_LOOKUPS
+  );
+}
+
+PISTIS_BENCHMARK(TypeMap, LookUp64KTypeMap) {
+  lookUpKeys< TypeMap<int> >(iterations, TYPE_IDS, TYPE_ID_LOOKUPS);
+}
+
+PISTIS_BENCHMARK(TypeMap, LookUp64KTypeMapByType) {
+  TypeMap<int> m;
+  for (size_t j = 0; j < TYPE_IDS.size(); ++j) {
+    m[TYPE_IDS[j]] = (int)j;
+  }
+
+  for (size_t i = 0; i < iterations; ++i) {
+    int total = 0;
+    for (size_t j = 0; j < NUM_LOOKUPS / 4; ++j) {
+      total += m.at< Message<1> >() + m.at< Message<17> >() +
+		 m.at< Message<42> >() + m.at< Message<63> >();
+    }
+    doNotOptimize(total);
+  }
+}
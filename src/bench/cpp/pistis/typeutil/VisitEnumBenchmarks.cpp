@@ -0,0 +1,92 @@
+/** @file VisitEnumBenchmarks.cpp
+ *
+ *  Benchmarks for pistis::typeutil::visitEnum
+ */
+
+#include <pistis/typeutil/VisitEnum.hpp>
+#include <pistis/typeutil/Enum.hpp>
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <random>
+#include <vector>
+
+using namespace pistis::typeutil;
+using namespace pistis::typeutil::bench;
+
+namespace {
+  class Op : public Enum<Op> {
+  public:
+    static const Op ADD;
+    static const Op SUB;
+    static const Op MUL;
+    static const Op DIV;
+    static const Op MOD;
+    static const Op AND;
+    static const Op OR;
+    static const Op XOR;
+
+  public:
+    Op(): Enum<Op>(ADD) { }
+
+  private:
+    Op(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const Op Op::ADD(0, "ADD");
+  const Op Op::SUB(1, "SUB");
+  const Op Op::MUL(2, "MUL");
+  const Op Op::DIV(3, "DIV");
+  const Op Op::MOD(4, "MOD");
+  const Op Op::AND(5, "AND");
+  const Op Op::OR(6, "OR");
+  const Op Op::XOR(7, "XOR");
+
+  std::vector<Op> randomOps() {
+    std::vector<Op> ops;
+    std::mt19937 rng(1);
+    for (size_t i = 0; i < (1 << 20); ++i) {
+      ops.push_back(Op::values()[rng() % Op::values().size()]);
+    }
+    return ops;
+  }
+}
+
+PISTIS_BENCHMARK(VisitEnum, IfChain) {
+  static const std::vector<Op> OPS = randomOps();
+  unsigned sum = 0;
+  for (size_t i = 0; i < iterations; ++i) {
+    const Op& op = OPS[i & (OPS.size() - 1)];
+    const unsigned x = (unsigned)i;
+    if (op == Op::ADD) {
+      sum += x + 3;
+    } else if (op == Op::SUB) {
+      sum += x - 3;
+    } else if (op == Op::MUL) {
+      sum += x * 3;
+    } else if (op == Op::DIV) {
+      sum += x / 3;
+    } else if (op == Op::MOD) {
+      sum += x % 3;
+    } else if (op == Op::AND) {
+      sum += x & 3;
+    } else if (op == Op::OR) {
+      sum += x | 3;
+    } else {
+      sum += x ^ 3;
+    }
+  }
+  doNotOptimize(sum);
+}
+
+PISTIS_BENCHMARK(VisitEnum, JumpTable) {
+  static const std::vector<Op> OPS = randomOps();
+  unsigned sum = 0;
+  for (size_t i = 0; i < iterations; ++i) {
+    const unsigned x = (unsigned)i;
+    sum += visitEnum(OPS[i & (OPS.size() - 1)],
+		     [x]() { return x + 3; }, [x]() { return x - 3; },
+		     [x]() { return x * 3; }, [x]() { return x / 3; },
+		     [x]() { return x % 3; }, [x]() { return x & 3; },
+		     [x]() { return x | 3; }, [x]() { return x ^ 3; });
+  }
+  doNotOptimize(sum);
+}
@@ -0,0 +1,59 @@
+#ifndef __PISTIS__TYPEUTIL__BENCH__BENCHMARK_HPP__
+#define __PISTIS__TYPEUTIL__BENCH__BENCHMARK_HPP__
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+namespace pistis {
+  namespace typeutil {
+    namespace bench {
+
+      /** @brief Runs the code being measured @e iterations times */
+      typedef std::function<void (size_t)> BenchmarkFunction;
+
+      struct Benchmark {
+	std::string group;
+	std::string name;
+	BenchmarkFunction run;
+      };
+
+      /** @brief All benchmarks registered with PISTIS_BENCHMARK */
+      inline std::vector<Benchmark>& benchmarks() {
+	static std::vector<Benchmark> all;
+	return all;
+      }
+
+      class BenchmarkRegistrar {
+      public:
+	BenchmarkRegistrar(const char* group, const char* name,
+			   BenchmarkFunction f) {
+	  benchmarks().push_back(Benchmark{ group, name, f });
+	}
+      };
+
+      /** @brief Keep the compiler from optimizing away the computation
+       *         of @e v.
+       */
+      template <typename T>
+      inline void doNotOptimize(const T& v) {
+	asm volatile("" : : "r"(&v) : "memory");
+      }
+
+    }
+  }
+}
+
+/** @brief Define a benchmark
+ *
+ *  The body that follows is called with a parameter named @c iterations
+ *  and should repeat the operation being measured that many times.
+ */
+#define PISTIS_BENCHMARK(GROUP, NAME)                                        \
+  static void GROUP##_##NAME##_Benchmark(size_t iterations);                 \
+  static ::pistis::typeutil::bench::BenchmarkRegistrar                       \
+      GROUP##_##NAME##_Registrar(#GROUP, #NAME, &GROUP##_##NAME##_Benchmark); \
+  static void GROUP##_##NAME##_Benchmark(size_t iterations)
+
+#endif
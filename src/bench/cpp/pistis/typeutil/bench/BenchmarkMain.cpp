@@ -0,0 +1,278 @@
+/** @file BenchmarkMain.cpp
+ *
+ *  Runs the benchmarks registered with PISTIS_BENCHMARK.
+ *
+ *  Usage: benchmarks [options] [filter]
+ *
+ *  Only benchmarks whose "Group.Name" contains @e filter are run.  Each
+ *  benchmark is first run with a growing number of iterations until a
+ *  run takes the minimum time, then run a number of times more to warm
+ *  up, then timed over a number of repetitions.  The report gives the
+ *  time per iteration at several percentiles of the repetitions.
+ *
+ *  Options:
+ *    --repetitions=N   Timed runs per benchmark (default 10)
+ *    --warmup=N        Untimed runs before the first repetition
+ *                      (default 1)
+ *    --min-time=MS     Minimum duration of one run (default 50)
+ *    --json=FILE       Also write the results to FILE as JSON
+ *    --baseline=FILE   Compare the median of each benchmark to the one
+ *                      in FILE, written earlier with --json
+ *    --threshold=PCT   Slowdown against the baseline reported as a
+ *                      regression (default 10).  The exit status is 1 if
+ *                      any benchmark regressed.
+ *    --list            List the benchmarks instead of running them
+ */
+
+#include <pistis/typeutil/bench/Benchmark.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace pistis::typeutil::bench;
+
+namespace {
+  struct Options {
+    std::string filter;
+    size_t repetitions = 10;
+    size_t warmup = 1;
+    double minTime = 0.05;
+    std::string jsonFile;
+    std::string baselineFile;
+    double threshold = 10.0;
+    bool list = false;
+  };
+
+  /** @brief Times per iteration, in nanoseconds, over the repetitions
+   *         of one benchmark
+   */
+  struct Result {
+    std::string name;
+    size_t iterations;
+    std::vector<double> samples;  ///< Sorted
+    double mean;
+    double stddev;
+
+    /** @brief The @e p'th percentile of the samples, by nearest rank */
+    double percentile(double p) const {
+      const size_t rank = (size_t)std::ceil(p / 100.0 * samples.size());
+      return samples[(rank ? rank : 1) - 1];
+    }
+  };
+
+  double runFor(const Benchmark& b, size_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    b.run(iterations);
+    return std::chrono::duration<double>(
+	std::chrono::steady_clock::now() - start
+    ).count();
+  }
+
+  Result measure(const Benchmark& b, const std::string& name,
+		 const Options& options) {
+    // Grow the iteration count until a run takes the minimum time
+    size_t iterations = 1;
+    while ((runFor(b, iterations) < options.minTime) &&
+	   (iterations < (1ul << 40))) {
+      iterations *= 2;
+    }
+    for (size_t i = 0; i < options.warmup; ++i) {
+      runFor(b, iterations);
+    }
+
+    Result r{ name, iterations, std::vector<double>(), 0.0, 0.0 };
+    for (size_t i = 0; i < options.repetitions; ++i) {
+      r.samples.push_back(runFor(b, iterations) * 1e9 / iterations);
+    }
+    std::sort(r.samples.begin(), r.samples.end());
+
+    for (double s : r.samples) {
+      r.mean += s;
+    }
+    r.mean /= r.samples.size();
+    for (double s : r.samples) {
+      r.stddev += (s - r.mean) * (s - r.mean);
+    }
+    r.stddev = std::sqrt(r.stddev / r.samples.size());
+    return r;
+  }
+
+  std::string quote(const std::string& s) {
+    std::string q("\"");
+    for (char c : s) {
+      if ((c == '"') || (c == '\\')) {
+	q.push_back('\\');
+      }
+      q.push_back(c);
+    }
+    q.push_back('"');
+    return q;
+  }
+
+  void writeJson(std::ostream& out, const std::vector<Result>& results) {
+    out << "{\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+      const Result& r = results[i];
+      out << (i ? ",\n" : "\n") << std::setprecision(6)
+	  << "    { \"name\": " << quote(r.name)
+	  << ", \"iterations\": " << r.iterations
+	  << ", \"repetitions\": " << r.samples.size()
+	  << ", \"mean\": " << r.mean
+	  << ", \"stddev\": " << r.stddev
+	  << ", \"min\": " << r.samples.front()
+	  << ", \"p50\": " << r.percentile(50)
+	  << ", \"p90\": " << r.percentile(90)
+	  << ", \"p99\": " << r.percentile(99)
+	  << ", \"max\": " << r.samples.back() << " }";
+    }
+    out << "\n  ]\n}\n";
+  }
+
+  /** @brief Read the median of each benchmark from a file written by
+   *         writeJson()
+   *
+   *  Only understands the flat objects that writeJson() produces, in
+   *  which "name" comes before "p50".
+   */
+  std::map<std::string, double> readBaseline(const std::string& file) {
+    std::ifstream in(file);
+    if (!in) {
+      std::cerr << "Cannot read baseline " << file << std::endl;
+      exit(2);
+    }
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    const std::string text = buffer.str();
+
+    std::map<std::string, double> baseline;
+    for (size_t i = text.find("\"name\""); i != std::string::npos;
+	 i = text.find("\"name\"", i)) {
+      size_t start = text.find('"', text.find(':', i)) + 1;
+      std::string name;
+      for (; (start < text.size()) && (text[start] != '"'); ++start) {
+	if (text[start] == '\\') {
+	  ++start;
+	}
+	name.push_back(text[start]);
+      }
+      i = text.find("\"p50\"", start);
+      if (i == std::string::npos) {
+	break;
+      }
+      baseline[name] = strtod(text.c_str() + text.find(':', i) + 1, nullptr);
+    }
+    return baseline;
+  }
+
+  bool parseOption(const char* arg, const char* option, std::string& value) {
+    const size_t n = strlen(option);
+    if (strncmp(arg, option, n) || (arg[n] != '=')) {
+      return false;
+    }
+    value = arg + n + 1;
+    return true;
+  }
+
+  Options parseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+      std::string value;
+      if (parseOption(argv[i], "--repetitions", value)) {
+	options.repetitions = std::max(1ul, strtoul(value.c_str(), 0, 10));
+      } else if (parseOption(argv[i], "--warmup", value)) {
+	options.warmup = strtoul(value.c_str(), 0, 10);
+      } else if (parseOption(argv[i], "--min-time", value)) {
+	options.minTime = strtod(value.c_str(), nullptr) / 1000.0;
+      } else if (parseOption(argv[i], "--json", value)) {
+	options.jsonFile = value;
+      } else if (parseOption(argv[i], "--baseline", value)) {
+	options.baselineFile = value;
+      } else if (parseOption(argv[i], "--threshold", value)) {
+	options.threshold = strtod(value.c_str(), nullptr);
+      } else if (!strcmp(argv[i], "--list")) {
+	options.list = true;
+      } else if (!strncmp(argv[i], "--", 2)) {
+	std::cerr << "Unknown option " << argv[i] << std::endl;
+	exit(2);
+      } else {
+	options.filter = argv[i];
+      }
+    }
+    return options;
+  }
+}
+
+int main(int argc, char** argv) {
+  const Options options = parseOptions(argc, argv);
+  const std::map<std::string, double> baseline =
+      options.baselineFile.empty() ? std::map<std::string, double>()
+				   : readBaseline(options.baselineFile);
+
+  if (!options.list) {
+    std::cout << std::left << std::setw(48) << "Benchmark" << std::right
+	      << std::setw(12) << "min" << std::setw(12) << "p50"
+	      << std::setw(12) << "p90" << std::setw(12) << "max"
+	      << (baseline.empty() ? "" : "   vs baseline") << std::endl;
+  }
+
+  std::vector<Result> results;
+  size_t regressions = 0;
+  for (const Benchmark& b : benchmarks()) {
+    const std::string name = b.group + "." + b.name;
+    if (name.find(options.filter) == std::string::npos) {
+      continue;
+    }
+    if (options.list) {
+      std::cout << name << std::endl;
+      continue;
+    }
+
+    results.push_back(measure(b, name, options));
+    const Result& r = results.back();
+    std::cout << std::left << std::setw(48) << name << std::right
+	      << std::fixed << std::setprecision(2)
+	      << std::setw(12) << r.samples.front()
+	      << std::setw(12) << r.percentile(50)
+	      << std::setw(12) << r.percentile(90)
+	      << std::setw(12) << r.samples.back();
+
+    auto i = baseline.find(name);
+    if (i != baseline.end()) {
+      const double change = (r.percentile(50) / i->second - 1.0) * 100.0;
+      std::cout << std::setw(11) << std::showpos << change << "%"
+		<< std::noshowpos;
+      if (change > options.threshold) {
+	std::cout << "  REGRESSED";
+	++regressions;
+      }
+    } else if (!baseline.empty()) {
+      std::cout << "        new";
+    }
+    std::cout << std::endl;
+  }
+
+  if (!options.jsonFile.empty()) {
+    std::ofstream out(options.jsonFile);
+    writeJson(out, results);
+    if (!out) {
+      std::cerr << "Cannot write " << options.jsonFile << std::endl;
+      return 2;
+    }
+  }
+  if (regressions) {
+    std::cout << std::defaultfloat << regressions
+	      << " benchmark(s) slower than the baseline by more than "
+	      << options.threshold << "%" << std::endl;
+    return 1;
+  }
+  return 0;
+}
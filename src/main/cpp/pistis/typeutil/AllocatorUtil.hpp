@@ -1,7 +1,7 @@
 #ifndef __PISTIS__TYPEUTIL__ALLOCATORUTIL_HPP__
 #define __PISTIS__TYPEUTIL__ALLOCATORUTIL_HPP__
 
-#include <allocator_traits>
+#include <memory>
 #include <utility>
 
 namespace pistis {
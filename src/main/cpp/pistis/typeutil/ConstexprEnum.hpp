@@ -0,0 +1,408 @@
+#ifndef __PISTIS__TYPEUTIL__CONSTEXPRENUM_HPP__
+#define __PISTIS__TYPEUTIL__CONSTEXPRENUM_HPP__
+
+#include <pistis/typeutil/NameOf.hpp>
+#include <pistis/typeutil/Optional.hpp>
+#include <pistis/typeutil/StringView.hpp>
+#include <pistis/exceptions/NoSuchItem.hpp>
+#include <iterator>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace pistis {
+  namespace typeutil {
+
+    /** @brief Value and name of one member of a ConstexprEnum */
+    template <typename ValueT>
+    struct ConstexprEnumMember {
+      ValueT value;
+      const char* name;
+    };
+
+    /** @brief Values, names and lookup tables for a ConstexprEnum
+     *
+     *  The table is built by the compiler.  Besides the values and names
+     *  of the members in ordinal order, it holds the ordinals sorted by
+     *  value and by name, so fromValue() and fromName() can use a binary
+     *  search.  If the values are consecutive integers, fromValue()
+     *  indexes the table directly.
+     *
+     *  Use makeConstexprEnumTable() to create one without spelling out
+     *  the number of members.
+     */
+    template <typename ValueT, size_t N>
+    class ConstexprEnumTable {
+      static_assert(N > 0, "A ConstexprEnum must have at least one member");
+
+    public:
+      typedef ValueT ValueType;
+
+    public:
+      constexpr ConstexprEnumTable(
+	  const ConstexprEnumMember<ValueT> (&members)[N]
+      ):
+	  values_(), names_(), byValue_(), byName_(),
+	  consecutive_(std::is_integral<ValueT>::value) {
+	for (size_t i = 0; i < N; ++i) {
+	  values_[i] = members[i].value;
+	  names_[i] = StringView(members[i].name);
+	}
+
+	// Insertion sort, since std::sort is not constexpr in C++14
+	for (size_t i = 0; i < N; ++i) {
+	  size_t j = i;
+	  for (; j && (values_[i] < values_[byValue_[j - 1]]); --j) {
+	    byValue_[j] = byValue_[j - 1];
+	  }
+	  byValue_[j] = (uint32_t)i;
+
+	  j = i;
+	  for (; j && (names_[i] < names_[byName_[j - 1]]); --j) {
+	    byName_[j] = byName_[j - 1];
+	  }
+	  byName_[j] = (uint32_t)i;
+	}
+
+	// Written so that neither side can overflow
+	for (size_t i = 1; i < N; ++i) {
+	  const ValueT previous = values_[byValue_[i - 1]];
+	  const ValueT current = values_[byValue_[i]];
+	  if (!(previous < current) || (current - 1 != previous)) {
+	    consecutive_ = false;
+	  }
+	}
+      }
+
+      /** @brief Number of members */
+      static constexpr size_t size() { return N; }
+
+      constexpr ValueT value(size_t ordinal) const {
+	return values_[ordinal];
+      }
+
+      constexpr StringView name(size_t ordinal) const {
+	return names_[ordinal];
+      }
+
+      /** @brief Returns the ordinal of the member with value @e v, or
+       *         size() if there is no such member.
+       *
+       *  When several members have the same value, returns one of them.
+       */
+      constexpr size_t findValue(ValueT v) const {
+	if (consecutive_) {
+	  const ValueT base = values_[byValue_[0]];
+	  return ((v < base) || (v > values_[byValue_[N - 1]]))
+		   ? N : byValue_[(size_t)(v - base)];
+	}
+	size_t low = 0;
+	size_t high = N;
+	while (low < high) {
+	  const size_t mid = low + (high - low) / 2;
+	  if (values_[byValue_[mid]] < v) {
+	    low = mid + 1;
+	  } else {
+	    high = mid;
+	  }
+	}
+	return ((low < N) && (values_[byValue_[low]] == v)) ? byValue_[low]
+							     : N;
+      }
+
+      /** @brief Returns the ordinal of the member named @e name, or
+       *         size() if there is no such member.
+       */
+      constexpr size_t findName(const StringView& name) const {
+	size_t low = 0;
+	size_t high = N;
+	while (low < high) {
+	  const size_t mid = low + (high - low) / 2;
+	  if (names_[byName_[mid]] < name) {
+	    low = mid + 1;
+	  } else {
+	    high = mid;
+	  }
+	}
+	return ((low < N) && (names_[byName_[low]] == name)) ? byName_[low]
+							      : N;
+      }
+
+    private:
+      ValueT values_[N];
+      StringView names_[N];
+      uint32_t byValue_[N];
+      uint32_t byName_[N];
+      bool consecutive_;
+    };
+
+    /** @brief Build a ConstexprEnumTable from a list of members
+     *
+     *  For example:
+     *  <code>
+     *    makeConstexprEnumTable<int>({ { 1, "RED" }, { 2, "GREEN" } })
+     *  </code>
+     */
+    template <typename ValueT, size_t N>
+    constexpr ConstexprEnumTable<ValueT, N> makeConstexprEnumTable(
+	const ConstexprEnumMember<ValueT> (&members)[N]
+    ) {
+      return ConstexprEnumTable<ValueT, N>(members);
+    }
+
+    /** @brief The members of a ConstexprEnum, in ordinal order */
+    template <typename DerivedT>
+    class ConstexprEnumValues {
+    public:
+      class const_iterator {
+      public:
+	typedef std::random_access_iterator_tag iterator_category;
+	typedef DerivedT value_type;
+	typedef DerivedT reference;
+	typedef const DerivedT* pointer;
+	typedef ptrdiff_t difference_type;
+
+      public:
+	constexpr const_iterator(): ordinal_(0) { }
+	constexpr explicit const_iterator(size_t ordinal):
+	    ordinal_(ordinal) {
+	}
+
+	constexpr DerivedT operator*() const {
+	  return DerivedT::fromOrdinal(ordinal_);
+	}
+	constexpr DerivedT operator[](ptrdiff_t n) const {
+	  return DerivedT::fromOrdinal(ordinal_ + n);
+	}
+	const_iterator& operator++() { ++ordinal_; return *this; }
+	const_iterator operator++(int) {
+	  const_iterator tmp(*this);
+	  ++ordinal_;
+	  return tmp;
+	}
+	const_iterator& operator--() { --ordinal_; return *this; }
+	const_iterator operator--(int) {
+	  const_iterator tmp(*this);
+	  --ordinal_;
+	  return tmp;
+	}
+	const_iterator& operator+=(ptrdiff_t n) { ordinal_ += n; return *this; }
+	const_iterator& operator-=(ptrdiff_t n) { ordinal_ -= n; return *this; }
+	const_iterator operator+(ptrdiff_t n) const {
+	  return const_iterator(ordinal_ + n);
+	}
+	const_iterator operator-(ptrdiff_t n) const {
+	  return const_iterator(ordinal_ - n);
+	}
+	ptrdiff_t operator-(const const_iterator& other) const {
+	  return (ptrdiff_t)ordinal_ - (ptrdiff_t)other.ordinal_;
+	}
+	bool operator==(const const_iterator& other) const {
+	  return ordinal_ == other.ordinal_;
+	}
+	bool operator!=(const const_iterator& other) const {
+	  return ordinal_ != other.ordinal_;
+	}
+	bool operator<(const const_iterator& other) const {
+	  return ordinal_ < other.ordinal_;
+	}
+
+      private:
+	size_t ordinal_;
+      };
+      typedef const_iterator iterator;
+
+    public:
+      constexpr size_t size() const { return DerivedT::TABLE.size(); }
+      constexpr bool empty() const { return !size(); }
+      constexpr const_iterator begin() const { return const_iterator(0); }
+      constexpr const_iterator end() const { return const_iterator(size()); }
+      constexpr DerivedT operator[](size_t ordinal) const {
+	return DerivedT::fromOrdinal(ordinal);
+      }
+    };
+
+    /** @brief An enumeration whose members, names, values and lookup
+     *         tables are all built at compile time.
+     *
+     *  ConstexprEnum offers the same interface as Enum, but nothing runs
+     *  at program startup:  each member is just an ordinal into a
+     *  ConstexprEnumTable that lives in read-only data.  The derived class
+     *  declares the table as a static constexpr member named @c TABLE and
+     *  gives ConstexprEnum access to a constexpr constructor that takes
+     *  the ordinal:
+     *  <code>
+     *    class Color : public ConstexprEnum<Color> {
+     *    public:
+     *      static const Color RED;
+     *      static const Color GREEN;
+     *
+     *      static constexpr auto TABLE = makeConstexprEnumTable<int>({
+     *        { 1, "RED" }, { 2, "GREEN" }
+     *      });
+     *
+     *    private:
+     *      friend class ConstexprEnum<Color>;
+     *      constexpr Color(uint32_t ordinal): ConstexprEnum(ordinal) { }
+     *    };
+     *
+     *    constexpr decltype(Color::TABLE) Color::TABLE;
+     *    constexpr Color Color::RED(TABLE.findName("RED"));
+     *    constexpr Color Color::GREEN(TABLE.findName("GREEN"));
+     *  </code>
+     *
+     *  Looking each member up by name ties it to its row of the table:
+     *  a name that is not in the table gives an ordinal past its end,
+     *  which the constructor rejects at compile time.
+     *
+     *  Because member names live in the table rather than in a
+     *  std::string, name() returns a StringView.
+     */
+    template <typename DerivedT, typename ValueT = int>
+    class ConstexprEnum {
+    public:
+      typedef ValueT ValueType;
+
+    public:
+      constexpr ValueT value() const {
+	return DerivedT::TABLE.value(ordinal_);
+      }
+
+      constexpr StringView name() const {
+	return DerivedT::TABLE.name(ordinal_);
+      }
+
+      /** @brief Write the name into the @e size characters at @e buffer,
+       *         with the same semantics as Enum::formatTo()
+       */
+      size_t formatTo(char* buffer, size_t size) const {
+	return name().copyTo(buffer, size);
+      }
+
+      /** @brief Append the name to @e out */
+      void appendTo(std::string& out) const {
+	out.append(name().data(), name().size());
+      }
+
+      /** @brief Position of this member in values() */
+      constexpr size_t ordinal() const { return ordinal_; }
+
+      /** @brief Hash code that identifies this member.  See EnumHash. */
+      constexpr size_t hash() const { return ordinal_; }
+
+      constexpr bool operator==(const DerivedT& other) const {
+	return ordinal_ == other.ordinal_;
+      }
+      constexpr bool operator!=(const DerivedT& other) const {
+	return ordinal_ != other.ordinal_;
+      }
+      constexpr bool operator<(const DerivedT& other) const {
+	return value() < other.value();
+      }
+      constexpr bool operator>(const DerivedT& other) const {
+	return value() > other.value();
+      }
+      constexpr bool operator<=(const DerivedT& other) const {
+	return value() <= other.value();
+      }
+      constexpr bool operator>=(const DerivedT& other) const {
+	return value() >= other.value();
+      }
+
+      static DerivedT fromValue(ValueT value) {
+	const size_t ordinal = DerivedT::TABLE.findValue(value);
+	if (ordinal == DerivedT::TABLE.size()) {
+	  std::ostringstream msg;
+	  msg << "Member of " << typeName<DerivedT>() << " with value "
+	      << value;
+	  throw exceptions::NoSuchItem(msg.str(), PISTIS_EX_HERE);
+	}
+	return DerivedT((uint32_t)ordinal);
+      }
+
+      static DerivedT fromName(const StringView& name) {
+	const size_t ordinal = DerivedT::TABLE.findName(name);
+	if (ordinal == DerivedT::TABLE.size()) {
+	  std::ostringstream msg;
+	  msg << "Member of " << typeName<DerivedT>() << " with name \""
+	      << name << "\"";
+	  throw exceptions::NoSuchItem(msg.str(), PISTIS_EX_HERE);
+	}
+	return DerivedT((uint32_t)ordinal);
+      }
+
+      static DerivedT fromName(const char* name, size_t n) {
+	return fromName(StringView(name, n));
+      }
+
+      static Optional<DerivedT> tryFromValue(ValueT value) {
+	const size_t ordinal = DerivedT::TABLE.findValue(value);
+	return (ordinal == DerivedT::TABLE.size())
+		   ? Optional<DerivedT>()
+		   : Optional<DerivedT>(DerivedT((uint32_t)ordinal));
+      }
+
+      static Optional<DerivedT> tryFromName(const StringView& name) {
+	const size_t ordinal = DerivedT::TABLE.findName(name);
+	return (ordinal == DerivedT::TABLE.size())
+		   ? Optional<DerivedT>()
+		   : Optional<DerivedT>(DerivedT((uint32_t)ordinal));
+      }
+
+      static Optional<DerivedT> tryFromName(const char* name, size_t n) {
+	return tryFromName(StringView(name, n));
+      }
+
+      /** @brief Returns the member whose ordinal is @e ordinal
+       *
+       *  @throws NoSuchItem  if there is no such member
+       */
+      static constexpr DerivedT fromOrdinal(size_t ordinal) {
+	return (ordinal < DerivedT::TABLE.size())
+		   ? DerivedT((uint32_t)ordinal) : noSuchOrdinal_(ordinal);
+      }
+
+      static constexpr ConstexprEnumValues<DerivedT> values() {
+	return ConstexprEnumValues<DerivedT>();
+      }
+
+    protected:
+      /** @brief Create the member whose ordinal is @e ordinal
+       *
+       *  An ordinal outside TABLE makes the definition of a constexpr
+       *  member fail to compile, and throws NoSuchItem at run time.
+       */
+      constexpr ConstexprEnum(uint32_t ordinal):
+	  ordinal_((ordinal < DerivedT::TABLE.size())
+		     ? ordinal : badOrdinal_(ordinal)) {
+      }
+
+    private:
+      uint32_t ordinal_;
+
+      // Not constexpr, so calling it stops constant evaluation
+      static uint32_t badOrdinal_(size_t ordinal) {
+	noSuchOrdinal_(ordinal);
+	return 0;
+      }
+
+      static DerivedT noSuchOrdinal_(size_t ordinal) {
+	std::ostringstream msg;
+	msg << "Member of " << typeName<DerivedT>() << " with ordinal "
+	    << ordinal;
+	throw exceptions::NoSuchItem(msg.str(), PISTIS_EX_HERE);
+      }
+    };
+
+    template <typename DerivedT, typename ValueT>
+    inline std::ostream& operator<<(std::ostream& out,
+				    const ConstexprEnum<DerivedT, ValueT>& e) {
+      return out << e.name();
+    }
+
+  }
+}
+#endif
@@ -2,63 +2,1039 @@
 #define __PISTIS__TYPEUTIL__ENUM_HPP__
 
 #include <pistis/typeutil/NameOf.hpp>
+#include <pistis/typeutil/NameTrie.hpp>
+#include <pistis/typeutil/Optional.hpp>
+#include <pistis/typeutil/PerfectHash.hpp>
+#include <pistis/typeutil/StringView.hpp>
 #include <pistis/exceptions/NoSuchItem.hpp>
+#include <algorithm>
+#include <atomic>
+#include <deque>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
+#include <stdint.h>
+#include <string.h>
 
 namespace pistis {
   namespace typeutil {
 
+    template <typename DerivedT, typename ImplT> class Enum;
+
+    namespace detail {
+
+      /** @brief Bump allocator that holds the impls and names of the
+       *         members of one enumeration.
+       *
+       *  Memory is carved out of chunks that double in size up to 1MB,
+       *  so registering thousands of members takes only a handful of
+       *  allocations, and the chunks are released all at once when the
+       *  arena is destroyed, without visiting the objects inside them.
+       */
+      class EnumArena {
+      public:
+	EnumArena(): _current(nullptr), _remaining(0), _nextChunkSize(4096) {
+	}
+	EnumArena(const EnumArena&) = delete;
+	~EnumArena() {
+	  for (auto i= _chunks.begin(); i != _chunks.end(); ++i) {
+	    ::operator delete(i->first);
+	  }
+	}
+
+	EnumArena& operator=(const EnumArena&) = delete;
+
+	void* allocate(size_t size, size_t alignment) {
+	  size_t padding= (alignment - ((uintptr_t)_current % alignment))
+			    % alignment;
+	  if (!_current || ((size + padding) > _remaining)) {
+	    _newChunk(size + alignment);
+	    padding= (alignment - ((uintptr_t)_current % alignment))
+		       % alignment;
+	  }
+	  char* p= _current + padding;
+	  _current= p + size;
+	  _remaining-= size + padding;
+	  return p;
+	}
+
+	/** @brief Copy @e n characters into the arena */
+	StringView copy(const char* s, size_t n) {
+	  char* p= (char*)allocate(n + 1, 1);
+	  ::memcpy(p, s, n);
+	  p[n]= 0;
+	  return StringView(p, n);
+	}
+
+      private:
+	std::vector< std::pair<char*, size_t> > _chunks;
+	char* _current;
+	size_t _remaining;
+	size_t _nextChunkSize;
+
+	void _newChunk(size_t minSize) {
+	  const size_t size= std::max(minSize, _nextChunkSize);
+	  _chunks.push_back(std::make_pair((char*)::operator new(size), size));
+	  _current= _chunks.back().first;
+	  _remaining= size;
+	  if (_nextChunkSize < (1 << 20)) {
+	    _nextChunkSize*= 2;
+	  }
+	}
+      };
+
+      /** @brief Epoch at which a thread last started a lookup */
+      struct EnumReaderSlot {
+	std::atomic<uint64_t> epoch;
+	EnumReaderSlot* next;
+	std::atomic<bool> inUse;
+	char padding[64 - sizeof(uint64_t) - sizeof(void*) - sizeof(bool)];
+
+	EnumReaderSlot(): epoch(0), next(nullptr), inUse(true) { }
+      };
+
+      /** @brief Tells when snapshots that lookups may still be reading
+       *         can be freed, for the member data of all enumerations
+       *
+       *  Quiescent-state-based reclamation: each thread records the
+       *  reader epoch in a slot of its own when it starts a lookup,
+       *  which also means it is done with the snapshot read by its
+       *  previous lookup.  A snapshot that was replaced when epoch @e e
+       *  ended can be freed once every slot holds a later epoch.  That
+       *  costs a lookup one ordinary store, but a thread that stops
+       *  doing lookups holds back reclamation until it does another one
+       *  or exits.  Lookups must not nest.
+       */
+      class EnumReaders {
+      public:
+	enum : uint64_t { IDLE= ~(uint64_t)0 };  ///< Slot of an exited thread
+
+	/** @brief Call at the start of each lookup, before loading the
+	 *         snapshot pointer
+	 */
+	static void enter() {
+	  EnumReaderSlot* slot= _threadSlot();
+	  (slot ? *slot : _newSlot()).epoch.store(_epoch().load(std::memory_order_acquire),
+			      std::memory_order_release);
+	}
+
+	/** @brief End the current epoch, after replacing a snapshot
+	 *
+	 *  @returns  The epoch that ended
+	 */
+	static uint64_t retire() {
+	  return _epoch().fetch_add(1, std::memory_order_seq_cst);
+	}
+
+	/** @brief Earliest epoch in which a thread other than the caller
+	 *         may have started the lookup it is doing now
+	 *
+	 *  Snapshots replaced when an earlier epoch ended can be freed.
+	 */
+	static uint64_t oldestReader() {
+	  EnumReaderSlot* slot= _threadSlot();
+	  (slot ? *slot : _newSlot()).epoch.store(_epoch().load(std::memory_order_seq_cst),
+			      std::memory_order_release);
+	  uint64_t oldest= IDLE;
+	  for (EnumReaderSlot* s= _head().load(std::memory_order_seq_cst); s;
+	       s= s->next) {
+	    oldest= std::min(oldest, s->epoch.load(std::memory_order_seq_cst));
+	  }
+	  return oldest;
+	}
+
+      private:
+	/** @brief Gives up the slot of a thread when it exits */
+	class SlotHolder {
+	public:
+	  SlotHolder(): slot(_acquireSlot()) { _threadSlot()= slot; }
+	  ~SlotHolder() {
+	    _threadSlot()= nullptr;
+	    slot->epoch.store(IDLE, std::memory_order_release);
+	    slot->inUse.store(false, std::memory_order_release);
+	  }
+
+	  EnumReaderSlot* const slot;
+	};
+
+	// Slots are never freed, so a static destructor cannot pull one
+	// out from under a thread that is still running.
+	static std::atomic<EnumReaderSlot*>& _head() {
+	  static std::atomic<EnumReaderSlot*> head(nullptr);
+	  return head;
+	}
+
+	static std::atomic<uint64_t>& _epoch() {
+	  static std::atomic<uint64_t> epoch(0);
+	  return epoch;
+	}
+
+	// A plain pointer, so lookups read it without the call that
+	// guards the construction of a thread_local object
+	static EnumReaderSlot*& _threadSlot() {
+	  static thread_local EnumReaderSlot* slot= nullptr;
+	  return slot;
+	}
+
+	static EnumReaderSlot& _newSlot() {
+	  static thread_local SlotHolder holder;
+	  return *holder.slot;
+	}
+
+	/** @brief Reuse the slot of an exited thread, or add a new one
+	 *
+	 *  The slot's epoch is at most the current one before the thread
+	 *  loads the epoch in its first lookup, and the fence keeps a
+	 *  concurrent oldestReader() from missing the slot while the lookup
+	 *  reads a stale epoch.
+	 */
+	static EnumReaderSlot* _acquireSlot() {
+	  std::atomic<EnumReaderSlot*>& head= _head();
+	  for (EnumReaderSlot* s= head.load(std::memory_order_acquire); s;
+	       s= s->next) {
+	    bool inUse= false;
+	    if (s->inUse.compare_exchange_strong(inUse, true)) {
+	      s->epoch.store(0, std::memory_order_relaxed);
+	      std::atomic_thread_fence(std::memory_order_seq_cst);
+	      return s;
+	    }
+	  }
+
+	  EnumReaderSlot* s= new EnumReaderSlot();
+	  s->next= head.load(std::memory_order_relaxed);
+	  while (!head.compare_exchange_weak(s->next, s)) {
+	  }
+	  std::atomic_thread_fence(std::memory_order_seq_cst);
+	  return s;
+	}
+      };
+
+    }
+
+    /** @brief Result of matching a string against the names of the
+     *         members of an enumeration.  See
+     *         BasicEnumMemberData::matchName().
+     */
+    template <typename DerivedT>
+    struct EnumNameMatch {
+      Optional<DerivedT> exact;          ///< Member named by the string
+      Optional<DerivedT> uniquePrefix;   ///< Only member it is a prefix of
+      Optional<DerivedT> longestPrefix;  ///< Longest name it starts with
+      size_t longestPrefixLength;        ///< Length of that name
+
+      EnumNameMatch(): longestPrefixLength(0) { }
+    };
+
+    /** @brief Registry of the members of an Enum
+     *
+     *  Members register themselves through add(), normally while static
+     *  objects are being initialized.  Lookups read an immutable snapshot
+     *  of the registry.  The first lookup after a registration builds a
+     *  new snapshot, including the value and name indexes, under a lock.
+     *
+     *  Once freeze() is called, the current snapshot is published, and
+     *  lookups only load the snapshot pointer and then read immutable
+     *  data.  Members registered after freeze(), for example by a
+     *  library loaded with dlopen(), mark the snapshot stale, and the
+     *  next lookup builds a new one and swaps the pointer, RCU-style, so
+     *  concurrent readers never see a registry that is being modified
+     *  and a batch of registrations costs one rebuild.
+     *
+     *  A replaced snapshot is freed by a later registration or rebuild
+     *  once every other thread has started a lookup since it was
+     *  replaced, or has exited.  See detail::EnumReaders.  The vectors
+     *  returned by values() are kept until the registry is destroyed.
+     */
     template <typename DerivedT, typename ImplT>
     class BasicEnumMemberData {
     public:
-      BasicEnumMemberData() { }
+      typedef typename ImplT::ValueType ValueType;
+
+      /** @brief Ordinal written by the bulk decoders for invalid rows */
+      static constexpr uint32_t NO_MEMBER= ~(uint32_t)0;
+
+    public:
+      BasicEnumMemberData():
+	  _minValue(), _maxValue(), _dense(true), _frozen(false),
+	  _current(nullptr) {
+      }
       virtual ~BasicEnumMemberData() {
-	for (auto i= _impls.begin(); i != _impls.end(); ++i) {
-	  delete *i;
-	}
+	// The impls and their names go away with the arena.  Destructors
+	// only need to run for impls that hold resources of their own.
+	_destroyImpls(std::is_trivially_destructible<ImplT>());
       }
 
+      /** @brief Construct an impl inside the member data's arena, and
+       *         copy its name into the arena and into a std::string
+       *         owned by the member data
+       *
+       *  The impl is owned by this object once it is passed to add().
+       */
+      template <typename... Args>
+      ImplT* createImpl(Args&&... args) {
+	std::lock_guard<std::recursive_mutex> lock(_lock);
+	void* p= _arena.allocate(sizeof(ImplT), alignof(ImplT));
+	// The name may refer to a temporary created for the constructor's
+	// arguments, so copy it before the end of this full expression.
+	return _copyName(new(p) ImplT(std::forward<Args>(args)...));
+      }
+
+      /** @brief Register a new member
+       *
+       *  Takes ownership of @e impl, which must come from createImpl().
+       *  Safe to call concurrently with lookups.
+       */
       virtual void add(ImplT* impl, const DerivedT& dv) {
-	_valueToMember.insert(std::make_pair(impl->value(), dv));
-	_nameToMember.insert(std::make_pair(impl->name(), dv));
+	std::lock_guard<std::recursive_mutex> lock(_lock);
+	const uint32_t ordinal= (uint32_t)_members.size();
 	_members.push_back(dv);
 	_impls.push_back(impl);
+	_names.push_back(impl->nameView());
+	_indexValue(impl->value(), ordinal, IsDenseCandidate());
+
+	// The next lookup builds a new snapshot
+	_current.store(nullptr, std::memory_order_release);
+	_reclaim();
+      }
+
+      /** @brief Publish the registry as it is now, so the first lookup
+       *         does not have to build a snapshot under the lock.
+       *
+       *  Call once all statically-declared members have registered,
+       *  e.g. at the start of main() or when a plugin finishes loading.
+       */
+      void freeze() {
+	std::lock_guard<std::recursive_mutex> lock(_lock);
+	_frozen= true;
+	if (!_current.load(std::memory_order_relaxed)) {
+	  _publish();
+	}
       }
 
-      DerivedT fromName(const std::string& name) const {
-	typename std::map<std::string, DerivedT>::const_iterator i=
-	  _nameToMember.find(name);
-	if (i == _nameToMember.end()) {
+      /** @brief Number of members registered so far */
+      size_t size() const {
+	std::lock_guard<std::recursive_mutex> lock(_lock);
+	return _members.size();
+      }
+
+      /** @brief True if freeze() has been called */
+      bool frozen() const {
+	std::lock_guard<std::recursive_mutex> lock(_lock);
+	return _frozen;
+      }
+
+      DerivedT fromName(const StringView& name) const {
+	return fromName(name.data(), name.size());
+      }
+
+      /** @brief Returns the member whose name is the @e n characters
+       *         starting at @e name.
+       *
+       *  Does not copy the name or allocate memory unless the lookup
+       *  fails.
+       *
+       *  @throws NoSuchItem  if no member has the given name
+       */
+      DerivedT fromName(const char* name, size_t n) const {
+	const SnapshotReader snapshot(*this);
+	const DerivedT* member= snapshot->findName(name, n);
+	if (!member) {
 	  std::ostringstream msg;
-	  msg << "Member of " << nameOf<DerivedT>() << " with name \""
-	      << name << "\"";
+	  msg << "Member of " << typeName<DerivedT>() << " with name \""
+	      << StringView(name, n) << "\"";
 	  throw exceptions::NoSuchItem(msg.str(), PISTIS_EX_HERE);
 	}
-	return i->second;
+	return *member;
       }
 
-      DerivedT fromValue(typename ImplT::ValueType value) const {
-	typename std::map<typename ImplT::ValueType, DerivedT>::const_iterator
-	  i= _valueToMember.find(value);
-	if (i == _valueToMember.end()) {
+      DerivedT fromValue(ValueType value) const {
+	const SnapshotReader snapshot(*this);
+	const DerivedT* member= snapshot->findValue(value, IsDenseCandidate());
+	if (!member) {
 	  std::ostringstream msg;
-	  msg << "Member of " << nameOf<DerivedT>() << " with value "
+	  msg << "Member of " << typeName<DerivedT>() << " with value "
 	      << value;
 	  throw exceptions::NoSuchItem(msg.str(), PISTIS_EX_HERE);
 	}
-	return i->second;
+	return *member;
+      }
+
+      /** @brief Returns the member whose name is @e name, or an empty
+       *         Optional if there is no such member.
+       *
+       *  Unlike fromName(), a miss does not format a message or throw.
+       */
+      Optional<DerivedT> tryFromName(const StringView& name) const {
+	return tryFromName(name.data(), name.size());
+      }
+
+      Optional<DerivedT> tryFromName(const char* name, size_t n) const {
+	const SnapshotReader snapshot(*this);
+	const DerivedT* member= snapshot->findName(name, n);
+	return member ? Optional<DerivedT>(*member) : Optional<DerivedT>();
+      }
+
+      /** @brief Returns the member whose value is @e value, or an empty
+       *         Optional if there is no such member.
+       *
+       *  Unlike fromValue(), a miss does not format a message or throw.
+       */
+      Optional<DerivedT> tryFromValue(ValueType value) const {
+	const SnapshotReader snapshot(*this);
+	const DerivedT* member= snapshot->findValue(value, IsDenseCandidate());
+	return member ? Optional<DerivedT>(*member) : Optional<DerivedT>();
+      }
+
+      /** @brief All members, in ordinal order
+       *
+       *  The vector belongs to the current snapshot and does not change,
+       *  even if more members are registered later.  It lives as long as
+       *  the registry, so a program that calls values() between late
+       *  registrations keeps one vector for each such call.
+       */
+      const std::vector<DerivedT>& values() const {
+	const SnapshotReader snapshot(*this);
+
+	// Only the first call writes, so callers do not all dirty the
+	// snapshot's cache line
+	if (!snapshot->pinned.load(std::memory_order_relaxed)) {
+	  snapshot->pinned.store(true, std::memory_order_relaxed);
+	}
+	return *snapshot->members;
+      }
+
+      /** @brief Returns the member whose ordinal is @e ordinal
+       *
+       *  @throws NoSuchItem  if there is no such member
+       */
+      DerivedT fromOrdinal(size_t ordinal) const {
+	const SnapshotReader snapshot(*this);
+	const std::vector<DerivedT>& members= *snapshot->members;
+	if (ordinal >= members.size()) {
+	  std::ostringstream msg;
+	  msg << "Member of " << typeName<DerivedT>() << " with ordinal "
+	      << ordinal;
+	  throw exceptions::NoSuchItem(msg.str(), PISTIS_EX_HERE);
+	}
+	return members[ordinal];
       }
 
-      const std::vector<DerivedT>& values() const { return _members; }
+      /** @brief True if fromValue() uses a directly-indexed table
+       *         rather than a tree.
+       *
+       *  The member data switches to the table whenever the member values
+       *  are integers whose range is at most denseSpanLimit() wide.
+       */
+      bool hasDenseValueIndex() const {
+	return SnapshotReader(*this)->dense;
+      }
+
+      /** @brief Match @e name against the member names, ignoring the
+       *         case of ASCII letters
+       *
+       *  Finds the member whose name equals @e name, the only member
+       *  whose name starts with @e name, and the member with the longest
+       *  name that @e name starts with, in one walk of a trie over the
+       *  names.  The trie is built by the first call for each snapshot.
+       *  Any of the three is empty if no member, or more than one
+       *  member, matches.
+       */
+      EnumNameMatch<DerivedT> matchName(const StringView& name) const {
+	const SnapshotReader reader(*this);
+	const Snapshot& snapshot= *reader;
+	const NameTrie::Match m= snapshot.trie().match(name);
+	EnumNameMatch<DerivedT> result;
+	result.exact= snapshot.optionalMember(m.exact);
+	result.uniquePrefix= snapshot.optionalMember(m.uniquePrefix);
+	result.longestPrefix= snapshot.optionalMember(m.longestPrefix);
+	result.longestPrefixLength=
+	    result.longestPrefix ? m.longestPrefixLength : 0;
+	return result;
+      }
+
+      /** @brief Returns the member whose name equals @e name when case
+       *         is ignored, if there is exactly one such member.
+       */
+      Optional<DerivedT> tryFromNameIgnoringCase(
+	  const StringView& name
+      ) const {
+	const SnapshotReader reader(*this);
+	const Snapshot& snapshot= *reader;
+	return snapshot.optionalMember(snapshot.trie().match(name).exact);
+      }
+
+      /** @brief Returns the member that @e prefix names unambiguously,
+       *         ignoring case
+       *
+       *  That is the member whose name equals @e prefix, or failing
+       *  that, the only member whose name starts with @e prefix.
+       */
+      Optional<DerivedT> tryFromPrefix(const StringView& prefix) const {
+	const SnapshotReader reader(*this);
+	const Snapshot& snapshot= *reader;
+	const NameTrie::Match m= snapshot.trie().match(prefix);
+	return snapshot.optionalMember(
+	    (m.exact < NameTrie::AMBIGUOUS) ? m.exact : m.uniquePrefix
+	);
+      }
+
+      /** @brief Returns the member with the longest name that @e text
+       *         starts with, ignoring case
+       */
+      Optional<DerivedT> tryFromLongestPrefix(const StringView& text) const {
+	const SnapshotReader reader(*this);
+	const Snapshot& snapshot= *reader;
+	return snapshot.optionalMember(snapshot.trie().match(text)
+					 .longestPrefix);
+      }
+
+      /** @brief Decode a column of names into ordinals
+       *
+       *  Writes the ordinal of the member named @e names[i] to
+       *  @e ordinals[i], or NO_MEMBER if there is no such member.  If
+       *  @e invalid is not null, it must have room for
+       *  <c>(n + 63) / 64</c> words, and bit <c>i % 64</c> of word
+       *  <c>i / 64</c> is set if row @e i is invalid.
+       *
+       *  The whole column is decoded against one snapshot, without
+       *  throwing or allocating.  Each row is first checked against
+       *  bitmasks of the lengths and first characters of the member
+       *  names, so only rows that could match are hashed.
+       *
+       *  @returns  The number of invalid rows
+       */
+      size_t decodeNames(const StringView* names, size_t n,
+			 uint32_t* ordinals, uint64_t* invalid) const {
+	return _decodeNames(NameArray{ names }, n, OrdinalWriter{ ordinals },
+			    invalid);
+      }
+
+      /** @brief Decode a column of names into members
+       *
+       *  Like decodeNames() above, but assigns the matching members to
+       *  @e members.  Entries for invalid rows are left unchanged.
+       */
+      size_t decodeNames(const StringView* names, size_t n,
+			 DerivedT* members, uint64_t* invalid) const {
+	return _decodeNames(NameArray{ names }, n, MemberWriter{ members },
+			    invalid);
+      }
+
+      /** @brief Decode a column of names stored back to back, as in an
+       *         Arrow string column
+       *
+       *  Name @e i runs from <c>data + offsets[i]</c> up to
+       *  <c>data + offsets[i + 1]</c>, so @e offsets has n + 1 entries.
+       *  Otherwise the same as decodeNames() above.
+       */
+      size_t decodeNames(const char* data, const uint32_t* offsets,
+			 size_t n, uint32_t* ordinals,
+			 uint64_t* invalid) const {
+	return _decodeNames(NameBuffer{ data, offsets }, n,
+			    OrdinalWriter{ ordinals }, invalid);
+      }
+
+      /** @brief Decode a column of values into ordinals
+       *
+       *  Same as decodeNames(), but matches member values.
+       */
+      size_t decodeValues(const ValueType* values, size_t n,
+			  uint32_t* ordinals, uint64_t* invalid) const {
+	return _decodeValues(values, n, OrdinalWriter{ ordinals }, invalid);
+      }
+
+      /** @brief Decode a column of values into members
+       *
+       *  Entries in @e members for invalid rows are left unchanged.
+       */
+      size_t decodeValues(const ValueType* values, size_t n,
+			  DerivedT* members, uint64_t* invalid) const {
+	return _decodeValues(values, n, MemberWriter{ members }, invalid);
+      }
+
+    protected:
+      /** @brief Lock held while a member is being created and added
+       *
+       *  Enum holds it from the creation of a member's impl through
+       *  add(), so the member's ordinal is its position in values()
+       *  even when members register from several threads.
+       */
+      std::recursive_mutex& registrationLock() const { return _lock; }
+
+      template <typename, typename>
+      friend class Enum;
+
+      /** @brief Maximum width of the value range that is indexed by a
+       *         table when the enumeration has @e numMembers members.
+       *
+       *  Keeps the table at no more than four slots per member, but
+       *  always allows small enumerations with a few gaps to use it.
+       */
+      static size_t denseSpanLimit(size_t numMembers) {
+	return (numMembers < 16) ? 64 : (numMembers * 4);
+      }
 
     private:
-      std::map<typename ImplT::ValueType, DerivedT> _valueToMember;
-      std::map<std::string, DerivedT> _nameToMember;
+      typedef std::integral_constant<
+	  bool,
+	  std::is_integral<ValueType>::value &&
+	      !std::is_same<ValueType, bool>::value
+      > IsDenseCandidate;
+
+      /** @brief Immutable copy of the registry that lookups read */
+      struct Snapshot {
+	// Separate from the snapshot, so values() can outlive it
+	std::unique_ptr< const std::vector<DerivedT> > members;
+	const DerivedT* memberArray;       ///< members->data()
+	mutable std::atomic<bool> pinned;  ///< values() returned members
+	std::vector<StringView> names;
+	std::map<ValueType, uint32_t> valueToOrdinal; ///< Used when sparse
+	std::vector<uint32_t> valueIndex;  ///< Value - minValue -> ordinal
+	ValueType minValue;
+	bool dense;
+	PerfectHashIndex nameIndex;
+	std::vector<uint32_t> nameOrdinals;  ///< One per distinct name
+	uint64_t nameLengths;    ///< Bit min(length, 63) set for each name
+	uint64_t firstChars[4];  ///< Bit c set if a name starts with c
+
+	// Built by the first lookup that needs it, since most enumerations
+	// are only ever looked up by their exact names
+	mutable std::once_flag nameTrieBuilt;
+	mutable NameTrie nameTrie;
+
+	const NameTrie& trie() const {
+	  std::call_once(nameTrieBuilt, [this]() {
+	      std::vector<StringView> distinct;
+	      distinct.reserve(nameOrdinals.size());
+	      for (uint32_t i : nameOrdinals) {
+		distinct.push_back(names[i]);
+	      }
+	      nameTrie.build(distinct.data(), nameOrdinals.data(),
+			     distinct.size());
+	  });
+	  return nameTrie;
+	}
+
+	/** @brief False if no member's name has the same length and
+	 *         first character as @e name
+	 */
+	bool mayBeName(const char* name, size_t n) const {
+	  const unsigned char c= n ? (unsigned char)name[0] : 0;
+	  return (nameLengths >> std::min(n, (size_t)63)) &
+		   (firstChars[c >> 6] >> (c & 63)) & 1;
+	}
+
+	uint32_t findNameOrdinal(const char* name, size_t n) const {
+	  const uint32_t ordinal= nameIndex.find(name, n);
+	  if (ordinal == PerfectHashIndex::NOT_FOUND) {
+	    return NO_MEMBER;
+	  }
+	  const StringView& candidate= names[ordinal];
+	  return ((candidate.size() == n) &&
+		  !::memcmp(candidate.data(), name, n))
+		   ? ordinal : NO_MEMBER;
+	}
+
+	uint32_t findValueOrdinal(ValueType value, std::true_type) const {
+	  if (dense) {
+	    const uint64_t offset= _offset(value, minValue);
+	    return (offset < valueIndex.size()) ? valueIndex[offset]
+						: NO_MEMBER;
+	  }
+	  return findValueOrdinal(value, std::false_type());
+	}
+
+	uint32_t findValueOrdinal(ValueType value, std::false_type) const {
+	  auto i= valueToOrdinal.find(value);
+	  return (i == valueToOrdinal.end()) ? NO_MEMBER : i->second;
+	}
+
+	const DerivedT* findName(const char* name, size_t n) const {
+	  return memberAt(findNameOrdinal(name, n));
+	}
+
+	template <typename IsDense>
+	const DerivedT* findValue(ValueType value, IsDense isDense) const {
+	  return memberAt(findValueOrdinal(value, isDense));
+	}
+
+	Snapshot(): memberArray(nullptr), pinned(false) { }
+
+	const DerivedT* memberAt(uint32_t ordinal) const {
+	  return (ordinal == NO_MEMBER) ? nullptr : memberArray + ordinal;
+	}
+
+	/** @brief Returns the member for an id from the name trie */
+	Optional<DerivedT> optionalMember(uint32_t ordinal) const {
+	  return (ordinal < NameTrie::AMBIGUOUS)
+		   ? Optional<DerivedT>(memberArray[ordinal])
+		   : Optional<DerivedT>();
+	}
+      };
+
+      // Sources and destinations for the bulk decoders
+      struct NameArray {
+	const StringView* names;
+
+	StringView operator[](size_t i) const { return names[i]; }
+      };
+
+      struct NameBuffer {
+	const char* data;
+	const uint32_t* offsets;
+
+	StringView operator[](size_t i) const {
+	  return StringView(data + offsets[i], offsets[i + 1] - offsets[i]);
+	}
+      };
+
+      struct OrdinalWriter {
+	uint32_t* ordinals;
+
+	void put(const Snapshot&, size_t row, uint32_t ordinal) const {
+	  ordinals[row]= ordinal;
+	}
+      };
+
+      struct MemberWriter {
+	DerivedT* members;
+
+	void put(const Snapshot& snapshot, size_t row,
+		 uint32_t ordinal) const {
+	  if (ordinal != NO_MEMBER) {
+	    members[row]= snapshot.memberArray[ordinal];
+	  }
+	}
+      };
+
+      // Registration state, guarded by _lock
+      mutable std::recursive_mutex _lock;
+      std::map<ValueType, uint32_t> _valueToOrdinal; ///< Used when sparse
+      ValueType _minValue;
+      ValueType _maxValue;
+      bool _dense;
+      bool _frozen;
       std::vector<DerivedT> _members;	
       std::vector<ImplT*> _impls;
+      std::vector<StringView> _names;  ///< The impls' names, in _arena
+      std::deque<std::string> _nameStrings;  ///< Returned by name()
+      detail::EnumArena _arena;
+
+      // Snapshots.  _current is null when the registry has changed
+      // since _latest was built.  Replaced snapshots wait in _retired,
+      // with the reader epoch that ended when they were replaced, until
+      // no lookup can be reading them.  All but _current are guarded by
+      // _lock.
+      mutable std::atomic<const Snapshot*> _current;
+      mutable std::unique_ptr<Snapshot> _latest;
+      mutable std::vector< std::pair< uint64_t, std::unique_ptr<Snapshot> > >
+	  _retired;
+      mutable std::vector<
+	  std::unique_ptr< const std::vector<DerivedT> >
+      > _pinned;
+
+      /** @brief The current snapshot, which is not freed until the
+       *         calling thread starts another lookup
+       */
+      class SnapshotReader {
+      public:
+	explicit SnapshotReader(const BasicEnumMemberData& data) {
+	  detail::EnumReaders::enter();
+	  _snapshot= data._current.load(std::memory_order_acquire);
+	  if (!_snapshot) {
+	    std::lock_guard<std::recursive_mutex> lock(data._lock);
+	    _snapshot= data._current.load(std::memory_order_relaxed);
+	    if (!_snapshot) {
+	      _snapshot= data._publish();
+	    }
+	  }
+	}
+
+	const Snapshot& operator*() const { return *_snapshot; }
+	const Snapshot* operator->() const { return _snapshot; }
+
+      private:
+	const Snapshot* _snapshot;
+      };
+
+      /** @brief Build a snapshot of the registry and make it current
+       *
+       *  @pre  The caller holds _lock
+       */
+      const Snapshot* _publish() const {
+	std::unique_ptr<Snapshot> snapshot(new Snapshot());
+	snapshot->members.reset(new std::vector<DerivedT>(_members));
+	snapshot->memberArray= snapshot->members->data();
+	snapshot->names= _names;
+	snapshot->valueToOrdinal= _valueToOrdinal;
+	snapshot->minValue= _minValue;
+	snapshot->dense= _dense;
+	if (_dense && !_impls.empty()) {
+	  _buildValueIndex(*snapshot, IsDenseCandidate());
+	}
+	_buildNameIndex(*snapshot);
+	_buildNameFilter(*snapshot);
+
+	// add() already cleared _current, so no new lookup can load the
+	// snapshot being replaced.
+	if (_latest) {
+	  _retired.push_back(std::make_pair(detail::EnumReaders::retire(),
+					    std::move(_latest)));
+	}
+	_latest= std::move(snapshot);
+	_current.store(_latest.get(), std::memory_order_release);
+	_reclaim();
+	return _latest.get();
+      }
+
+      /** @brief Free the replaced snapshots that no lookup can be
+       *         reading, keeping the vectors that values() returned
+       *
+       *  @pre  The caller holds _lock
+       */
+      void _reclaim() const {
+	if (_retired.empty()) {
+	  return;
+	}
+
+	const uint64_t oldest= detail::EnumReaders::oldestReader();
+	auto live= _retired.begin();
+	for (auto i= _retired.begin(); i != _retired.end(); ++i) {
+	  if (i->first >= oldest) {
+	    *live++= std::move(*i);
+	  } else if (i->second->pinned.load(std::memory_order_relaxed)) {
+	    _pinned.push_back(std::move(i->second->members));
+	  }
+	}
+	_retired.erase(live, _retired.end());
+      }
+
+      ImplT* _copyName(ImplT* impl) {
+	const StringView name= _arena.copy(impl->nameView().data(),
+					   impl->nameView().size());
+	_nameStrings.push_back(name.str());
+	impl->_setName(name, &_nameStrings.back());
+	return impl;
+      }
+
+      void _destroyImpls(std::true_type) { }
+
+      void _destroyImpls(std::false_type) {
+	for (ImplT* impl : _impls) {
+	  impl->~ImplT();
+	}
+      }
+
+      void _buildNameIndex(Snapshot& snapshot) const {
+	// When two members have the same name, the first one wins
+	std::vector<uint32_t> ordinals(_names.size());
+	for (uint32_t i= 0; i < ordinals.size(); ++i) {
+	  ordinals[i]= i;
+	}
+	std::stable_sort(ordinals.begin(), ordinals.end(),
+			 [this](uint32_t x, uint32_t y) {
+			   return _names[x] < _names[y];
+			 });
+	ordinals.erase(
+	    std::unique(ordinals.begin(), ordinals.end(),
+			[this](uint32_t x, uint32_t y) {
+			  return _names[x] == _names[y];
+			}),
+	    ordinals.end()
+	);
+
+	std::vector<StringView> names;
+	names.reserve(ordinals.size());
+	for (uint32_t i : ordinals) {
+	  names.push_back(_names[i]);
+	}
+	snapshot.nameIndex.build(names.data(), ordinals.data(), names.size());
+	snapshot.nameOrdinals.swap(ordinals);
+      }
+
+      void _buildNameFilter(Snapshot& snapshot) const {
+	snapshot.nameLengths= 0;
+	std::fill(snapshot.firstChars, snapshot.firstChars + 4, 0);
+	for (const StringView& name : _names) {
+	  const unsigned char c= name.size() ? (unsigned char)name[0] : 0;
+	  snapshot.nameLengths|= (uint64_t)1 << std::min(name.size(),
+							   (size_t)63);
+	  snapshot.firstChars[c >> 6]|= (uint64_t)1 << (c & 63);
+	}
+      }
+
+      template <typename Names, typename Writer>
+      size_t _decodeNames(const Names& names, size_t n,
+			  const Writer& writer, uint64_t* invalid) const {
+	const SnapshotReader reader(*this);
+	const Snapshot& snapshot= *reader;
+	return _decode(snapshot, n, writer, invalid, [&](size_t row) {
+	    const StringView name= names[row];
+	    return snapshot.mayBeName(name.data(), name.size())
+		     ? snapshot.findNameOrdinal(name.data(), name.size())
+		     : NO_MEMBER;
+	});
+      }
+
+      template <typename Writer>
+      size_t _decodeValues(const ValueType* values, size_t n,
+			   const Writer& writer, uint64_t* invalid) const {
+	const SnapshotReader reader(*this);
+	const Snapshot& snapshot= *reader;
+	return _decode(snapshot, n, writer, invalid, [&](size_t row) {
+	    return snapshot.findValueOrdinal(values[row], IsDenseCandidate());
+	});
+      }
+
+      /** @brief Write <c>lookup(row)</c> for each row, and build the
+       *         invalid-row bitmap a word at a time.
+       */
+      template <typename Writer, typename Lookup>
+      static size_t _decode(const Snapshot& snapshot, size_t n,
+			    const Writer& writer, uint64_t* invalid,
+			    Lookup lookup) {
+	size_t numInvalid= 0;
+	for (size_t start= 0; start < n; start+= 64) {
+	  const size_t count= std::min(n - start, (size_t)64);
+	  uint64_t bad= 0;
+	  for (size_t i= 0; i < count; ++i) {
+	    const uint32_t ordinal= lookup(start + i);
+	    bad|= (uint64_t)(ordinal == NO_MEMBER) << i;
+	    writer.put(snapshot, start + i, ordinal);
+	  }
+
+	  numInvalid+= __builtin_popcountll(bad);
+	  if (invalid) {
+	    invalid[start / 64]= bad;
+	  }
+	}
+	return numInvalid;
+      }
+
+      static uint64_t _offset(ValueType value, ValueType base) {
+	// Conversion to unsigned is modular, so this is correct for both
+	// signed and unsigned value types.
+	return (uint64_t)value - (uint64_t)base;
+      }
+
+      void _indexValue(ValueType value, uint32_t ordinal, std::false_type) {
+	_dense= false;
+	_valueToOrdinal.insert(std::make_pair(value, ordinal));
+      }
+
+      /** @brief Track the range of the values, and index them in
+       *         _valueToOrdinal while it is too wide for a table
+       *
+       *  The table itself is built by _publish(), so registering n
+       *  members costs O(n) whatever order their values come in.
+       */
+      void _indexValue(ValueType value, uint32_t ordinal, std::true_type) {
+	if (!ordinal || (value < _minValue)) {
+	  _minValue= value;
+	}
+	if (!ordinal || (value > _maxValue)) {
+	  _maxValue= value;
+	}
+
+	const uint64_t span= _offset(_maxValue, _minValue);
+	if (span >= denseSpanLimit(_members.size())) {
+	  if (_dense) {
+	    _dense= false;
+	    for (uint32_t i= 0; i < ordinal; ++i) {
+	      _valueToOrdinal.insert(std::make_pair(_impls[i]->value(), i));
+	    }
+	  }
+	  _valueToOrdinal.insert(std::make_pair(value, ordinal));
+	} else if (!_dense) {
+	  _dense= true;
+	  _valueToOrdinal.clear();
+	}
+      }
+
+      void _buildValueIndex(Snapshot& snapshot, std::false_type) const { }
+
+      void _buildValueIndex(Snapshot& snapshot, std::true_type) const {
+	std::vector<uint32_t>& index= snapshot.valueIndex;
+	index.assign(_offset(_maxValue, _minValue) + 1, NO_MEMBER);
+	for (uint32_t i= 0; i < _impls.size(); ++i) {
+	  // When two members have the same value, the first one wins
+	  uint32_t& slot= index[_offset(_impls[i]->value(), _minValue)];
+	  if (slot == NO_MEMBER) {
+	    slot= i;
+	  }
+	}
+      }
+    };
+
+    template <typename DerivedT, typename ImplT>
+    constexpr uint32_t BasicEnumMemberData<DerivedT, ImplT>::NO_MEMBER;
+
+    /** @brief How an Enum refers to its member's implementation:  through
+     *         a pointer to it.
+     *
+     *  This is the default handle.  It keeps Enum instances as small as
+     *  possible, but every call to value() or ordinal() reads the impl.
+     */
+    template <typename ImplT>
+    class EnumImplPointer {
+    public:
+      EnumImplPointer(ImplT* impl): _impl(impl) { }
+
+      ImplT* impl() const { return _impl; }
+      typename ImplT::ValueType value() const { return _impl->value(); }
+      size_t ordinal() const { return _impl->ordinal(); }
+
+      /** @brief The address of the impl, which is unique to the member
+       *         and can be had without reading the impl
+       */
+      size_t hash() const { return reinterpret_cast<size_t>(_impl); }
+
+      bool operator==(const EnumImplPointer& other) const {
+	return _impl == other._impl;
+      }
+      bool operator!=(const EnumImplPointer& other) const {
+	return _impl != other._impl;
+      }
+
+    private:
+      ImplT* _impl;
+    };
+
+    /** @brief A handle that copies the member's value and ordinal into
+     *         the Enum instance itself.
+     *
+     *  Comparing, sorting and indexing by ordinal then touch only the
+     *  Enum instances, while the name and any other member data are still
+     *  reached through the pointer to the impl.
+     */
+    template <typename ImplT>
+    class InlineEnumHandle {
+    public:
+      InlineEnumHandle(ImplT* impl):
+	  _value(impl->value()), _ordinal(impl->ordinal()), _impl(impl) {
+      }
+
+      ImplT* impl() const { return _impl; }
+      typename ImplT::ValueType value() const { return _value; }
+      size_t ordinal() const { return _ordinal; }
+      size_t hash() const { return _ordinal; }
+
+      bool operator==(const InlineEnumHandle& other) const {
+	return _impl == other._impl;
+      }
+      bool operator!=(const InlineEnumHandle& other) const {
+	return _impl != other._impl;
+      }
+
+    private:
+      typename ImplT::ValueType _value;
+      uint32_t _ordinal;
+      ImplT* _impl;
     };
 
     template <typename BaseTypeT>
@@ -74,16 +1050,34 @@ namespace pistis {
 	typedef BasicEnumMemberData<DerivedT, ImplT> type;
       };
 
+      template <typename ImplT>
+      struct Handle {
+	typedef EnumImplPointer<ImplT> type;
+      };
+
     public:
-      BasicEnumImpl(BaseTypeT value, const std::string& name):
-	_value(value), _name(name) {
-      }
-      BasicEnumImpl(BaseTypeT value, std::string&& name):
-	_value(value), _name(std::move(name)) {
+      /** @brief Create the impl of a member named @e name
+       *
+       *  The impl only refers to @e name until the member data copies
+       *  it, and the copies belong to the member data, so BasicEnumImpl
+       *  is trivially destructible.
+       */
+      BasicEnumImpl(BaseTypeT value, const StringView& name):
+	_value(value), _name(name), _nameString(nullptr), _ordinal(0) {
       }
 	  
       ValueType value() const { return _value; }
-      const std::string& name() const { return _name; }
+      const std::string& name() const { return *_nameString; }
+
+      /** @brief The name, as a view of its copy in the member data's
+       *         arena
+       */
+      StringView nameView() const { return _name; }
+
+      /** @brief Position of the member in values(), assigned when the
+       *         member is registered.
+       */
+      uint32_t ordinal() const { return _ordinal; }
 	  
       template <typename DerivedT, typename ImplT>
       static BasicEnumMemberData<DerivedT, ImplT>* createMemberData() {
@@ -92,28 +1086,108 @@ namespace pistis {
 
     private:
       BaseTypeT _value;
-      std::string _name;
+      StringView _name;
+      const std::string* _nameString;
+      uint32_t _ordinal;
+
+      void _setOrdinal(uint32_t ordinal) { _ordinal= ordinal; }
+      void _setName(const StringView& name, const std::string* nameString) {
+	_name= name;
+	_nameString= nameString;
+      }
+
+      template <typename DerivedT, typename ImplT>
+      friend class Enum;
+
+      template <typename DerivedT, typename ImplT>
+      friend class BasicEnumMemberData;
+    };
+
+    /** @brief Implementation for enumerations whose members keep their
+     *         value and ordinal inline.
+     *
+     *  An Enum that uses InlineEnumImpl (or an impl derived from it) is
+     *  larger than one that uses BasicEnumImpl, but value(), ordinal()
+     *  and the comparison operators do not dereference a pointer, so
+     *  sorting a std::vector of members reads only the vector.
+     */
+    template <typename BaseTypeT>
+    class InlineEnumImpl : public BasicEnumImpl<BaseTypeT> {
+    public:
+      template <typename ImplT>
+      struct Handle {
+	typedef InlineEnumHandle<ImplT> type;
+      };
+
+    public:
+      InlineEnumImpl(BaseTypeT value, const StringView& name):
+	  BasicEnumImpl<BaseTypeT>(value, name) {
+      }
     };
 
     template <typename DerivedT, typename ImplT = BasicEnumImpl<int> >
     class Enum {
     public:
-      Enum(const Enum<DerivedT, ImplT>& other): _impl(other._impl) { }
-      Enum(Enum<DerivedT, ImplT>&& other): _impl(other._impl) { }
-      Enum(const DerivedT& other): _impl(other._impl) { }
-      Enum(DerivedT&& other): _impl(other._impl) { }
+      typedef typename ImplT::ValueType ValueType;
+
+    public:
+      Enum(const Enum<DerivedT, ImplT>& other): _handle(other._handle) { }
+      Enum(Enum<DerivedT, ImplT>&& other): _handle(other._handle) { }
+      Enum(const DerivedT& other): _handle(other._handle) { }
+      Enum(DerivedT&& other): _handle(other._handle) { }
       
-      typename ImplT::ValueType value() const { return _impl->value(); }
-      const std::string& name() const { return _impl->name(); }
+      typename ImplT::ValueType value() const { return _handle.value(); }
+      const std::string& name() const { return _handle.impl()->name(); }
+
+      /** @brief The name as a StringView, which refers to the same
+       *         characters for as long as the member exists
+       */
+      StringView nameView() const { return _handle.impl()->nameView(); }
+
+      /** @brief Write the name into the @e size characters at @e buffer
+       *         without going through an ostream
+       *
+       *  Has the semantics of snprintf():  writes at most
+       *  <c>size - 1</c> characters followed by a null and returns the
+       *  length of the name, so a result of @e size or more means the
+       *  name was truncated.
+       */
+      size_t formatTo(char* buffer, size_t size) const {
+	return nameView().copyTo(buffer, size);
+      }
+
+      /** @brief Append the name to @e out */
+      void appendTo(std::string& out) const {
+	const StringView n= nameView();
+	out.append(n.data(), n.size());
+      }
+
+      /** @brief Position of this member in values()
+       *
+       *  Ordinals are assigned densely, starting from zero, in the order
+       *  the members are registered, so they can index per-member arrays
+       *  such as EnumMap and EnumSet.
+       */
+      size_t ordinal() const { return _handle.ordinal(); }
+
+      /** @brief Hash code that identifies this member
+       *
+       *  Distinct members have distinct hash codes, and computing one
+       *  never reads the member's impl: it is the impl's address, or the
+       *  ordinal when the handle keeps it inline.  Hash codes may change
+       *  from one run of the program to the next, so do not persist
+       *  them.  See EnumHash.
+       */
+      size_t hash() const { return _handle.hash(); }
 
       Enum& operator=(const Enum&)= default;
       Enum& operator=(Enum&&)= default;
 
       bool operator==(const DerivedT& other) const {
-	return _impl == other._impl;
+	return _handle == other._handle;
       }
       bool operator!=(const DerivedT& other) const {
-	return _impl != other._impl;
+	return _handle != other._handle;
       }
       bool operator<(const DerivedT& other) const {
 	return value() < other.value();
@@ -132,35 +1206,140 @@ namespace pistis {
 	return _members->fromValue(value);
       }
 
-      static DerivedT fromName(const std::string& name) {
+      static DerivedT fromName(const StringView& name) {
 	return _members->fromName(name);
       }
 
+      static DerivedT fromName(const char* name, size_t n) {
+	return _members->fromName(name, n);
+      }
+
+      static Optional<DerivedT> tryFromValue(
+	  typename ImplT::ValueType value
+      ) {
+	return _members->tryFromValue(value);
+      }
+
+      static Optional<DerivedT> tryFromName(const StringView& name) {
+	return _members->tryFromName(name);
+      }
+
+      static Optional<DerivedT> tryFromName(const char* name, size_t n) {
+	return _members->tryFromName(name, n);
+      }
+
+      static DerivedT fromOrdinal(size_t ordinal) {
+	return _members->fromOrdinal(ordinal);
+      }
+
+      /** @brief Case-insensitive and prefix lookups by name.  See
+       *         BasicEnumMemberData::matchName().
+       */
+      static EnumNameMatch<DerivedT> matchName(const StringView& name) {
+	return _members->matchName(name);
+      }
+
+      static Optional<DerivedT> tryFromNameIgnoringCase(
+	  const StringView& name
+      ) {
+	return _members->tryFromNameIgnoringCase(name);
+      }
+
+      static Optional<DerivedT> tryFromPrefix(const StringView& prefix) {
+	return _members->tryFromPrefix(prefix);
+      }
+
+      static Optional<DerivedT> tryFromLongestPrefix(const StringView& text) {
+	return _members->tryFromLongestPrefix(text);
+      }
+
+      /** @brief Publish the registry of members so lookups read an
+       *         immutable snapshot.  See BasicEnumMemberData::freeze().
+       */
+      static void freeze() { _getMembers()->freeze(); }
+
       static const std::vector<DerivedT>& values() {
 	return _members->values();
       }
 
+      /** @brief Decode a column of names or values in one call.  See
+       *         BasicEnumMemberData::decodeNames().
+       */
+      static size_t decodeNames(const StringView* names, size_t n,
+				uint32_t* ordinals, uint64_t* invalid) {
+	return _members->decodeNames(names, n, ordinals, invalid);
+      }
+
+      static size_t decodeNames(const StringView* names, size_t n,
+				DerivedT* members, uint64_t* invalid) {
+	return _members->decodeNames(names, n, members, invalid);
+      }
+
+      static size_t decodeNames(const char* data, const uint32_t* offsets,
+				size_t n, uint32_t* ordinals,
+				uint64_t* invalid) {
+	return _members->decodeNames(data, offsets, n, ordinals, invalid);
+      }
+
+      static size_t decodeValues(const typename ImplT::ValueType* values,
+				 size_t n, uint32_t* ordinals,
+				 uint64_t* invalid) {
+	return _members->decodeValues(values, n, ordinals, invalid);
+      }
+
+      static size_t decodeValues(const typename ImplT::ValueType* values,
+				 size_t n, DerivedT* members,
+				 uint64_t* invalid) {
+	return _members->decodeValues(values, n, members, invalid);
+      }
+
     protected:
       typedef typename ImplT::template MemberData<DerivedT, ImplT>::type
               MemberDataType;
+      typedef typename ImplT::template Handle<ImplT>::type HandleType;
 
       template <typename... Args>
-      Enum(Args&&... args): _impl(new ImplT(std::forward<Args>(args)...)) {
+      Enum(Args&&... args):
+	  _handle(_createImpl(std::forward<Args>(args)...)) {
+	// _createImpl() left the registry locked
+	std::lock_guard<std::recursive_mutex> lock(
+	    _members->registrationLock(), std::adopt_lock
+	);
 	DerivedT& dv= static_cast<DerivedT&>(*this);
-	if (!_members) {
-	  _members= ImplT::template createMemberData<DerivedT, ImplT>();
-	}
-	_members->add(_impl, dv);
+	_members->add(_handle.impl(), dv);
       }
-      Enum(ImplT* impl): _impl(impl) { }
+      Enum(ImplT* impl): _handle(impl) { }
       
-      ImplT* _getImpl() const { return _impl; }
-      void _setImpl(ImplT* impl) { _impl= impl; }
-      static MemberDataType* _getMembers() { return _members; }
+      ImplT* _getImpl() const { return _handle.impl(); }
+      void _setImpl(ImplT* impl) { _handle= HandleType(impl); }
+      static MemberDataType* _getMembers() {
+	std::call_once(_membersCreated, []() {
+	    if (!_members) {
+	      _members= ImplT::template createMemberData<DerivedT, ImplT>();
+	    }
+	});
+	return _members;
+      }
       static void _setMembers(MemberDataType* m) { _members= m; }
 
     private:
-      ImplT* _impl;
+      HandleType _handle;
+
+      // The ordinal is assigned before the handle is built and the member
+      // is added, so handles that copy it are complete when add() runs.
+      // Returns with the registry locked; the constructor unlocks it.
+      template <typename... Args>
+      static ImplT* _createImpl(Args&&... args) {
+	_getMembers()->registrationLock().lock();
+	try {
+	  ImplT* impl= _members->createImpl(std::forward<Args>(args)...);
+	  impl->_setOrdinal((uint32_t)_members->size());
+	  return impl;
+	} catch(...) {
+	  _members->registrationLock().unlock();
+	  throw;
+	}
+      }
 
       class Destructor {
       public:
@@ -168,6 +1347,7 @@ namespace pistis {
       };
 
       static MemberDataType* _members;
+      static std::once_flag _membersCreated;
       static Destructor _destructor;
       friend class Destructor;
     };
@@ -176,6 +1356,9 @@ namespace pistis {
     typename Enum<DerivedT, ImplT>::MemberDataType*
       Enum<DerivedT, ImplT>::_members= nullptr;
 
+    template <typename DerivedT, typename ImplT>
+    std::once_flag Enum<DerivedT, ImplT>::_membersCreated;
+
     template <typename DerivedT, typename ImplT>
     typename Enum<DerivedT, ImplT>::Destructor
       Enum<DerivedT, ImplT>::_destructor;
@@ -0,0 +1,784 @@
+#ifndef __PISTIS__TYPEUTIL__ENUMCATALOG_HPP__
+#define __PISTIS__TYPEUTIL__ENUMCATALOG_HPP__
+
+#include <pistis/typeutil/ConstexprEnum.hpp>
+#include <pistis/typeutil/NameOf.hpp>
+#include <pistis/typeutil/Optional.hpp>
+#include <pistis/typeutil/PerfectHash.hpp>
+#include <pistis/typeutil/StringView.hpp>
+#include <pistis/exceptions/NoSuchItem.hpp>
+#include <pistis/exceptions/PistisException.hpp>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace pistis {
+  namespace exceptions {
+    /** @brief Thrown when an enumeration catalog cannot be written,
+     *         opened or attached, or is not a valid catalog.
+     */
+    class EnumCatalogError : public PistisException {
+    public:
+      /** @brief Create a new EnumCatalogError exception
+       *
+       *  @param details  Description of the problem
+       *  @param origin   Where the exception originates from
+       */
+      EnumCatalogError(const std::string& details,
+		       const ExceptionOrigin& origin):
+	PistisException(details, origin) {
+      }
+
+      /** @brief Create a copy of this exception, returning a pointer to
+       *         a value of the most-derived type
+       */
+      virtual EnumCatalogError* duplicate() const {
+	return new EnumCatalogError(*this);
+      }
+    };
+  }
+
+  namespace typeutil {
+    namespace detail {
+
+      /** @brief First bytes of a catalog file.  The sections it points to
+       *         follow it, each starting on an 8-byte boundary.
+       *
+       *  Catalogs are written in the byte order of the machine that
+       *  writes them.  A catalog from a machine with the other byte order
+       *  fails to open because its version does not match.
+       */
+      struct EnumCatalogHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t numMembers;
+	uint32_t numSeeds;
+	uint32_t reserved;       ///< Zero
+	uint64_t salt;           ///< Salt of the name index
+	int64_t minValue;
+	int64_t maxValue;
+	uint64_t nameDataSize;
+	uint64_t valueTableSize;     ///< Zero unless the values are dense
+	uint64_t valuesOffset;       ///< int64_t[numMembers]
+	uint64_t sortedValuesOffset; ///< int64_t[numMembers]
+	uint64_t byValueOffset;      ///< uint32_t[numMembers]
+	uint64_t valueTableOffset;   ///< uint32_t[valueTableSize]
+	uint64_t nameOffsetsOffset;  ///< uint32_t[numMembers + 1]
+	uint64_t seedsOffset;        ///< uint32_t[numSeeds]
+	uint64_t slotsOffset;        ///< uint32_t[numMembers]
+	uint64_t nameDataOffset;     ///< char[nameDataSize]
+	uint64_t fileSize;
+      };
+
+      static const char ENUM_CATALOG_MAGIC[8] = {
+	'P', 'I', 'S', 'T', 'E', 'N', 'U', 'M'
+      };
+      static const uint32_t ENUM_CATALOG_VERSION = 1;
+      static const uint32_t ENUM_CATALOG_NO_MEMBER = ~(uint32_t)0;
+
+      /** @brief Widest value range that gets a table from value to
+       *         ordinal.  The same rule as
+       *         BasicEnumMemberData::denseSpanLimit().
+       */
+      inline uint64_t enumCatalogDenseSpanLimit(size_t numMembers) {
+	return (numMembers < 16) ? 64 : ((uint64_t)numMembers * 4);
+      }
+
+      inline void throwEnumCatalogError(const std::string& details,
+					const std::string& path) {
+	std::ostringstream msg;
+	msg << details;
+	if (!path.empty()) {
+	  msg << " (" << path << ")";
+	}
+	throw exceptions::EnumCatalogError(msg.str(), PISTIS_EX_HERE);
+      }
+
+      inline void throwEnumCatalogSystemError(const std::string& action,
+					      const std::string& path) {
+	const int error = errno;
+	std::ostringstream msg;
+	msg << "Cannot " << action << " enumeration catalog " << path
+	    << ": " << ::strerror(error);
+	throw exceptions::EnumCatalogError(msg.str(), PISTIS_EX_HERE);
+      }
+    }
+
+    /** @brief Builds an enumeration catalog
+     *
+     *  Add the members in ordinal order, then call write() to save the
+     *  catalog to a file that EnumCatalog::open() can map, or build() to
+     *  get its bytes.  The catalog holds the values, the names, a
+     *  PerfectHashIndex over the names and the values in sorted order,
+     *  so nothing needs to be computed when it is loaded.  If the values
+     *  are dense enough, as for BasicEnumMemberData, the catalog also
+     *  holds a table from value to ordinal.
+     */
+    class EnumCatalogWriter {
+    public:
+      EnumCatalogWriter() { }
+
+      /** @brief Number of members added so far */
+      size_t size() const { return values_.size(); }
+
+      /** @brief Add a member, returning its ordinal
+       *
+       *  @throws EnumCatalogError  if a member named @e name was already
+       *                            added
+       */
+      uint32_t add(int64_t value, const StringView& name) {
+	std::string s(name.data(), name.size());
+	if (!names_.insert(s).second) {
+	  std::ostringstream msg;
+	  msg << "Enumeration catalog already has a member named \"" << s
+	      << "\"";
+	  throw exceptions::EnumCatalogError(msg.str(), PISTIS_EX_HERE);
+	}
+	values_.push_back(value);
+	nameOffsets_.push_back((uint32_t)nameData_.size());
+	nameData_.append(s);
+	return (uint32_t)(values_.size() - 1);
+      }
+
+      /** @brief Returns the bytes of the catalog */
+      std::string build() const {
+	const uint32_t n = (uint32_t)values_.size();
+	std::vector<uint32_t> offsets(nameOffsets_);
+	offsets.push_back((uint32_t)nameData_.size());
+
+	std::vector<StringView> names;
+	std::vector<uint32_t> ordinals;
+	for (uint32_t i = 0; i < n; ++i) {
+	  names.push_back(StringView(nameData_.data() + offsets[i],
+				     offsets[i + 1] - offsets[i]));
+	  ordinals.push_back(i);
+	}
+	PerfectHashIndex index;
+	index.build(names.data(), ordinals.data(), n);
+
+	// Ties go to the lowest ordinal, since the sort is stable
+	std::vector<uint32_t> byValue(ordinals);
+	std::stable_sort(byValue.begin(), byValue.end(),
+			 [this](uint32_t x, uint32_t y) {
+			   return values_[x] < values_[y];
+			 });
+	std::vector<int64_t> sortedValues;
+	for (uint32_t i : byValue) {
+	  sortedValues.push_back(values_[i]);
+	}
+
+	std::vector<uint32_t> valueTable;
+	if (n) {
+	  const uint64_t span =
+	      (uint64_t)sortedValues.back() - (uint64_t)sortedValues.front();
+	  if (span < detail::enumCatalogDenseSpanLimit(n)) {
+	    valueTable.assign(span + 1, detail::ENUM_CATALOG_NO_MEMBER);
+	    for (uint32_t i = n; i > 0; --i) {
+	      valueTable[(uint64_t)values_[byValue[i - 1]] -
+			   (uint64_t)sortedValues.front()] = byValue[i - 1];
+	    }
+	  }
+	}
+
+	detail::EnumCatalogHeader header;
+	::memset(&header, 0, sizeof(header));
+	::memcpy(header.magic, detail::ENUM_CATALOG_MAGIC,
+		 sizeof(header.magic));
+	header.version = detail::ENUM_CATALOG_VERSION;
+	header.numMembers = n;
+	header.numSeeds = (uint32_t)index.seeds().size();
+	header.salt = index.salt();
+	header.minValue = n ? sortedValues.front() : 0;
+	header.maxValue = n ? sortedValues.back() : 0;
+	header.nameDataSize = nameData_.size();
+	header.valueTableSize = valueTable.size();
+
+	std::string out(sizeof(header), '\0');
+	header.valuesOffset = append_(out, values_.data(), n);
+	header.sortedValuesOffset = append_(out, sortedValues.data(), n);
+	header.byValueOffset = append_(out, byValue.data(), n);
+	header.valueTableOffset = append_(out, valueTable.data(),
+					  valueTable.size());
+	header.nameOffsetsOffset = append_(out, offsets.data(), n + 1);
+	header.seedsOffset = append_(out, index.seeds().data(),
+				     index.seeds().size());
+	header.slotsOffset = append_(out, index.slots().data(), n);
+	header.nameDataOffset = append_(out, nameData_.data(),
+					nameData_.size());
+	header.fileSize = out.size();
+	out.replace(0, sizeof(header), (const char*)&header, sizeof(header));
+	return out;
+      }
+
+      /** @brief Write the catalog to @e path
+       *
+       *  The catalog is written to a temporary file that is then renamed
+       *  to @e path, so processes that already mapped the old catalog
+       *  keep it, and no process sees a partly written one.
+       *
+       *  @throws EnumCatalogError  if the file cannot be written
+       */
+      void write(const std::string& path) const {
+	const std::string bytes = build();
+	const std::string tmpPath = path + ".tmp";
+	FILE* f = ::fopen(tmpPath.c_str(), "wb");
+	if (!f) {
+	  detail::throwEnumCatalogSystemError("create", tmpPath);
+	}
+	const bool written =
+	    (::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size());
+	if ((::fclose(f) != 0) || !written) {
+	  ::unlink(tmpPath.c_str());
+	  detail::throwEnumCatalogSystemError("write", tmpPath);
+	}
+	if (::rename(tmpPath.c_str(), path.c_str())) {
+	  ::unlink(tmpPath.c_str());
+	  detail::throwEnumCatalogSystemError("rename", tmpPath);
+	}
+      }
+
+    private:
+      std::vector<int64_t> values_;
+      std::vector<uint32_t> nameOffsets_;
+      std::string nameData_;
+      std::set<std::string> names_;
+
+      template <typename T>
+      static uint64_t append_(std::string& out, const T* data, size_t n) {
+	out.resize((out.size() + 7) & ~(size_t)7, '\0');
+	const uint64_t offset = out.size();
+	out.append((const char*)data, n * sizeof(T));
+	return offset;
+      }
+    };
+
+    /** @brief The members of an enumeration, as read from a catalog
+     *         built by EnumCatalogWriter.
+     *
+     *  An EnumCatalog reads the catalog where it lies, either in a file
+     *  mapped by open() or in memory the caller owns, so loading one
+     *  costs a few system calls no matter how many members it has.  The
+     *  header is checked when the catalog is loaded.  The rest of the
+     *  catalog is trusted unless verify() is called, which reads all of
+     *  it.
+     *
+     *  Use it through CatalogEnum, which gives the members the interface
+     *  of Enum.
+     */
+    class EnumCatalog {
+    public:
+      enum : uint32_t { NOT_FOUND = detail::ENUM_CATALOG_NO_MEMBER };
+
+    public:
+      /** @brief Read the catalog in the @e size bytes at @e data, which
+       *         must outlive it and be 8-byte aligned
+       *
+       *  @throws EnumCatalogError  if the header is invalid
+       */
+      EnumCatalog(const void* data, size_t size):
+	  data_((const char*)data), size_(size), mapped_(false) {
+	init_("");
+      }
+
+      EnumCatalog(EnumCatalog&& other):
+	  data_(other.data_), size_(other.size_), mapped_(other.mapped_),
+	  header_(other.header_), values_(other.values_),
+	  sortedValues_(other.sortedValues_), byValue_(other.byValue_),
+	  valueTable_(other.valueTable_), nameOffsets_(other.nameOffsets_),
+	  nameData_(other.nameData_), nameIndex_(other.nameIndex_) {
+	other.mapped_ = false;
+      }
+
+      EnumCatalog(const EnumCatalog&) = delete;
+      EnumCatalog& operator=(const EnumCatalog&) = delete;
+
+      ~EnumCatalog() {
+	if (mapped_) {
+	  ::munmap(const_cast<char*>(data_), size_);
+	}
+      }
+
+      /** @brief Map the catalog in the file at @e path
+       *
+       *  @throws EnumCatalogError  if the file cannot be mapped or is not
+       *                            a valid catalog
+       */
+      static EnumCatalog open(const std::string& path) {
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+	  detail::throwEnumCatalogSystemError("open", path);
+	}
+
+	struct stat info;
+	if (::fstat(fd, &info)) {
+	  ::close(fd);
+	  detail::throwEnumCatalogSystemError("stat", path);
+	}
+	const size_t size = (size_t)info.st_size;
+	if (size < sizeof(detail::EnumCatalogHeader)) {
+	  ::close(fd);
+	  detail::throwEnumCatalogError("Enumeration catalog is truncated",
+					path);
+	}
+
+	void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED) {
+	  detail::throwEnumCatalogSystemError("map", path);
+	}
+
+	// Unmaps the file if the header is invalid
+	EnumCatalog catalog(data, size, path);
+	return catalog;
+      }
+
+      /** @brief Number of members */
+      size_t size() const { return header_->numMembers; }
+
+      int64_t value(uint32_t ordinal) const { return values_[ordinal]; }
+
+      StringView name(uint32_t ordinal) const {
+	return StringView(nameData_ + nameOffsets_[ordinal],
+			  nameOffsets_[ordinal + 1] - nameOffsets_[ordinal]);
+      }
+
+      /** @brief Smallest and largest value of any member */
+      int64_t minValue() const { return header_->minValue; }
+      int64_t maxValue() const { return header_->maxValue; }
+
+      /** @brief Returns the ordinal of the member named @e s, or
+       *         NOT_FOUND if there is no such member.
+       */
+      uint32_t findName(const StringView& s) const {
+	const uint32_t ordinal = nameIndex_.find(s);
+	return ((ordinal < header_->numMembers) && (name(ordinal) == s))
+		 ? ordinal : NOT_FOUND;
+      }
+
+      uint32_t findName(const char* s, size_t n) const {
+	return findName(StringView(s, n));
+      }
+
+      /** @brief Returns the ordinal of the member with value @e v, or
+       *         NOT_FOUND if there is no such member.
+       *
+       *  When several members have the same value, returns the one with
+       *  the lowest ordinal.
+       */
+      uint32_t findValue(int64_t v) const {
+	const uint32_t n = header_->numMembers;
+	if (!n || (v < header_->minValue) || (v > header_->maxValue)) {
+	  return NOT_FOUND;
+	}
+	if (header_->valueTableSize) {
+	  return valueTable_[(uint64_t)v - (uint64_t)header_->minValue];
+	}
+	return findSortedValue_(v);
+      }
+
+      /** @brief Check the whole catalog, not just its header
+       *
+       *  Use before trusting a catalog from an untrusted source.
+       *
+       *  @throws EnumCatalogError  if the catalog is inconsistent
+       */
+      void verify() const {
+	const uint32_t n = header_->numMembers;
+	if (nameOffsets_[0] ||
+	    (nameOffsets_[n] != header_->nameDataSize)) {
+	  detail::throwEnumCatalogError("Enumeration catalog names do not "
+					"fill the name data", "");
+	}
+	for (uint32_t i = 0; i < n; ++i) {
+	  if (nameOffsets_[i] > nameOffsets_[i + 1]) {
+	    detail::throwEnumCatalogError("Enumeration catalog name offsets "
+					  "are not in order", "");
+	  }
+	}
+
+	std::vector<bool> seen(n, false);
+	for (uint32_t i = 0; i < n; ++i) {
+	  const uint32_t ordinal = byValue_[i];
+	  if ((ordinal >= n) || seen[ordinal] ||
+	      (sortedValues_[i] != values_[ordinal]) ||
+	      (i && (sortedValues_[i] < sortedValues_[i - 1]))) {
+	    detail::throwEnumCatalogError("Enumeration catalog value index "
+					  "is invalid", "");
+	  }
+	  seen[ordinal] = true;
+	}
+	if (n && ((sortedValues_[0] != header_->minValue) ||
+		  (sortedValues_[n - 1] != header_->maxValue))) {
+	  detail::throwEnumCatalogError("Enumeration catalog value range "
+					"is invalid", "");
+	}
+	if (header_->valueTableSize) {
+	  // Every slot, not just those of the members' values, since
+	  // fromValue() trusts whatever ordinal it finds in the table
+	  for (uint64_t slot = 0; slot < header_->valueTableSize; ++slot) {
+	    const uint32_t ordinal = valueTable_[slot];
+	    if ((ordinal != NOT_FOUND) &&
+		((ordinal >= n) ||
+		 ((uint64_t)values_[ordinal] - (uint64_t)header_->minValue !=
+		    slot))) {
+	      detail::throwEnumCatalogError("Enumeration catalog value "
+					    "table is invalid", "");
+	    }
+	  }
+	  for (uint32_t i = 0; i < n; ++i) {
+	    if (findValue(values_[i]) != findSortedValue_(values_[i])) {
+	      detail::throwEnumCatalogError("Enumeration catalog value "
+					    "table is invalid", "");
+	    }
+	  }
+	}
+
+	for (uint32_t i = 0; i < n; ++i) {
+	  if (findName(name(i)) != i) {
+	    detail::throwEnumCatalogError("Enumeration catalog name index "
+					  "is invalid", "");
+	  }
+	}
+      }
+
+    private:
+      const char* data_;
+      size_t size_;
+      bool mapped_;
+      const detail::EnumCatalogHeader* header_;
+      const int64_t* values_;
+      const int64_t* sortedValues_;
+      const uint32_t* byValue_;
+      const uint32_t* valueTable_;
+      const uint32_t* nameOffsets_;
+      const char* nameData_;
+      PerfectHashView nameIndex_;
+
+      EnumCatalog(void* mapping, size_t size, const std::string& path):
+	  data_((const char*)mapping), size_(size), mapped_(true) {
+	init_(path);
+      }
+
+      template <typename T>
+      const T* section_(uint64_t offset, uint64_t count,
+			const std::string& path) const {
+	if ((offset % 8) || (offset > size_) ||
+	    (count > (size_ - offset) / sizeof(T))) {
+	  detail::throwEnumCatalogError(
+	      "Enumeration catalog has a section outside the file", path
+	  );
+	}
+	return reinterpret_cast<const T*>(data_ + offset);
+      }
+
+      /** @pre  <c>minValue() <= v <= maxValue()</c> */
+      uint32_t findSortedValue_(int64_t v) const {
+	const int64_t* i = std::lower_bound(
+	    sortedValues_, sortedValues_ + header_->numMembers, v
+	);
+	return (*i == v) ? byValue_[i - sortedValues_] : NOT_FOUND;
+      }
+
+      void init_(const std::string& path) {
+	try {
+	  if ((size_ < sizeof(detail::EnumCatalogHeader)) ||
+	      ((uintptr_t)data_ % 8)) {
+	    detail::throwEnumCatalogError(
+		"Enumeration catalog is truncated or misaligned", path
+	    );
+	  }
+	  header_ = reinterpret_cast<const detail::EnumCatalogHeader*>(data_);
+	  if (::memcmp(header_->magic, detail::ENUM_CATALOG_MAGIC,
+		       sizeof(header_->magic))) {
+	    detail::throwEnumCatalogError("Not an enumeration catalog", path);
+	  }
+	  if (header_->version != detail::ENUM_CATALOG_VERSION) {
+	    std::ostringstream msg;
+	    msg << "Enumeration catalog has version " << header_->version
+		<< ", not " << detail::ENUM_CATALOG_VERSION;
+	    detail::throwEnumCatalogError(msg.str(), path);
+	  }
+	  if ((header_->fileSize != size_) ||
+	      (header_->numMembers && !header_->numSeeds) ||
+	      (header_->valueTableSize &&
+		 (header_->valueTableSize - 1 !=
+		    (uint64_t)header_->maxValue - (uint64_t)header_->minValue))) {
+	    detail::throwEnumCatalogError(
+		"Enumeration catalog header is inconsistent", path
+	    );
+	  }
+
+	  const uint64_t n = header_->numMembers;
+	  values_ = section_<int64_t>(header_->valuesOffset, n, path);
+	  sortedValues_ = section_<int64_t>(header_->sortedValuesOffset, n,
+					    path);
+	  byValue_ = section_<uint32_t>(header_->byValueOffset, n, path);
+	  valueTable_ = section_<uint32_t>(header_->valueTableOffset,
+					   header_->valueTableSize, path);
+	  nameOffsets_ = section_<uint32_t>(header_->nameOffsetsOffset, n + 1,
+					    path);
+	  nameData_ = section_<char>(header_->nameDataOffset,
+				     header_->nameDataSize, path);
+	  nameIndex_ = PerfectHashView(
+	      header_->salt,
+	      section_<uint32_t>(header_->seedsOffset, header_->numSeeds, path),
+	      header_->numSeeds,
+	      section_<uint32_t>(header_->slotsOffset, n, path), n
+	  );
+	} catch(...) {
+	  if (mapped_) {
+	    ::munmap(const_cast<char*>(data_), size_);
+	    mapped_ = false;
+	  }
+	  throw;
+	}
+      }
+    };
+
+    /** @brief The members of a CatalogEnum, in ordinal order */
+    template <typename DerivedT>
+    class CatalogEnumValues {
+    public:
+      typedef typename ConstexprEnumValues<DerivedT>::const_iterator
+	      const_iterator;
+      typedef const_iterator iterator;
+
+    public:
+      size_t size() const { return DerivedT::catalog().size(); }
+      bool empty() const { return !size(); }
+      const_iterator begin() const { return const_iterator(0); }
+      const_iterator end() const { return const_iterator(size()); }
+      DerivedT operator[](size_t ordinal) const {
+	return DerivedT::fromOrdinal(ordinal);
+      }
+    };
+
+    /** @brief An enumeration whose members are read at run time from an
+     *         EnumCatalog
+     *
+     *  CatalogEnum offers the interface of Enum and ConstexprEnum for
+     *  tables that are too large, or change too often, to compile in.
+     *  Like a ConstexprEnum member, a member is just an ordinal, and its
+     *  value and name are read from the catalog, which is attached once
+     *  per program with load() or attach() and stays attached until it
+     *  exits.  The derived class gives CatalogEnum access to a
+     *  constructor that takes the ordinal:
+     *  <code>
+     *    class ErrorCode : public CatalogEnum<ErrorCode, int> {
+     *    private:
+     *      friend class CatalogEnum<ErrorCode, int>;
+     *      ErrorCode(uint32_t ordinal): CatalogEnum(ordinal) { }
+     *    };
+     *
+     *    ErrorCode::load("/etc/myapp/error-codes.cat");
+     *    ErrorCode e = ErrorCode::fromName("DISK_FULL");
+     *  </code>
+     *
+     *  Calling anything that reads members before the catalog is
+     *  attached throws EnumCatalogError.
+     */
+    template <typename DerivedT, typename ValueT = int64_t>
+    class CatalogEnum {
+    public:
+      typedef ValueT ValueType;
+
+      static_assert(std::is_integral<ValueT>::value &&
+		      (sizeof(ValueT) <= sizeof(int64_t)),
+		    "A CatalogEnum needs an integral value type of at most "
+		    "64 bits");
+
+    public:
+      ValueT value() const { return (ValueT)catalog().value(ordinal_); }
+      StringView name() const { return catalog().name(ordinal_); }
+
+      /** @brief Write the name into the @e size characters at @e buffer,
+       *         with the same semantics as Enum::formatTo()
+       */
+      size_t formatTo(char* buffer, size_t size) const {
+	return name().copyTo(buffer, size);
+      }
+
+      /** @brief Append the name to @e out */
+      void appendTo(std::string& out) const {
+	const StringView n = name();
+	out.append(n.data(), n.size());
+      }
+
+      /** @brief Position of this member in the catalog */
+      size_t ordinal() const { return ordinal_; }
+
+      /** @brief Hash code that identifies this member.  See EnumHash. */
+      size_t hash() const { return ordinal_; }
+
+      bool operator==(const DerivedT& other) const {
+	return ordinal_ == other.ordinal_;
+      }
+      bool operator!=(const DerivedT& other) const {
+	return ordinal_ != other.ordinal_;
+      }
+      bool operator<(const DerivedT& other) const {
+	return value() < other.value();
+      }
+      bool operator>(const DerivedT& other) const {
+	return value() > other.value();
+      }
+      bool operator<=(const DerivedT& other) const {
+	return value() <= other.value();
+      }
+      bool operator>=(const DerivedT& other) const {
+	return value() >= other.value();
+      }
+
+      static DerivedT fromValue(ValueT value) {
+	const uint32_t ordinal = catalog().findValue((int64_t)value);
+	if (ordinal == EnumCatalog::NOT_FOUND) {
+	  std::ostringstream msg;
+	  msg << "Member of " << typeName<DerivedT>() << " with value "
+	      << value;
+	  throw exceptions::NoSuchItem(msg.str(), PISTIS_EX_HERE);
+	}
+	return DerivedT(ordinal);
+      }
+
+      static DerivedT fromName(const StringView& name) {
+	const uint32_t ordinal = catalog().findName(name);
+	if (ordinal == EnumCatalog::NOT_FOUND) {
+	  std::ostringstream msg;
+	  msg << "Member of " << typeName<DerivedT>() << " with name \""
+	      << name << "\"";
+	  throw exceptions::NoSuchItem(msg.str(), PISTIS_EX_HERE);
+	}
+	return DerivedT(ordinal);
+      }
+
+      static DerivedT fromName(const char* name, size_t n) {
+	return fromName(StringView(name, n));
+      }
+
+      static Optional<DerivedT> tryFromValue(ValueT value) {
+	return optional_(catalog().findValue((int64_t)value));
+      }
+
+      static Optional<DerivedT> tryFromName(const StringView& name) {
+	return optional_(catalog().findName(name));
+      }
+
+      static Optional<DerivedT> tryFromName(const char* name, size_t n) {
+	return optional_(catalog().findName(name, n));
+      }
+
+      /** @brief Returns the member whose ordinal is @e ordinal
+       *
+       *  @throws NoSuchItem  if there is no such member
+       */
+      static DerivedT fromOrdinal(size_t ordinal) {
+	if (ordinal >= catalog().size()) {
+	  std::ostringstream msg;
+	  msg << "Member of " << typeName<DerivedT>() << " with ordinal "
+	      << ordinal;
+	  throw exceptions::NoSuchItem(msg.str(), PISTIS_EX_HERE);
+	}
+	return DerivedT((uint32_t)ordinal);
+      }
+
+      /** @brief The members, in ordinal order */
+      static CatalogEnumValues<DerivedT> values() {
+	return CatalogEnumValues<DerivedT>();
+      }
+
+      /** @brief Map the catalog at @e path and attach it */
+      static void load(const std::string& path) {
+	attach(EnumCatalog::open(path));
+      }
+
+      /** @brief Make @e catalog the source of this enumeration's members
+       *
+       *  @throws EnumCatalogError  if a catalog is already attached, or
+       *                            some member's value does not fit in
+       *                            @e ValueT
+       */
+      static void attach(EnumCatalog&& catalog) {
+	if (catalog.size() &&
+	    ((catalog.minValue() <
+		(int64_t)std::numeric_limits<ValueT>::min()) ||
+	     ((catalog.maxValue() > 0) &&
+		((uint64_t)catalog.maxValue() >
+		   (uint64_t)std::numeric_limits<ValueT>::max())))) {
+	  detail::throwEnumCatalogError(
+	      "Enumeration catalog has values out of range for " +
+		  typeName<DerivedT>().str(),
+	      ""
+	  );
+	}
+
+	// Never freed, since members may be used until the program exits
+	const EnumCatalog* attached = new EnumCatalog(std::move(catalog));
+	const EnumCatalog* expected = nullptr;
+	if (!catalog_.compare_exchange_strong(expected, attached)) {
+	  delete attached;
+	  detail::throwEnumCatalogError(
+	      "A catalog is already attached to " + typeName<DerivedT>().str(), ""
+	  );
+	}
+      }
+
+      /** @brief True if a catalog has been attached */
+      static bool attached() { return catalog_.load() != nullptr; }
+
+      /** @brief The attached catalog
+       *
+       *  @throws EnumCatalogError  if no catalog is attached
+       */
+      static const EnumCatalog& catalog() {
+	const EnumCatalog* c = catalog_.load(std::memory_order_acquire);
+	if (__builtin_expect(!c, 0)) {
+	  detail::throwEnumCatalogError(
+	      "No catalog is attached to " + typeName<DerivedT>().str(), ""
+	  );
+	}
+	return *c;
+      }
+
+    protected:
+      CatalogEnum(uint32_t ordinal): ordinal_(ordinal) { }
+
+    private:
+      uint32_t ordinal_;
+
+      static std::atomic<const EnumCatalog*> catalog_;
+
+      static Optional<DerivedT> optional_(uint32_t ordinal) {
+	return (ordinal == EnumCatalog::NOT_FOUND)
+		 ? Optional<DerivedT>() : Optional<DerivedT>(DerivedT(ordinal));
+      }
+    };
+
+    template <typename DerivedT, typename ValueT>
+    std::atomic<const EnumCatalog*> CatalogEnum<DerivedT, ValueT>::catalog_(
+	nullptr
+    );
+
+    template <typename DerivedT, typename ValueT>
+    inline std::ostream& operator<<(std::ostream& out,
+				    const CatalogEnum<DerivedT, ValueT>& e) {
+      return out << e.name();
+    }
+
+  }
+}
+#endif
@@ -0,0 +1,397 @@
+#ifndef __PISTIS__TYPEUTIL__ENUMCODEC_HPP__
+#define __PISTIS__TYPEUTIL__ENUMCODEC_HPP__
+
+#include <pistis/typeutil/EnumSet.hpp>
+#include <pistis/typeutil/NameOf.hpp>
+#include <pistis/typeutil/PerfectHash.hpp>
+#include <pistis/typeutil/StringView.hpp>
+#include <pistis/exceptions/PistisException.hpp>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace pistis {
+  namespace exceptions {
+    /** @brief Thrown when EnumCodec cannot decode its input, because it
+     *         is truncated, malformed or was written for a different
+     *         version of the enumeration.
+     */
+    class EnumCodecError : public PistisException {
+    public:
+      /** @brief Create a new EnumCodecError exception
+       *
+       *  @param details  Description of the problem
+       *  @param origin   Where the exception originates from
+       */
+      EnumCodecError(const std::string& details,
+		     const ExceptionOrigin& origin):
+	PistisException(details, origin) {
+      }
+
+      /** @brief Create a copy of this exception, returning a pointer to
+       *         a value of the most-derived type
+       */
+      virtual EnumCodecError* duplicate() const {
+	return new EnumCodecError(*this);
+      }
+    };
+  }
+
+  namespace typeutil {
+    namespace detail {
+
+      /** @brief Write @e v as a LEB128 varint, returning the position
+       *         after it.  Writes at most 10 bytes.
+       */
+      inline uint8_t* writeVarint(uint64_t v, uint8_t* p) {
+	while (v >= 0x80) {
+	  *p++ = (uint8_t)v | 0x80;
+	  v >>= 7;
+	}
+	*p++ = (uint8_t)v;
+	return p;
+      }
+
+      /** @brief Read a LEB128 varint from @e p, which is advanced past it
+       *
+       *  @throws EnumCodecError  if the varint is truncated or too long
+       */
+      inline uint64_t readVarint(const uint8_t*& p, const uint8_t* end) {
+	if ((p < end) && !(*p & 0x80)) {
+	  return *p++;
+	}
+	uint64_t v = 0;
+	for (unsigned shift = 0; shift < 64; shift += 7) {
+	  if (p == end) {
+	    throw exceptions::EnumCodecError("Truncated varint",
+					     PISTIS_EX_HERE);
+	  }
+	  const uint8_t b = *p++;
+	  if ((shift == 63) && (b & 0x7e)) {
+	    // The tenth byte holds bit 63 only
+	    throw exceptions::EnumCodecError("Varint is longer than 64 bits",
+					     PISTIS_EX_HERE);
+	  }
+	  v |= (uint64_t)(b & 0x7f) << shift;
+	  if (!(b & 0x80)) {
+	    return v;
+	  }
+	}
+	throw exceptions::EnumCodecError("Varint is longer than 64 bits",
+					 PISTIS_EX_HERE);
+      }
+
+      inline uint8_t* writeFixed64(uint64_t v, uint8_t* p) {
+	for (int i = 0; i < 8; ++i) {
+	  p[i] = (uint8_t)(v >> (8 * i));
+	}
+	return p + 8;
+      }
+
+      inline uint64_t readFixed64(const uint8_t* p) {
+	uint64_t v = 0;
+	for (int i = 0; i < 8; ++i) {
+	  v |= (uint64_t)p[i] << (8 * i);
+	}
+	return v;
+      }
+
+      // Signed values are zigzag-encoded, so small negative values
+      // take as few bytes as small positive ones
+      template <typename T>
+      uint64_t toVarintValue(T v, std::true_type /* signed */) {
+	const int64_t s = (int64_t)v;
+	return ((uint64_t)s << 1) ^ (uint64_t)(s >> 63);
+      }
+
+      template <typename T>
+      uint64_t toVarintValue(T v, std::false_type) {
+	return (uint64_t)v;
+      }
+
+      template <typename T>
+      T fromVarintValue(uint64_t v, std::true_type /* signed */) {
+	return (T)(int64_t)((v >> 1) ^ (~(v & 1) + 1));
+      }
+
+      template <typename T>
+      T fromVarintValue(uint64_t v, std::false_type) {
+	return (T)v;
+      }
+
+    }
+
+    /** @brief Binary encoding of the members of an enumeration
+     *
+     *  Members are written either as their ordinal or as their value,
+     *  each as a LEB128 varint, and EnumSets are written as their
+     *  bitmask words.  Ordinals are the most compact encoding, but are
+     *  only meaningful to a reader whose enumeration registers the same
+     *  members in the same order.  A producer can write fingerprint(),
+     *  which covers the names, values and order of the members, so the
+     *  consumer can check that with checkFingerprint() before it decodes
+     *  anything.
+     *
+     *  Encoders append to a std::vector<uint8_t>.  Decoders read from a
+     *  pointer that they advance past the data they consume, and throw
+     *  EnumCodecError rather than read past @e end.  @e E may be any
+     *  Enum or ConstexprEnum.  The value encodings require integer
+     *  values.
+     */
+    template <typename E>
+    class EnumCodec {
+    public:
+      typedef typename E::ValueType ValueType;
+
+      /** @brief Maximum size of one encoded ordinal or value */
+      enum : size_t { MAX_VARINT_SIZE = 10 };
+
+    public:
+      /** @brief 64-bit FNV-1a hash of the number of members and the
+       *         name and value of each member, in ordinal order.
+       *
+       *  Registering members at run time changes the fingerprint.
+       */
+      static uint64_t fingerprint() {
+	const auto& members = E::values();
+	uint64_t h = hashInteger_(members.size(), FNV_BASIS);
+	for (size_t i = 0; i < members.size(); ++i) {
+	  const E e = members[i];
+	  const StringView name(e.name());
+	  h = hashInteger_(name.size(), h);
+	  h = detail::fnv1a64(name.data(), name.size(), h);
+	  h = hashValue_(e.value(), h, std::is_integral<ValueType>());
+	}
+	return h;
+      }
+
+      /** @brief Append fingerprint() as eight little-endian bytes */
+      static void writeFingerprint(std::vector<uint8_t>& out) {
+	const size_t start = out.size();
+	out.resize(start + 8);
+	detail::writeFixed64(fingerprint(), out.data() + start);
+      }
+
+      /** @brief Read a fingerprint written by writeFingerprint() and
+       *         check that it matches fingerprint()
+       *
+       *  @throws EnumCodecError  if the fingerprints differ
+       */
+      static void checkFingerprint(const uint8_t*& p, const uint8_t* end) {
+	need_(p, end, 8);
+	const uint64_t theirs = detail::readFixed64(p);
+	const uint64_t ours = fingerprint();
+	if (theirs != ours) {
+	  std::ostringstream msg;
+	  msg << "Data was written for a different version of "
+	      << typeName<E>() << " (fingerprint " << std::hex << theirs
+	      << ", expected " << ours << ")";
+	  throw exceptions::EnumCodecError(msg.str(), PISTIS_EX_HERE);
+	}
+	p += 8;
+      }
+
+      static void encodeOrdinal(const E& e, std::vector<uint8_t>& out) {
+	encodeOrdinals(&e, 1, out);
+      }
+
+      /** @brief Decode one member written by encodeOrdinal()
+       *
+       *  @throws EnumCodecError  if the input is truncated or has no
+       *                          such member
+       */
+      static E decodeOrdinal(const uint8_t*& p, const uint8_t* end) {
+	const auto& all = E::values();
+	return all[readOrdinal_(p, end, all.size())];
+      }
+
+      static void encodeValue(const E& e, std::vector<uint8_t>& out) {
+	encodeValues(&e, 1, out);
+      }
+
+      /** @brief Decode one member written by encodeValue()
+       *
+       *  @throws EnumCodecError  if the input is truncated or has no
+       *                          such member
+       */
+      static E decodeValue(const uint8_t*& p, const uint8_t* end) {
+	return readValue_(p, end);
+      }
+
+      /** @brief Append the ordinals of the @e n members at @e members */
+      static void encodeOrdinals(const E* members, size_t n,
+				 std::vector<uint8_t>& out) {
+	const size_t start = out.size();
+	out.resize(start + n * MAX_VARINT_SIZE);
+	uint8_t* p = out.data() + start;
+	for (size_t i = 0; i < n; ++i) {
+	  p = detail::writeVarint(members[i].ordinal(), p);
+	}
+	out.resize(p - out.data());
+      }
+
+      /** @brief Decode @e n members written by encodeOrdinals() and
+       *         assign them to @e members[0] through @e members[n - 1]
+       */
+      static void decodeOrdinals(const uint8_t*& p, const uint8_t* end,
+				 E* members, size_t n) {
+	const auto& all = E::values();
+	const size_t numMembers = all.size();
+	for (size_t i = 0; i < n; ++i) {
+	  members[i] = all[readOrdinal_(p, end, numMembers)];
+	}
+      }
+
+      /** @brief Append the values of the @e n members at @e members */
+      static void encodeValues(const E* members, size_t n,
+			       std::vector<uint8_t>& out) {
+	static_assert(std::is_integral<ValueType>::value,
+		      "Only members with integer values can be encoded "
+		      "by value");
+	const size_t start = out.size();
+	out.resize(start + n * MAX_VARINT_SIZE);
+	uint8_t* p = out.data() + start;
+	for (size_t i = 0; i < n; ++i) {
+	  p = detail::writeVarint(
+	      detail::toVarintValue(members[i].value(), IsSigned()), p
+	  );
+	}
+	out.resize(p - out.data());
+      }
+
+      /** @brief Decode @e n members written by encodeValues() and
+       *         assign them to @e members[0] through @e members[n - 1]
+       */
+      static void decodeValues(const uint8_t*& p, const uint8_t* end,
+			       E* members, size_t n) {
+	for (size_t i = 0; i < n; ++i) {
+	  members[i] = readValue_(p, end);
+	}
+      }
+
+      /** @brief Append @e s as a varint word count followed by its
+       *         words, each as eight little-endian bytes.  Trailing
+       *         zero words are dropped.
+       */
+      static void encodeSet(const EnumSet<E>& s, std::vector<uint8_t>& out) {
+	const std::vector<uint64_t>& words = s.words();
+	size_t numWords = words.size();
+	while (numWords && !words[numWords - 1]) {
+	  --numWords;
+	}
+
+	const size_t start = out.size();
+	out.resize(start + MAX_VARINT_SIZE + numWords * 8);
+	uint8_t* p = detail::writeVarint(numWords, out.data() + start);
+	for (size_t i = 0; i < numWords; ++i) {
+	  p = detail::writeFixed64(words[i], p);
+	}
+	out.resize(p - out.data());
+      }
+
+      /** @brief Decode a set written by encodeSet()
+       *
+       *  @throws EnumCodecError  if the input is truncated or the set
+       *                          contains ordinals that have no member
+       */
+      static EnumSet<E> decodeSet(const uint8_t*& p, const uint8_t* end) {
+	const size_t numMembers = E::values().size();
+	const uint64_t numWords = detail::readVarint(p, end);
+	if (numWords > (numMembers + 63) / 64) {
+	  throw exceptions::EnumCodecError(setTooLarge_(), PISTIS_EX_HERE);
+	}
+	need_(p, end, numWords * 8);
+
+	std::vector<uint64_t> words(numWords);
+	for (size_t i = 0; i < numWords; ++i) {
+	  words[i] = detail::readFixed64(p + 8 * i);
+	}
+	if (numWords && (numWords * 64 > numMembers) &&
+	    (words.back() >> (numMembers % 64))) {
+	  throw exceptions::EnumCodecError(setTooLarge_(), PISTIS_EX_HERE);
+	}
+	p += numWords * 8;
+	return EnumSet<E>::fromWords(words.data(), words.size());
+      }
+
+    private:
+      typedef std::integral_constant<
+	  bool, std::is_signed<ValueType>::value
+      > IsSigned;
+
+      static constexpr uint64_t FNV_BASIS = 0xcbf29ce484222325ULL;
+
+      static uint64_t hashInteger_(uint64_t v, uint64_t h) {
+	uint8_t bytes[8];
+	detail::writeFixed64(v, bytes);
+	return detail::fnv1a64((const char*)bytes, 8, h);
+      }
+
+      template <typename V>
+      static uint64_t hashValue_(const V& v, uint64_t h, std::true_type) {
+	return hashInteger_((uint64_t)v, h);
+      }
+
+      template <typename V>
+      static uint64_t hashValue_(const V& v, uint64_t h, std::false_type) {
+	// Values that are not integers cannot be encoded by value, so
+	// the names and order of the members are all that matter.
+	return h;
+      }
+
+      static void need_(const uint8_t* p, const uint8_t* end, uint64_t n) {
+	if ((uint64_t)(end - p) < n) {
+	  std::ostringstream msg;
+	  msg << "Truncated " << typeName<E>() << " data";
+	  throw exceptions::EnumCodecError(msg.str(), PISTIS_EX_HERE);
+	}
+      }
+
+      static uint64_t readOrdinal_(const uint8_t*& p, const uint8_t* end,
+				   size_t numMembers) {
+	const uint64_t ordinal = detail::readVarint(p, end);
+	if (ordinal >= numMembers) {
+	  std::ostringstream msg;
+	  msg << "No member of " << typeName<E>() << " has ordinal "
+	      << ordinal;
+	  throw exceptions::EnumCodecError(msg.str(), PISTIS_EX_HERE);
+	}
+	return ordinal;
+      }
+
+      static E readValue_(const uint8_t*& p, const uint8_t* end) {
+	const uint64_t encoded = detail::readVarint(p, end);
+	const ValueType v =
+	    detail::fromVarintValue<ValueType>(encoded, IsSigned());
+	if (detail::toVarintValue(v, IsSigned()) != encoded) {
+	  std::ostringstream msg;
+	  msg << "Encoded value " << encoded << " is out of range for "
+	      << typeName<E>();
+	  throw exceptions::EnumCodecError(msg.str(), PISTIS_EX_HERE);
+	}
+	const auto member = E::tryFromValue(v);
+	if (!member) {
+	  std::ostringstream msg;
+	  msg << "No member of " << typeName<E>() << " has value " << v;
+	  throw exceptions::EnumCodecError(msg.str(), PISTIS_EX_HERE);
+	}
+	return member.value();
+      }
+
+      static std::string setTooLarge_() {
+	std::ostringstream msg;
+	msg << "Set contains ordinals that are not members of "
+	    << typeName<E>();
+	return msg.str();
+      }
+    };
+
+    template <typename E>
+    constexpr uint64_t EnumCodec<E>::FNV_BASIS;
+
+  }
+}
+#endif
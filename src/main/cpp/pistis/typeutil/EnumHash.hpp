@@ -0,0 +1,42 @@
+#ifndef __PISTIS__TYPEUTIL__ENUMHASH_HPP__
+#define __PISTIS__TYPEUTIL__ENUMHASH_HPP__
+
+#include <functional>
+#include <stddef.h>
+
+namespace pistis {
+  namespace typeutil {
+
+    /** @brief Hash function for the members of an enumeration
+     *
+     *  Returns <c>e.hash()</c>, which identifies the member without
+     *  hashing its value or name.  @e E may be any Enum or ConstexprEnum.
+     *  Pass it as the hasher of a std::unordered_map or
+     *  std::unordered_set, or use PISTIS_ENUM_HASH() to make it the
+     *  std::hash for @e E.
+     */
+    template <typename E>
+    struct EnumHash {
+      size_t operator()(const E& e) const { return e.hash(); }
+    };
+
+  }
+}
+
+/** @brief Specialize std::hash for the enumeration @e E as EnumHash<E>
+ *
+ *  Use at global scope, after the definition of @e E, naming @e E as it
+ *  is seen from there:
+ *  <code>
+ *    PISTIS_ENUM_HASH(myapp::Color)
+ *
+ *    std::unordered_map<myapp::Color, int> counts;
+ *  </code>
+ */
+#define PISTIS_ENUM_HASH(E) \
+  namespace std { \
+    template <> \
+    struct hash<E> : public ::pistis::typeutil::EnumHash<E> { }; \
+  }
+
+#endif
@@ -0,0 +1,237 @@
+#ifndef __PISTIS__TYPEUTIL__ENUMKEYEDHASHMAP_HPP__
+#define __PISTIS__TYPEUTIL__ENUMKEYEDHASHMAP_HPP__
+
+#include <pistis/typeutil/EnumHash.hpp>
+#include <pistis/typeutil/NameOf.hpp>
+#include <pistis/typeutil/Optional.hpp>
+#include <pistis/exceptions/NoSuchItem.hpp>
+#include <sstream>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace pistis {
+  namespace typeutil {
+
+    /** @brief A hash map from some of the members of an enumeration to
+     *         values
+     *
+     *  Where EnumMap holds a value for every member, EnumKeyedHashMap
+     *  holds values only for the members inserted into it, so it suits
+     *  state kept for a few members of a large enumeration.  Entries live
+     *  in a single array probed linearly from a slot chosen by
+     *  multiplying the member's hash code by a constant, and erase()
+     *  shifts later entries back rather than leaving tombstones.  @e E
+     *  may be any Enum or ConstexprEnum.
+     */
+    template <typename E, typename V, typename Hash = EnumHash<E> >
+    class EnumKeyedHashMap {
+    public:
+      typedef E KeyType;
+      typedef V ValueType;
+
+    public:
+      /** @brief Create an empty map */
+      EnumKeyedHashMap(): mask_(0), shift_(64), size_(0) { }
+
+      /** @brief Number of members in the map */
+      size_t size() const { return size_; }
+
+      bool empty() const { return !size_; }
+
+      bool contains(const E& e) const { return find(e) != nullptr; }
+
+      /** @brief Returns the value for @e e, or null if @e e is not in the
+       *         map
+       */
+      V* find(const E& e) {
+	const size_t i = slotOf_(e);
+	return (i == NOT_FOUND) ? nullptr : &slots_[i].value().second;
+      }
+
+      const V* find(const E& e) const {
+	const size_t i = slotOf_(e);
+	return (i == NOT_FOUND) ? nullptr : &slots_[i].value().second;
+      }
+
+      /** @brief Returns the value for @e e
+       *
+       *  @throws NoSuchItem  if @e e is not in the map
+       */
+      V& at(const E& e) {
+	V* v = find(e);
+	if (!v) {
+	  throwMissing_(e);
+	}
+	return *v;
+      }
+
+      const V& at(const E& e) const {
+	const V* v = find(e);
+	if (!v) {
+	  throwMissing_(e);
+	}
+	return *v;
+      }
+
+      /** @brief Returns the value for @e e, first mapping @e e to a
+       *         default-constructed value if it is not in the map
+       */
+      V& operator[](const E& e) {
+	V* v = find(e);
+	return v ? *v : add_(e, V());
+      }
+
+      /** @brief Map @e e to @e v if @e e is not already in the map.
+       *         Returns true if it was added.
+       */
+      bool insert(const E& e, const V& v) {
+	if (find(e)) {
+	  return false;
+	}
+	add_(e, v);
+	return true;
+      }
+
+      /** @brief Remove @e e from the map.  Returns true if it was in the
+       *         map.
+       */
+      bool erase(const E& e) {
+	size_t hole = slotOf_(e);
+	if (hole == NOT_FOUND) {
+	  return false;
+	}
+
+	// Move back each following entry whose home slot does not lie
+	// between the hole and the entry, so no probe sequence is broken
+	for (size_t i = (hole + 1) & mask_; slots_[i].present();
+	     i = (i + 1) & mask_) {
+	  const size_t home = homeOf_(slots_[i].value().first);
+	  if (((i - home) & mask_) >= ((i - hole) & mask_)) {
+	    slots_[hole] = std::move(slots_[i]);
+	    hole = i;
+	  }
+	}
+	slots_[hole].clear();
+	--size_;
+	return true;
+      }
+
+      /** @brief Remove every member from the map, keeping its capacity */
+      void clear() {
+	for (Optional<Entry>& slot : slots_) {
+	  slot.clear();
+	}
+	size_ = 0;
+      }
+
+      /** @brief Make room for @e n members without rehashing */
+      void reserve(size_t n) {
+	size_t capacity = MIN_CAPACITY;
+	while (capacity * MAX_LOAD_NUMERATOR < n * MAX_LOAD_DENOMINATOR) {
+	  capacity *= 2;
+	}
+	if (capacity > slots_.size()) {
+	  rehash_(capacity);
+	}
+      }
+
+      /** @brief Call <c>f(member, value)</c> for each member in the map,
+       *         in no particular order
+       */
+      template <typename Function>
+      void forEach(Function f) {
+	for (Optional<Entry>& slot : slots_) {
+	  if (slot.present()) {
+	    f(slot.value().first, slot.value().second);
+	  }
+	}
+      }
+
+      template <typename Function>
+      void forEach(Function f) const {
+	for (const Optional<Entry>& slot : slots_) {
+	  if (slot.present()) {
+	    f(slot.value().first, slot.value().second);
+	  }
+	}
+      }
+
+    private:
+      typedef std::pair<const E, V> Entry;
+
+      enum : size_t {
+	NOT_FOUND = ~(size_t)0,
+	MIN_CAPACITY = 8,
+	MAX_LOAD_NUMERATOR = 3,
+	MAX_LOAD_DENOMINATOR = 4
+      };
+
+      std::vector< Optional<Entry> > slots_;
+      size_t mask_;
+      unsigned shift_;
+      size_t size_;
+
+      // Hash codes of Enum members may be addresses, whose low bits are
+      // all alike, so take the slot from the high bits of the product
+      size_t homeOf_(const E& e) const {
+	return (size_t)(((uint64_t)Hash()(e) * 0x9E3779B97F4A7C15ull)
+			  >> shift_) & mask_;
+      }
+
+      size_t slotOf_(const E& e) const {
+	if (!size_) {
+	  return NOT_FOUND;
+	}
+	for (size_t i = homeOf_(e); slots_[i].present(); i = (i + 1) & mask_) {
+	  if (slots_[i].value().first == e) {
+	    return i;
+	  }
+	}
+	return NOT_FOUND;
+      }
+
+      V& add_(const E& e, V&& v) {
+	if ((size_ + 1) * MAX_LOAD_DENOMINATOR >
+	      slots_.size() * MAX_LOAD_NUMERATOR) {
+	  rehash_(slots_.empty() ? (size_t)MIN_CAPACITY : slots_.size() * 2);
+	}
+	size_t i = homeOf_(e);
+	while (slots_[i].present()) {
+	  i = (i + 1) & mask_;
+	}
+	slots_[i] = Optional<Entry>(Entry(e, std::move(v)));
+	++size_;
+	return slots_[i].value().second;
+      }
+
+      V& add_(const E& e, const V& v) { return add_(e, V(v)); }
+
+      void rehash_(size_t capacity) {
+	std::vector< Optional<Entry> > old(capacity);
+	old.swap(slots_);
+	mask_ = capacity - 1;
+	shift_ = 64 - __builtin_ctzll(capacity);
+	for (Optional<Entry>& slot : old) {
+	  if (slot.present()) {
+	    size_t i = homeOf_(slot.value().first);
+	    while (slots_[i].present()) {
+	      i = (i + 1) & mask_;
+	    }
+	    slots_[i] = std::move(slot);
+	  }
+	}
+      }
+
+      static void throwMissing_(const E& e) {
+	std::ostringstream msg;
+	msg << "Entry for member " << e.name() << " in EnumKeyedHashMap of "
+	    << typeName<E>();
+	throw exceptions::NoSuchItem(msg.str(), PISTIS_EX_HERE);
+      }
+    };
+
+  }
+}
+#endif
@@ -0,0 +1,114 @@
+#ifndef __PISTIS__TYPEUTIL__ENUMMAP_HPP__
+#define __PISTIS__TYPEUTIL__ENUMMAP_HPP__
+
+#include <pistis/typeutil/NameOf.hpp>
+#include <pistis/exceptions/NoSuchItem.hpp>
+#include <sstream>
+#include <vector>
+#include <stddef.h>
+
+namespace pistis {
+  namespace typeutil {
+
+    /** @brief A map from every member of an enumeration to a value
+     *
+     *  EnumMap stores one value per member of @e E in a flat array
+     *  indexed by the member's ordinal, so lookups never compare keys.
+     *  @e E may be any Enum or ConstexprEnum.  The map has a slot for
+     *  each member that existed when it was created.
+     */
+    template <typename E, typename V>
+    class EnumMap {
+    public:
+      typedef E KeyType;
+      typedef V ValueType;
+      typedef typename std::vector<V>::iterator iterator;
+      typedef typename std::vector<V>::const_iterator const_iterator;
+
+    public:
+      /** @brief Map every member to a default-constructed value */
+      EnumMap(): values_(E::values().size()) { }
+
+      /** @brief Map every member to a copy of @e initial */
+      explicit EnumMap(const V& initial):
+	  values_(E::values().size(), initial) {
+      }
+
+      /** @brief Number of members in the map */
+      size_t size() const { return values_.size(); }
+
+      /** @brief Returns the value for @e e
+       *
+       *  @pre  @e e existed when the map was created
+       */
+      V& operator[](const E& e) { return values_[e.ordinal()]; }
+      const V& operator[](const E& e) const { return values_[e.ordinal()]; }
+
+      /** @brief Returns the value for @e e
+       *
+       *  @throws NoSuchItem  if @e e was registered after the map was
+       *                      created
+       */
+      V& at(const E& e) {
+	checkOrdinal_(e);
+	return values_[e.ordinal()];
+      }
+
+      const V& at(const E& e) const {
+	checkOrdinal_(e);
+	return values_[e.ordinal()];
+      }
+
+      /** @brief Returns the member whose value is at position @e i */
+      E keyAt(size_t i) const { return E::values()[i]; }
+
+      /** @brief Set the value of every member to @e v */
+      void fill(const V& v) { values_.assign(values_.size(), v); }
+
+      /** @brief Iterators over the values, in ordinal order */
+      iterator begin() { return values_.begin(); }
+      iterator end() { return values_.end(); }
+      const_iterator begin() const { return values_.begin(); }
+      const_iterator end() const { return values_.end(); }
+
+      /** @brief Call <c>f(member, value)</c> for each member */
+      template <typename Function>
+      void forEach(Function f) {
+	const auto& keys = E::values();
+	for (size_t i = 0; i < values_.size(); ++i) {
+	  f(keys[i], values_[i]);
+	}
+      }
+
+      template <typename Function>
+      void forEach(Function f) const {
+	const auto& keys = E::values();
+	for (size_t i = 0; i < values_.size(); ++i) {
+	  f(keys[i], values_[i]);
+	}
+      }
+
+      bool operator==(const EnumMap& other) const {
+	return values_ == other.values_;
+      }
+
+      bool operator!=(const EnumMap& other) const {
+	return values_ != other.values_;
+      }
+
+    private:
+      std::vector<V> values_;
+
+      void checkOrdinal_(const E& e) const {
+	if (e.ordinal() >= values_.size()) {
+	  std::ostringstream msg;
+	  msg << "Entry for member " << e.name() << " in EnumMap of "
+	      << typeName<E>();
+	  throw exceptions::NoSuchItem(msg.str(), PISTIS_EX_HERE);
+	}
+      }
+    };
+
+  }
+}
+#endif
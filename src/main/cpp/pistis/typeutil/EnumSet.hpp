@@ -0,0 +1,214 @@
+#ifndef __PISTIS__TYPEUTIL__ENUMSET_HPP__
+#define __PISTIS__TYPEUTIL__ENUMSET_HPP__
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace pistis {
+  namespace typeutil {
+
+    /** @brief A set of members of an enumeration, stored as a bitset
+     *
+     *  Bit @e i of the set is on if the member with ordinal @e i is in
+     *  the set.  size() counts bits with popcount, and iteration finds
+     *  the next member with a count of trailing zeros, so both run in
+     *  time proportional to the number of 64-bit words.  @e E may be any
+     *  Enum or ConstexprEnum.
+     */
+    template <typename E>
+    class EnumSet {
+    public:
+      class const_iterator {
+      public:
+	typedef std::forward_iterator_tag iterator_category;
+	typedef E value_type;
+	typedef E reference;
+	typedef const E* pointer;
+	typedef ptrdiff_t difference_type;
+
+      public:
+	const_iterator(): words_(nullptr), numWords_(0), index_(0), bits_(0) {
+	}
+
+	const_iterator(const uint64_t* words, size_t numWords, size_t index):
+	    words_(words), numWords_(numWords), index_(index),
+	    bits_((index < numWords) ? words[index] : 0) {
+	  skipEmptyWords_();
+	}
+
+	E operator*() const {
+	  return E::fromOrdinal(index_ * 64 + __builtin_ctzll(bits_));
+	}
+
+	const_iterator& operator++() {
+	  bits_ &= bits_ - 1;
+	  skipEmptyWords_();
+	  return *this;
+	}
+
+	const_iterator operator++(int) {
+	  const_iterator tmp(*this);
+	  ++(*this);
+	  return tmp;
+	}
+
+	bool operator==(const const_iterator& other) const {
+	  return (index_ == other.index_) && (bits_ == other.bits_);
+	}
+
+	bool operator!=(const const_iterator& other) const {
+	  return !(*this == other);
+	}
+
+      private:
+	const uint64_t* words_;
+	size_t numWords_;
+	size_t index_;
+	uint64_t bits_;
+
+	void skipEmptyWords_() {
+	  while (!bits_ && (index_ < numWords_)) {
+	    if (++index_ < numWords_) {
+	      bits_ = words_[index_];
+	    }
+	  }
+	}
+      };
+      typedef const_iterator iterator;
+
+    public:
+      /** @brief Create an empty set */
+      EnumSet(): words_(wordsFor_(E::values().size()), 0) { }
+
+      /** @brief Create a set containing @e members */
+      EnumSet(std::initializer_list<E> members): EnumSet() {
+	for (const E& e : members) {
+	  insert(e);
+	}
+      }
+
+      /** @brief Returns a set containing every member of @e E */
+      static EnumSet all() {
+	EnumSet s;
+	const size_t n = E::values().size();
+	for (size_t i = 0; i < n / 64; ++i) {
+	  s.words_[i] = ~(uint64_t)0;
+	}
+	if (n % 64) {
+	  s.words_[n / 64] = ((uint64_t)1 << (n % 64)) - 1;
+	}
+	return s;
+      }
+
+      /** @brief Returns the set whose bits are @e words, 64 members per
+       *         word, in the layout returned by words()
+       */
+      static EnumSet fromWords(const uint64_t* words, size_t numWords) {
+	EnumSet s;
+	if (numWords > s.words_.size()) {
+	  s.words_.resize(numWords, 0);
+	}
+	std::copy(words, words + numWords, s.words_.begin());
+	return s;
+      }
+
+      /** @brief Number of members in the set */
+      size_t size() const {
+	size_t n = 0;
+	for (uint64_t w : words_) {
+	  n += __builtin_popcountll(w);
+	}
+	return n;
+      }
+
+      bool empty() const {
+	for (uint64_t w : words_) {
+	  if (w) {
+	    return false;
+	  }
+	}
+	return true;
+      }
+
+      bool contains(const E& e) const {
+	const size_t ordinal = e.ordinal();
+	return ((ordinal / 64) < words_.size()) &&
+		 ((words_[ordinal / 64] >> (ordinal % 64)) & 1);
+      }
+
+      /** @brief Add @e e to the set.  Returns true if it was not already
+       *         in the set.
+       */
+      bool insert(const E& e) {
+	const size_t ordinal = e.ordinal();
+	if ((ordinal / 64) >= words_.size()) {
+	  words_.resize(ordinal / 64 + 1, 0);
+	}
+	const uint64_t mask = (uint64_t)1 << (ordinal % 64);
+	const bool added = !(words_[ordinal / 64] & mask);
+	words_[ordinal / 64] |= mask;
+	return added;
+      }
+
+      /** @brief Remove @e e from the set.  Returns true if it was in the
+       *         set.
+       */
+      bool erase(const E& e) {
+	const size_t ordinal = e.ordinal();
+	if ((ordinal / 64) >= words_.size()) {
+	  return false;
+	}
+	const uint64_t mask = (uint64_t)1 << (ordinal % 64);
+	const bool removed = (words_[ordinal / 64] & mask) != 0;
+	words_[ordinal / 64] &= ~mask;
+	return removed;
+      }
+
+      /** @brief Remove every member from the set */
+      void clear() { words_.assign(words_.size(), 0); }
+
+      /** @brief Iterate over the members in ordinal order */
+      const_iterator begin() const {
+	return const_iterator(words_.data(), words_.size(), 0);
+      }
+
+      const_iterator end() const {
+	return const_iterator(words_.data(), words_.size(), words_.size());
+      }
+
+      /** @brief The bits of the set, 64 members per word */
+      const std::vector<uint64_t>& words() const { return words_; }
+
+      bool operator==(const EnumSet& other) const {
+	const size_t n = std::max(words_.size(), other.words_.size());
+	for (size_t i = 0; i < n; ++i) {
+	  if (wordAt_(i) != other.wordAt_(i)) {
+	    return false;
+	  }
+	}
+	return true;
+      }
+
+      bool operator!=(const EnumSet& other) const {
+	return !(*this == other);
+      }
+
+    private:
+      std::vector<uint64_t> words_;
+
+      static size_t wordsFor_(size_t numMembers) {
+	return (numMembers + 63) / 64;
+      }
+
+      uint64_t wordAt_(size_t i) const {
+	return (i < words_.size()) ? words_[i] : 0;
+      }
+    };
+
+  }
+}
+#endif
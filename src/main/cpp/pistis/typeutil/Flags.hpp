@@ -0,0 +1,576 @@
+#ifndef __PISTIS__TYPEUTIL__FLAGS_HPP__
+#define __PISTIS__TYPEUTIL__FLAGS_HPP__
+
+#include <pistis/typeutil/EnumSet.hpp>
+#include <pistis/typeutil/NameOf.hpp>
+#include <pistis/typeutil/Optional.hpp>
+#include <pistis/typeutil/StringView.hpp>
+#include <pistis/exceptions/IllegalValueError.hpp>
+#include <pistis/exceptions/NoSuchItem.hpp>
+#include <initializer_list>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace pistis {
+  namespace typeutil {
+    namespace detail {
+
+      // Word operations for the bulk kernels, with the same operation on
+      // 256-bit and 128-bit vectors where the target has them
+      struct OrWords {
+	uint64_t operator()(uint64_t a, uint64_t b) const { return a | b; }
+#ifdef __AVX2__
+	__m256i operator()(__m256i a, __m256i b) const {
+	  return _mm256_or_si256(a, b);
+	}
+#endif
+#ifdef __SSE2__
+	__m128i operator()(__m128i a, __m128i b) const {
+	  return _mm_or_si128(a, b);
+	}
+#endif
+      };
+
+      struct AndWords {
+	uint64_t operator()(uint64_t a, uint64_t b) const { return a & b; }
+#ifdef __AVX2__
+	__m256i operator()(__m256i a, __m256i b) const {
+	  return _mm256_and_si256(a, b);
+	}
+#endif
+#ifdef __SSE2__
+	__m128i operator()(__m128i a, __m128i b) const {
+	  return _mm_and_si128(a, b);
+	}
+#endif
+      };
+
+      struct AndNotWords {
+	uint64_t operator()(uint64_t a, uint64_t b) const { return a & ~b; }
+#ifdef __AVX2__
+	__m256i operator()(__m256i a, __m256i b) const {
+	  return _mm256_andnot_si256(b, a);
+	}
+#endif
+#ifdef __SSE2__
+	__m128i operator()(__m128i a, __m128i b) const {
+	  return _mm_andnot_si128(b, a);
+	}
+#endif
+      };
+
+      /** @brief Set <c>out[i] = op(a[i], b[i])</c> for the @e n words
+       *         at @e a and @e b, four or two words at a time where the
+       *         target supports it.  @e out may alias @e a or @e b.
+       */
+      template <typename Op>
+      inline void combineWords(const uint64_t* a, const uint64_t* b,
+			       uint64_t* out, size_t n, Op op) {
+	size_t i = 0;
+#if defined(__AVX2__)
+	for (; i + 4 <= n; i += 4) {
+	  const __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+	  const __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+	  _mm256_storeu_si256((__m256i*)(out + i), op(x, y));
+	}
+#elif defined(__SSE2__)
+	for (; i + 2 <= n; i += 2) {
+	  const __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+	  const __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+	  _mm_storeu_si128((__m128i*)(out + i), op(x, y));
+	}
+#endif
+	for (; i < n; ++i) {
+	  out[i] = op(a[i], b[i]);
+	}
+      }
+
+      /** @brief True if every bit set in the @e n words at @e a is also
+       *         set in the words at @e b
+       */
+      inline bool isSubsetOfWords(const uint64_t* a, const uint64_t* b,
+				  size_t n) {
+	size_t i = 0;
+#if defined(__AVX2__)
+	for (; i + 4 <= n; i += 4) {
+	  const __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+	  const __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+	  if (!_mm256_testc_si256(y, x)) {
+	    return false;
+	  }
+	}
+#elif defined(__SSE2__)
+	for (; i + 2 <= n; i += 2) {
+	  const __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+	  const __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+	  const __m128i extra = _mm_andnot_si128(y, x);
+	  if (_mm_movemask_epi8(_mm_cmpeq_epi8(extra, _mm_setzero_si128()))
+		!= 0xFFFF) {
+	    return false;
+	  }
+	}
+#endif
+	for (; i < n; ++i) {
+	  if (a[i] & ~b[i]) {
+	    return false;
+	  }
+	}
+	return true;
+      }
+
+      /** @brief For each of the @e n single-word masks at @e rows, set
+       *         bit @e i of @e bitmap if row @e i has every bit of
+       *         @e required.  Returns the number of bits set.
+       *
+       *  @e bitmap receives <c>(n + 63) / 64</c> words.
+       */
+      inline size_t selectContainingAll(const uint64_t* rows, size_t n,
+					uint64_t required, uint64_t* bitmap) {
+	size_t count = 0;
+	for (size_t base = 0; base < n; base += 64) {
+	  const size_t end = (n - base < 64) ? n - base : 64;
+	  uint64_t word = 0;
+	  size_t i = 0;
+#ifdef __AVX2__
+	  const __m256i r = _mm256_set1_epi64x((long long)required);
+	  for (; i + 4 <= end; i += 4) {
+	    const __m256i x =
+		_mm256_loadu_si256((const __m256i*)(rows + base + i));
+	    const __m256i hit = _mm256_cmpeq_epi64(_mm256_and_si256(x, r), r);
+	    word |= (uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(hit))
+		      << i;
+	  }
+#endif
+	  for (; i < end; ++i) {
+	    word |= (uint64_t)((rows[base + i] & required) == required) << i;
+	  }
+	  bitmap[base / 64] = word;
+	  count += __builtin_popcountll(word);
+	}
+	return count;
+      }
+    }
+
+    /** @brief A set of members of an enumeration, stored inline as a
+     *         fixed-size bitmask
+     *
+     *  Member @e e is bit <c>e.ordinal()</c> of the mask, so the set
+     *  operations are word-wide bitwise operations, and a Flags with
+     *  @e MAX_MEMBERS of 64 or fewer is a single uint64_t that can be
+     *  copied, stored and compared like an integer.  Unlike EnumSet,
+     *  Flags never allocates, which suits permissions and feature flags
+     *  that are kept on many objects.  @e E may be any Enum,
+     *  ConstexprEnum or CatalogEnum whose members all have ordinals
+     *  below @e MAX_MEMBERS.
+     *
+     *  The names of the members in a Flags are written and parsed as a
+     *  list separated by '|', as in "READ|WRITE".
+     */
+    template <typename E, size_t MAX_MEMBERS = 64>
+    class Flags {
+    public:
+      static_assert(MAX_MEMBERS > 0, "Flags needs room for some members");
+
+      enum : size_t { NUM_WORDS = (MAX_MEMBERS + 63) / 64 };
+
+      typedef typename EnumSet<E>::const_iterator const_iterator;
+      typedef const_iterator iterator;
+
+    public:
+      /** @brief Create an empty set of flags */
+      Flags(): words_() { }
+
+      /** @brief Create a set containing @e members
+       *
+       *  @throws IllegalValueError  if a member's ordinal is not below
+       *                             @e MAX_MEMBERS
+       */
+      Flags(std::initializer_list<E> members): words_() {
+	for (const E& e : members) {
+	  insert(e);
+	}
+      }
+
+      /** @brief Returns the set containing only @e e */
+      static Flags of(const E& e) {
+	Flags f;
+	f.insert(e);
+	return f;
+      }
+
+      /** @brief Returns the set whose bits are the @e NUM_WORDS words at
+       *         @e words
+       */
+      static Flags fromWords(const uint64_t* words) {
+	Flags f;
+	for (size_t i = 0; i < NUM_WORDS; ++i) {
+	  f.words_[i] = words[i];
+	}
+	return f;
+      }
+
+      /** @brief The bits of the set, 64 members per word */
+      const uint64_t* words() const { return words_; }
+
+      /** @brief The bits of the members with ordinals below 64 */
+      uint64_t mask() const { return words_[0]; }
+
+      /** @brief Number of members in the set */
+      size_t size() const {
+	size_t n = 0;
+	for (uint64_t w : words_) {
+	  n += __builtin_popcountll(w);
+	}
+	return n;
+      }
+
+      bool empty() const {
+	uint64_t any = 0;
+	for (uint64_t w : words_) {
+	  any |= w;
+	}
+	return !any;
+      }
+
+      bool contains(const E& e) const {
+	const size_t ordinal = e.ordinal();
+	return (ordinal < MAX_MEMBERS) &&
+		 ((words_[ordinal / 64] >> (ordinal % 64)) & 1);
+      }
+
+      /** @brief True if every member of @e other is in this set */
+      bool containsAll(const Flags& other) const {
+	return other.isSubsetOf(*this);
+      }
+
+      /** @brief True if some member of @e other is in this set */
+      bool containsAny(const Flags& other) const {
+	return !(*this & other).empty();
+      }
+
+      /** @brief True if every member of this set is in @e other */
+      bool isSubsetOf(const Flags& other) const {
+	return detail::isSubsetOfWords(words_, other.words_, NUM_WORDS);
+      }
+
+      /** @brief Add @e e to the set.  Returns true if it was not already
+       *         in the set.
+       *
+       *  @throws IllegalValueError  if the ordinal of @e e is not below
+       *                             @e MAX_MEMBERS
+       */
+      bool insert(const E& e) {
+	const size_t ordinal = checkOrdinal_(e);
+	const uint64_t bit = (uint64_t)1 << (ordinal % 64);
+	const bool added = !(words_[ordinal / 64] & bit);
+	words_[ordinal / 64] |= bit;
+	return added;
+      }
+
+      /** @brief Remove @e e from the set.  Returns true if it was in the
+       *         set.
+       */
+      bool erase(const E& e) {
+	const bool removed = contains(e);
+	if (removed) {
+	  words_[e.ordinal() / 64] &= ~((uint64_t)1 << (e.ordinal() % 64));
+	}
+	return removed;
+      }
+
+      void clear() {
+	for (uint64_t& w : words_) {
+	  w = 0;
+	}
+      }
+
+      /** @brief Iterate over the members in ordinal order */
+      const_iterator begin() const {
+	return const_iterator(words_, NUM_WORDS, 0);
+      }
+
+      const_iterator end() const {
+	return const_iterator(words_, NUM_WORDS, NUM_WORDS);
+      }
+
+      /** @brief Union, intersection and difference */
+      Flags& operator|=(const Flags& other) {
+	detail::combineWords(words_, other.words_, words_, NUM_WORDS,
+			     detail::OrWords());
+	return *this;
+      }
+
+      Flags& operator&=(const Flags& other) {
+	detail::combineWords(words_, other.words_, words_, NUM_WORDS,
+			     detail::AndWords());
+	return *this;
+      }
+
+      Flags& operator-=(const Flags& other) {
+	detail::combineWords(words_, other.words_, words_, NUM_WORDS,
+			     detail::AndNotWords());
+	return *this;
+      }
+
+      Flags operator|(const Flags& other) const {
+	Flags f(*this);
+	return f |= other;
+      }
+
+      Flags operator&(const Flags& other) const {
+	Flags f(*this);
+	return f &= other;
+      }
+
+      Flags operator-(const Flags& other) const {
+	Flags f(*this);
+	return f -= other;
+      }
+
+      Flags operator|(const E& e) const {
+	Flags f(*this);
+	f.insert(e);
+	return f;
+      }
+
+      bool operator==(const Flags& other) const {
+	uint64_t diff = 0;
+	for (size_t i = 0; i < NUM_WORDS; ++i) {
+	  diff |= words_[i] ^ other.words_[i];
+	}
+	return !diff;
+      }
+
+      bool operator!=(const Flags& other) const {
+	return !(*this == other);
+      }
+
+      /** @brief Set each <c>out[i]</c> to <c>a[i] | b[i]</c> for
+       *         @e n flag sets, vectorized across the sets
+       *
+       *  @e out may alias @e a or @e b.
+       */
+      static void unionOf(const Flags* a, const Flags* b, Flags* out,
+			  size_t n) {
+	detail::combineWords(wordsOf_(a), wordsOf_(b), wordsOf_(out),
+			     n * NUM_WORDS, detail::OrWords());
+      }
+
+      /** @brief Set each <c>out[i]</c> to <c>a[i] & b[i]</c> */
+      static void intersectionOf(const Flags* a, const Flags* b, Flags* out,
+				 size_t n) {
+	detail::combineWords(wordsOf_(a), wordsOf_(b), wordsOf_(out),
+			     n * NUM_WORDS, detail::AndWords());
+      }
+
+      /** @brief Set each <c>out[i]</c> to <c>a[i] - b[i]</c> */
+      static void differenceOf(const Flags* a, const Flags* b, Flags* out,
+			       size_t n) {
+	detail::combineWords(wordsOf_(a), wordsOf_(b), wordsOf_(out),
+			     n * NUM_WORDS, detail::AndNotWords());
+      }
+
+      /** @brief Find the sets among the @e n at @e rows that contain
+       *         every member of @e required
+       *
+       *  Sets bit @e i of @e bitmap, which receives
+       *  <c>(n + 63) / 64</c> words, if <c>rows[i]</c> contains
+       *  @e required.
+       *
+       *  @returns  The number of such sets
+       */
+      static size_t selectContainingAll(const Flags* rows, size_t n,
+					const Flags& required,
+					uint64_t* bitmap) {
+	return selectContainingAll_(rows, n, required, bitmap,
+				    std::integral_constant<bool,
+							   NUM_WORDS == 1>());
+      }
+
+      /** @brief Parse a list of member names separated by @e separator
+       *
+       *  Whitespace around each name is ignored, and an empty or
+       *  all-whitespace string is the empty set.
+       *
+       *  @throws NoSuchItem  if some name is not the name of a member
+       */
+      static Flags parse(const StringView& text, char separator = '|') {
+	Flags f;
+	const size_t bad = parse_(text, separator, f);
+	if (bad != text.size()) {
+	  std::ostringstream msg;
+	  msg << "Member of " << typeName<E>() << " named in \"" << text
+	      << "\" at position " << bad;
+	  throw exceptions::NoSuchItem(msg.str(), PISTIS_EX_HERE);
+	}
+	return f;
+      }
+
+      /** @brief Like parse(), but returns an empty Optional instead of
+       *         throwing
+       */
+      static Optional<Flags> tryParse(const StringView& text,
+				      char separator = '|') {
+	Flags f;
+	return (parse_(text, separator, f) == text.size())
+		 ? Optional<Flags>(f) : Optional<Flags>();
+      }
+
+      /** @brief Append the names of the members to @e out, in ordinal
+       *         order, separated by @e separator
+       */
+      void appendTo(std::string& out, char separator = '|') const {
+	bool first = true;
+	for (const E& e : *this) {
+	  if (!first) {
+	    out.push_back(separator);
+	  }
+	  first = false;
+	  e.appendTo(out);
+	}
+      }
+
+      /** @brief Write the names of the members into the @e size
+       *         characters at @e buffer, with the semantics of
+       *         snprintf()
+       *
+       *  @returns  The length of the full list of names, so a result of
+       *            @e size or more means the list was truncated.
+       */
+      size_t formatTo(char* buffer, size_t size, char separator = '|') const {
+	size_t length = 0;
+	for (const E& e : *this) {
+	  if (length) {
+	    if (length + 1 < size) {
+	      buffer[length] = separator;
+	    }
+	    ++length;
+	  }
+	  const size_t room = (length < size) ? size - length : 0;
+	  char* const p = room ? buffer + length : nullptr;
+	  length += e.formatTo(p, room);
+	}
+	if (size) {
+	  buffer[(length < size) ? length : size - 1] = 0;
+	}
+	return length;
+      }
+
+      /** @brief The names of the members, separated by @e separator */
+      std::string str(char separator = '|') const {
+	std::string s;
+	appendTo(s, separator);
+	return s;
+      }
+
+    private:
+      uint64_t words_[NUM_WORDS];
+
+      // The bulk kernels treat an array of Flags as one array of words
+      static const uint64_t* wordsOf_(const Flags* f) {
+	static_assert(sizeof(Flags) == NUM_WORDS * sizeof(uint64_t),
+		      "Flags must be laid out as an array of words");
+	return reinterpret_cast<const uint64_t*>(f);
+      }
+
+      static uint64_t* wordsOf_(Flags* f) {
+	return reinterpret_cast<uint64_t*>(f);
+      }
+
+      static size_t checkOrdinal_(const E& e) {
+	const size_t ordinal = e.ordinal();
+	if (ordinal >= MAX_MEMBERS) {
+	  std::ostringstream msg;
+	  msg << "Member " << e.name() << " of " << typeName<E>()
+	      << " has ordinal " << ordinal << ", but Flags holds only "
+	      << MAX_MEMBERS << " members";
+	  throw exceptions::IllegalValueError(msg.str(), PISTIS_EX_HERE);
+	}
+	return ordinal;
+      }
+
+      // Adds the members named in text to f.  Returns text.size() on
+      // success and the position of the first bad name otherwise.
+      static size_t parse_(const StringView& text, char separator,
+			   Flags& f) {
+	const char* const s = text.data();
+	const size_t n = text.size();
+	size_t start = 0;
+	while (start <= n) {
+	  size_t end = start;
+	  while ((end < n) && (s[end] != separator)) {
+	    ++end;
+	  }
+
+	  size_t first = start;
+	  size_t last = end;
+	  while ((first < last) && isSpace_(s[first])) {
+	    ++first;
+	  }
+	  while ((last > first) && isSpace_(s[last - 1])) {
+	    --last;
+	  }
+
+	  if (first < last) {
+	    const Optional<E> e =
+		E::tryFromName(StringView(s + first, last - first));
+	    if (!e || (e.value().ordinal() >= MAX_MEMBERS)) {
+	      return first;
+	    }
+	    f.insert(e.value());
+	  } else if (start > 0) {
+	    // An empty name after a separator
+	    return start - 1;
+	  } else if (end < n) {
+	    return end;
+	  }
+	  start = end + 1;
+	}
+	return n;
+      }
+
+      static bool isSpace_(char c) {
+	return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r');
+      }
+
+      static size_t selectContainingAll_(const Flags* rows, size_t n,
+					 const Flags& required,
+					 uint64_t* bitmap, std::true_type) {
+	return detail::selectContainingAll(wordsOf_(rows), n, required.mask(),
+					   bitmap);
+      }
+
+      static size_t selectContainingAll_(const Flags* rows, size_t n,
+					 const Flags& required,
+					 uint64_t* bitmap, std::false_type) {
+	size_t count = 0;
+	for (size_t base = 0; base < n; base += 64) {
+	  const size_t end = (n - base < 64) ? n - base : 64;
+	  uint64_t word = 0;
+	  for (size_t i = 0; i < end; ++i) {
+	    word |= (uint64_t)rows[base + i].containsAll(required) << i;
+	  }
+	  bitmap[base / 64] = word;
+	  count += __builtin_popcountll(word);
+	}
+	return count;
+      }
+    };
+
+    template <typename E, size_t MAX_MEMBERS>
+    inline std::ostream& operator<<(std::ostream& out,
+				    const Flags<E, MAX_MEMBERS>& f) {
+      return out << f.str();
+    }
+
+  }
+}
+#endif
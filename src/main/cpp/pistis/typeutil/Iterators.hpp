@@ -75,7 +75,7 @@ namespace pistis {
     struct IteratorImplTraits<PtrT*> {
       typedef PtrT& ReferenceType;
       typedef PtrT* PointerType;
-      typedef PtrT  ValuueType;
+      typedef PtrT  ValueType;
       typedef ptrdiff_t DistanceType;
     };
 
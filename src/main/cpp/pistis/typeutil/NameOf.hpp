@@ -1,14 +1,44 @@
 #ifndef __PISTIS__TYPEUTIL__NAMEOF_HPP__
 #define __PISTIS__TYPEUTIL__NAMEOF_HPP__
 
+#include <pistis/typeutil/StringView.hpp>
+#include <algorithm>
+#include <atomic>
+#include <ostream>
 #include <string>
 #include <typeinfo>
+#include <utility>
+#include <vector>
 #include <cxxabi.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/** @brief Defined to 1 if typeName() and typeId() are evaluated at
+ *         compile time and 0 if they fall back to nameOf()
+ */
+#ifndef PISTIS_HAS_CONSTEXPR_TYPE_NAME
+  #if defined(__clang__) || defined(__GNUC__)
+    #define PISTIS_HAS_CONSTEXPR_TYPE_NAME 1
+  #else
+    #define PISTIS_HAS_CONSTEXPR_TYPE_NAME 0
+  #endif
+#endif
+
+#if PISTIS_HAS_CONSTEXPR_TYPE_NAME
+  #define PISTIS_TYPE_NAME_CONSTEXPR constexpr
+#else
+  #define PISTIS_TYPE_NAME_CONSTEXPR
+#endif
 
 namespace pistis {
   namespace typeutil {
 
-    /** @brief Returns a printable name for type T */
+    /** @brief Returns a printable name for type T
+     *
+     *  Demangles the name from std::type_info into a new string on every
+     *  call.  Prefer typeName(), which does neither, or cachedNameOf().
+     */
     template <typename T>
     std::string nameOf() {
       int status;
@@ -18,7 +48,259 @@ namespace pistis {
       return result;
     }
 
+    namespace detail {
+
+      /** @brief The demangled name of one type and the number of times
+       *         cachedNameOf() has returned it
+       *
+       *  Entries form a list that only grows, and are never freed, so
+       *  the names stay valid while static objects are destroyed.
+       */
+      struct NameOfEntry {
+	const std::string name;
+	std::atomic<uint64_t> count;
+	NameOfEntry* next;
+
+	NameOfEntry(std::string&& n): name(std::move(n)), count(0),
+				      next(nullptr) { }
+      };
+
+      inline std::atomic<bool>& nameOfCounting() {
+	static std::atomic<bool> counting(false);
+	return counting;
+      }
+
+      inline std::atomic<NameOfEntry*>& nameOfEntries() {
+	static std::atomic<NameOfEntry*> head(nullptr);
+	return head;
+      }
+
+      inline NameOfEntry* registerNameOf(std::string&& name) {
+	NameOfEntry* entry = new NameOfEntry(std::move(name));
+	std::atomic<NameOfEntry*>& head = nameOfEntries();
+	entry->next = head.load(std::memory_order_relaxed);
+	while (!head.compare_exchange_weak(entry->next, entry,
+					   std::memory_order_release,
+					   std::memory_order_relaxed)) {
+	}
+	return entry;
+      }
+
+    }
+
+    /** @brief Returns the same name as nameOf(), demangling it only on
+     *         the first call for type T
+     *
+     *  The first call for T demangles the name into an entry of the
+     *  registry reported by nameOfUsage(), under the compiler's guard for
+     *  function-local statics.  Later calls take no locks, and only count
+     *  themselves while countNameOfCalls() is on, so by default they
+     *  write nothing that other threads read.  The returned string lives
+     *  until the program exits.
+     */
+    template <typename T>
+    const std::string& cachedNameOf() {
+      static detail::NameOfEntry* const entry =
+	  detail::registerNameOf(nameOf<T>());
+      if (detail::nameOfCounting().load(std::memory_order_relaxed)) {
+	entry->count.fetch_add(1, std::memory_order_relaxed);
+      }
+      return entry->name;
+    }
+
+    /** @brief Turn on or off the counting of calls to cachedNameOf()
+     *         that nameOfUsage() reports
+     *
+     *  Counting is off by default, since every thread that counts a
+     *  call to cachedNameOf() for the same type writes the same counter.
+     */
+    inline void countNameOfCalls(bool enabled) {
+      detail::nameOfCounting().store(enabled, std::memory_order_relaxed);
+    }
+
+    /** @brief A type whose name was requested from cachedNameOf() */
+    struct NameOfUsage {
+      std::string name;
+      uint64_t count;  ///< Calls to cachedNameOf() while counting was on
+    };
+
+    /** @brief Returns every type whose name has been requested from
+     *         cachedNameOf(), most requested first
+     *
+     *  Every such type is listed, but only calls made while
+     *  countNameOfCalls() was on are counted.  Safe to call while other
+     *  threads call cachedNameOf(), though their calls may or may not be
+     *  counted.
+     */
+    inline std::vector<NameOfUsage> nameOfUsage() {
+      std::vector<NameOfUsage> usage;
+      for (const detail::NameOfEntry* entry =
+	     detail::nameOfEntries().load(std::memory_order_acquire);
+	   entry; entry = entry->next) {
+	usage.push_back(
+	    NameOfUsage{ entry->name,
+			 entry->count.load(std::memory_order_relaxed) }
+	);
+      }
+      std::sort(usage.begin(), usage.end(),
+		[](const NameOfUsage& x, const NameOfUsage& y) {
+		  return (x.count > y.count) ||
+			   ((x.count == y.count) && (x.name < y.name));
+		});
+      return usage;
+    }
+
+    /** @brief Write nameOfUsage() to @e out, one "count name" line per
+     *         type
+     */
+    inline void dumpNameOfUsage(std::ostream& out) {
+      for (const NameOfUsage& u : nameOfUsage()) {
+	out << u.count << " " << u.name << "\n";
+      }
+    }
+
+#if PISTIS_HAS_CONSTEXPR_TYPE_NAME
+
+    namespace detail {
+
+      /** @brief Returns the position of the first occurrence of @e key in
+       *         @e s, or the size of @e s if it does not occur
+       */
+      constexpr size_t findInSignature(const StringView& s,
+				       const StringView& key) {
+	for (size_t i = 0; i + key.size() <= s.size(); ++i) {
+	  if (s.substr(i, key.size()) == key) {
+	    return i;
+	  }
+	}
+	return s.size();
+      }
+
+      /** @brief Extract the name of T from the signature of typeSignature()
+       *
+       *  GCC writes the signature as
+       *  <c>"... typeSignature() [with T = int]"</c> and clang as
+       *  <c>"... typeSignature() [T = int]"</c>.  The name runs from the
+       *  "=" to the closing bracket at the end of the signature, and may
+       *  itself contain brackets.
+       */
+      constexpr StringView typeNameFromSignature(const StringView& s) {
+	const size_t gcc = findInSignature(s, "[with T = ");
+	const size_t start = (gcc < s.size()) ? gcc + 10
+					      : findInSignature(s, "[T = ") + 5;
+	return (start < s.size()) ? s.substr(start, s.size() - start - 1)
+				  : StringView();
+      }
+
+      template <typename T>
+      constexpr StringView typeSignature() {
+	return StringView(__PRETTY_FUNCTION__,
+			  sizeof(__PRETTY_FUNCTION__) - 1);
+      }
+
+      /** @brief Holds the name of T in a constant, which the compiler
+       *         must evaluate at compile time
+       */
+      template <typename T>
+      struct StaticTypeName {
+	static constexpr StringView value =
+	    typeNameFromSignature(typeSignature<T>());
+      };
+
+      template <typename T>
+      constexpr StringView StaticTypeName<T>::value;
+
+    }
+
+    /** @brief Returns a printable name for type T without demangling or
+     *         allocating
+     *
+     *  The name is taken from the compiler's signature of a function
+     *  template instantiated for T, so it is computed at compile time
+     *  and the view refers to static storage that lives as long as the
+     *  program.  Compilers spell some names differently from nameOf(),
+     *  e.g. GCC omits default template arguments and writes
+     *  "{anonymous}" for an anonymous namespace.
+     */
+    template <typename T>
+    constexpr StringView typeName() {
+      return detail::StaticTypeName<T>::value;
+    }
+
+#else
+
+    /** @brief Returns a printable name for type T
+     *
+     *  This compiler cannot compute the name at compile time, so the
+     *  name comes from nameOf() on the first call and refers to a static
+     *  copy thereafter.
+     */
+    template <typename T>
+    StringView typeName() {
+      static const std::string name(nameOf<T>());
+      return StringView(name);
+    }
+
+#endif
+
+    /** @brief A 64-bit fingerprint of a type, as returned by typeId() */
+    typedef uint64_t TypeId;
+
+    /** @brief Returns the TypeId of the type named @e name
+     *
+     *  The id is the 64-bit FNV-1a hash of the name, except that a hash
+     *  of zero becomes one, so zero never identifies a type.
+     */
+    constexpr TypeId typeIdOfName(const StringView& name) {
+      uint64_t h = 0xcbf29ce484222325ull;
+      for (char c : name) {
+	h = (h ^ (uint8_t)c) * 0x100000001b3ull;
+      }
+      return h ? h : 1;
+    }
+
+    /** @brief Returns a 64-bit fingerprint of type T
+     *
+     *  The fingerprint is typeIdOfName(typeName<T>()), so it is computed
+     *  at compile time and does not change from one build to the next.
+     *  It is the same on GCC and clang for types whose names they spell
+     *  alike, such as classes in named namespaces, but not for types
+     *  such as std::string.  Programs that exchange ids with programs
+     *  built by another compiler should compute the ids of such types
+     *  with typeIdOfName() and a name of their choosing.
+     */
+    template <typename T>
+    PISTIS_TYPE_NAME_CONSTEXPR TypeId typeId();
+
+#if PISTIS_HAS_CONSTEXPR_TYPE_NAME
+
+    namespace detail {
+
+      /** @brief Holds the TypeId of T in a constant, like StaticTypeName */
+      template <typename T>
+      struct StaticTypeId {
+	static constexpr TypeId value = typeIdOfName(typeName<T>());
+      };
+
+      template <typename T>
+      constexpr TypeId StaticTypeId<T>::value;
+
+    }
+
+    template <typename T>
+    constexpr TypeId typeId() {
+      return detail::StaticTypeId<T>::value;
+    }
+
+#else
+
+    template <typename T>
+    TypeId typeId() {
+      return typeIdOfName(typeName<T>());
+    }
+
+#endif
+
   }
 }
 #endif
-
@@ -0,0 +1,221 @@
+#ifndef __PISTIS__TYPEUTIL__NAMETRIE_HPP__
+#define __PISTIS__TYPEUTIL__NAMETRIE_HPP__
+
+#include <pistis/typeutil/StringView.hpp>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace pistis {
+  namespace typeutil {
+
+    /** @brief A compressed trie over a fixed set of names that ignores
+     *         the case of ASCII letters
+     *
+     *  Nodes and edges live in flat arrays, and the characters on the
+     *  edges are slices of a single pool holding the lower-cased names,
+     *  so a lookup walks contiguous memory and never allocates.  One
+     *  walk answers three questions about a key:  which name equals it,
+     *  which single name it is a prefix of, and which name is the
+     *  longest prefix of it.
+     */
+    class NameTrie {
+    public:
+      enum : uint32_t {
+	NOT_FOUND = ~(uint32_t)0,     ///< No name matches
+	AMBIGUOUS = ~(uint32_t)0 - 1  ///< More than one name matches
+      };
+
+      /** @brief Result of match().  Each id is NOT_FOUND, AMBIGUOUS or
+       *         the id of the matching name.
+       */
+      struct Match {
+	uint32_t exact;          ///< Name equal to the key
+	uint32_t uniquePrefix;   ///< Only name that starts with the key
+	uint32_t longestPrefix;  ///< Longest name the key starts with
+	size_t longestPrefixLength;
+      };
+
+    public:
+      NameTrie() { }
+
+      /** @brief Build the trie
+       *
+       *  @param names  The names.  Names that differ only in case are
+       *                allowed, but then match AMBIGUOUS.
+       *  @param ids    Id to associate with each name
+       *  @param n      Number of names
+       */
+      void build(const StringView* names, const uint32_t* ids, size_t n) {
+	nodes_.clear();
+	edgeChars_.clear();
+	edges_.clear();
+	pool_.clear();
+
+	std::vector<Entry> entries;
+	entries.reserve(n);
+	for (size_t i = 0; i < n; ++i) {
+	  entries.push_back(Entry{ (uint32_t)pool_.size(),
+				    (uint32_t)names[i].size(), ids[i] });
+	  for (char c : names[i]) {
+	    pool_.push_back(fold(c));
+	  }
+	}
+	std::sort(entries.begin(), entries.end(),
+		  [this](const Entry& x, const Entry& y) {
+		    return key_(x) < key_(y);
+		  });
+	buildNode_(entries, 0, entries.size(), 0);
+      }
+
+      /** @brief True if build() has not been called */
+      bool empty() const { return nodes_.empty(); }
+
+      /** @brief Walk the trie once with the @e n characters at @e s */
+      Match match(const char* s, size_t n) const {
+	Match m{ NOT_FOUND, NOT_FOUND, NOT_FOUND, 0 };
+	if (nodes_.empty()) {
+	  return m;
+	}
+
+	uint32_t node = 0;
+	size_t pos = 0;
+	for (;;) {
+	  const Node& current = nodes_[node];
+	  if (current.terminal != NOT_FOUND) {
+	    m.longestPrefix = current.terminal;
+	    m.longestPrefixLength = pos;
+	  }
+	  if (pos == n) {
+	    m.exact = current.terminal;
+	    m.uniquePrefix = current.unique;
+	    return m;
+	  }
+
+	  const uint8_t* const first = edgeChars_.data() + current.firstEdge;
+	  const uint8_t* const last = first + current.numEdges;
+	  const uint8_t* const e = std::find(first, last,
+					     (uint8_t)fold(s[pos]));
+	  if (e == last) {
+	    return m;
+	  }
+
+	  const Edge& edge = edges_[e - edgeChars_.data()];
+	  const size_t count = std::min((size_t)edge.length, n - pos);
+	  for (size_t i = 1; i < count; ++i) {
+	    if (fold(s[pos + i]) != pool_[edge.start + i]) {
+	      return m;
+	    }
+	  }
+	  if (count < edge.length) {
+	    // The key ends partway along the edge
+	    m.uniquePrefix = nodes_[edge.target].unique;
+	    return m;
+	  }
+	  pos += edge.length;
+	  node = edge.target;
+	}
+      }
+
+      Match match(const StringView& s) const {
+	return match(s.data(), s.size());
+      }
+
+      /** @brief Lower-case @e c if it is an ASCII capital letter */
+      static char fold(char c) {
+	return ((c >= 'A') && (c <= 'Z')) ? (char)(c - 'A' + 'a') : c;
+      }
+
+    private:
+      struct Node {
+	uint32_t firstEdge;
+	uint32_t numEdges;
+	uint32_t terminal;  ///< Id of the name that ends here
+	uint32_t unique;    ///< Id of the only name below here
+      };
+
+      struct Edge {
+	uint32_t start;   ///< Position of the edge's characters in pool_
+	uint32_t length;
+	uint32_t target;
+      };
+
+      struct Entry {
+	uint32_t start;
+	uint32_t length;
+	uint32_t id;
+      };
+
+      std::vector<Node> nodes_;
+      std::vector<uint8_t> edgeChars_;  ///< First character of each edge
+      std::vector<Edge> edges_;
+      std::string pool_;                ///< The lower-cased names
+
+      StringView key_(const Entry& e) const {
+	return StringView(pool_.data() + e.start, e.length);
+      }
+
+      static uint32_t combine_(uint32_t id, uint32_t other) {
+	return (id == NOT_FOUND) ? other : AMBIGUOUS;
+      }
+
+      /** @brief Build the node for @e entries[lo, hi), which share
+       *         their first @e depth characters
+       */
+      uint32_t buildNode_(const std::vector<Entry>& entries, size_t lo,
+			  size_t hi, uint32_t depth) {
+	const uint32_t node = (uint32_t)nodes_.size();
+	nodes_.push_back(Node{ 0, 0, NOT_FOUND, NOT_FOUND });
+
+	uint32_t unique = NOT_FOUND;
+	for (size_t i = lo; i < hi; ++i) {
+	  unique = combine_(unique, entries[i].id);
+	}
+	nodes_[node].unique = unique;
+
+	// Sorting puts the names that end here first
+	size_t i = lo;
+	for (; (i < hi) && (entries[i].length == depth); ++i) {
+	  nodes_[node].terminal =
+	      combine_(nodes_[node].terminal, entries[i].id);
+	}
+
+	// Children are built first, so this node's edges are contiguous
+	std::vector<Edge> edges;
+	while (i < hi) {
+	  const char c = pool_[entries[i].start + depth];
+	  size_t end = i + 1;
+	  while ((end < hi) && (pool_[entries[end].start + depth] == c)) {
+	    ++end;
+	  }
+
+	  // The group's common prefix is that of its first and last names
+	  const Entry& a = entries[i];
+	  const Entry& b = entries[end - 1];
+	  uint32_t length = 1;
+	  while ((depth + length < a.length) && (depth + length < b.length) &&
+		 (pool_[a.start + depth + length] ==
+		    pool_[b.start + depth + length])) {
+	    ++length;
+	  }
+
+	  const uint32_t child = buildNode_(entries, i, end, depth + length);
+	  edges.push_back(Edge{ a.start + depth, length, child });
+	  i = end;
+	}
+
+	nodes_[node].firstEdge = (uint32_t)edges_.size();
+	nodes_[node].numEdges = (uint32_t)edges.size();
+	for (const Edge& edge : edges) {
+	  edgeChars_.push_back((uint8_t)pool_[edge.start]);
+	  edges_.push_back(edge);
+	}
+	return node;
+      }
+    };
+
+  }
+}
+#endif
@@ -1,11 +1,14 @@
 #ifndef __PISTIS__TYPEUTIL__OPTIONAL_HPP__
 #define __PISTIS__TYPEUTIL__OPTIONAL_HPP__
 
+#include <pistis/typeutil/ExtendedTypeTraits.hpp>
 #include <pistis/exceptions/PistisException.hpp>
 #include <new>
 #include <ostream>
+#include <type_traits>
 #include <utility>
 #include <stdint.h>
+#include <string.h>
 
 namespace pistis {
   namespace exceptions {
@@ -33,84 +36,294 @@ namespace pistis {
     
   namespace typeutil {
 
-    /** @brief A value that may be absent */
+    /** @brief NichePolicy for an Optional that records whether it holds
+     *         a value in a flag stored beside the value
+     *
+     *  A NichePolicy lets Optional<T, NichePolicy> mark itself empty by
+     *  holding a value of T that the application never uses, so the
+     *  optional takes no more space than T.  The policy provides
+     *  <c>static T empty()</c>, which returns that value, and
+     *  <c>static bool isEmpty(const T&)</c>, which recognizes it.
+     *  Storing the value returned by empty() in such an optional leaves
+     *  it empty.  Only trivially copyable types can have a niche.
+     */
+    struct NoNiche { };
+
+    /** @brief NichePolicy that marks an empty optional with a null
+     *         pointer
+     */
+    template <typename T>
+    struct NullNiche {
+      static constexpr T empty() { return nullptr; }
+      static constexpr bool isEmpty(const T& v) { return v == nullptr; }
+    };
+
+    /** @brief NichePolicy that marks an empty optional with
+     *         @e SENTINEL, such as the largest value of an integer or an
+     *         unused value of an enum
+     */
+    template <typename T, T SENTINEL>
+    struct SentinelNiche {
+      static constexpr T empty() { return SENTINEL; }
+      static constexpr bool isEmpty(const T& v) { return v == SENTINEL; }
+    };
+
+    /** @brief NichePolicy that marks an empty optional with one
+     *         particular quiet NaN
+     *
+     *  The empty value is recognized by its bits, so the optional can
+     *  still hold the NaNs that arithmetic produces.  Specialized for
+     *  float and double.
+     */
     template <typename T>
-    class Optional {
+    struct NanNiche;
+
+    template <>
+    struct NanNiche<double> {
+      enum : uint64_t { BITS = 0x7FF8DEAD0000BEEFull };
+
+      static double empty() {
+	const uint64_t bits = BITS;
+	double v;
+	memcpy(&v, &bits, sizeof(v));
+	return v;
+      }
+
+      static bool isEmpty(const double& v) {
+	uint64_t bits;
+	memcpy(&bits, &v, sizeof(bits));
+	return bits == BITS;
+      }
+    };
+
+    template <>
+    struct NanNiche<float> {
+      enum : uint32_t { BITS = 0x7FC0BEEFu };
+
+      static float empty() {
+	const uint32_t bits = BITS;
+	float v;
+	memcpy(&v, &bits, sizeof(v));
+	return v;
+      }
+
+      static bool isEmpty(const float& v) {
+	uint32_t bits;
+	memcpy(&bits, &v, sizeof(bits));
+	return bits == BITS;
+      }
+    };
+
+    namespace detail {
+      namespace optional_swap {
+	using std::swap;
+
+	/** @brief std::true_type if swapping two values of type T, as
+	 *         found by argument-dependent lookup, cannot throw
+	 */
+	template <typename T>
+	struct IsNothrowSwappable :
+	    public std::integral_constant<
+		bool, noexcept(swap(std::declval<T&>(), std::declval<T&>()))
+	    > {
+	};
+      }
+
+      /** @brief Storage for the value of an Optional */
+      template <typename T>
+      class OptionalStorageBase {
+      protected:
+	OptionalStorageBase(): present_(false) { }
+
+	bool hasValue_() const { return present_; }
+	const T* ptr_() const { return reinterpret_cast<const T*>(data_); }
+	T* ptr_() { return reinterpret_cast<T*>(data_); }
+
+	/** @brief Construct the value from @e args
+	 *
+	 *  @pre  No value is present
+	 */
+	template <typename... Args>
+	void construct_(Args&&... args) {
+	  new(ptr_()) T(std::forward<Args>(args)...);
+	  present_ = true;
+	}
+
+	bool present_; ///< True if the value is present
+	alignas(T) uint8_t data_[sizeof(T)]; ///< Object stored here when present
+      };
+
+      /** @brief Optional storage for a T that can be copied by copying
+       *         its bytes and needs no destructor
+       *
+       *  Copying, moving and destroying the storage are trivial, so an
+       *  Optional of such a T is trivially copyable.  Moving copies the
+       *  value and leaves the source as it was.
+       */
+      template <typename T,
+		bool TRIVIAL =
+		    std::is_trivially_copy_constructible<T>::value &&
+		    std::is_trivially_move_constructible<T>::value &&
+		    std::is_trivially_destructible<T>::value>
+      class OptionalStorage : public OptionalStorageBase<T> {
+      protected:
+	void destroy_() noexcept { this->present_ = false; }
+      };
+
+      /** @brief Optional storage for any other T
+       *
+       *  Copies and moves construct a new value with T's constructors,
+       *  and a move leaves the source empty.
+       */
+      template <typename T>
+      class OptionalStorage<T, false> : public OptionalStorageBase<T> {
+      protected:
+	OptionalStorage() { }
+
+	OptionalStorage(const OptionalStorage& other) {
+	  if (other.present_) {
+	    this->construct_(*other.ptr_());
+	  }
+	}
+
+	OptionalStorage(OptionalStorage&& other)
+	    noexcept(std::is_nothrow_move_constructible<T>::value) {
+	  if (other.present_) {
+	    this->construct_(std::move(*other.ptr_()));
+	    other.destroy_();
+	  }
+	}
+
+	~OptionalStorage() { destroy_(); }
+
+	OptionalStorage& operator=(const OptionalStorage& other) {
+	  if (&other != this) {
+	    destroy_();
+	    if (other.present_) {
+	      this->construct_(*other.ptr_());
+	    }
+	  }
+	  return *this;
+	}
+
+	OptionalStorage& operator=(OptionalStorage&& other)
+	    noexcept(std::is_nothrow_move_constructible<T>::value) {
+	  if (&other != this) {
+	    destroy_();
+	    if (other.present_) {
+	      this->construct_(std::move(*other.ptr_()));
+	      other.destroy_();
+	    }
+	  }
+	  return *this;
+	}
+
+	void destroy_() noexcept {
+	  if (this->present_) {
+	    this->ptr_()->~T();
+	    this->present_ = false;
+	  }
+	}
+      };
+
+      /** @brief Optional storage that holds NichePolicy::empty() when the
+       *         optional is empty
+       */
+      template <typename T, typename NichePolicy>
+      class NicheOptionalStorage {
+      protected:
+	static_assert(std::is_trivially_copyable<T>::value,
+		      "Only trivially copyable types can have a niche");
+
+	NicheOptionalStorage(): value_(NichePolicy::empty()) { }
+
+	bool hasValue_() const { return !NichePolicy::isEmpty(value_); }
+
+	const T* ptr_() const { return &value_; }
+	T* ptr_() { return &value_; }
+
+	template <typename... Args>
+	void construct_(Args&&... args) {
+	  new(&value_) T(std::forward<Args>(args)...);
+	}
+
+	void destroy_() noexcept { value_ = NichePolicy::empty(); }
+
+	T value_;
+      };
+
+      template <typename T, typename NichePolicy>
+      struct OptionalStorageFor {
+	typedef NicheOptionalStorage<T, NichePolicy> type;
+      };
+
+      template <typename T>
+      struct OptionalStorageFor<T, NoNiche> {
+	typedef OptionalStorage<T> type;
+      };
+    }
+
+    /** @brief A value that may be absent
+     *
+     *  If T can be copied by copying its bytes and has a trivial
+     *  destructor, so does Optional<T>, and then moving an optional
+     *  copies it.  Otherwise, moving an optional leaves the source
+     *  empty.  Moving and swapping optionals are noexcept when the same
+     *  operations on T are, so containers such as std::vector move
+     *  optionals rather than copy them when they reallocate.
+     *
+     *  With a NichePolicy other than NoNiche, the optional marks itself
+     *  empty with a value of T the application never uses, and is the
+     *  same size as T.  For example, Optional<double, NanNiche<double>>
+     *  takes 8 bytes rather than 16.
+     */
+    template <typename T, typename NichePolicy = NoNiche>
+    class Optional :
+	private detail::OptionalStorageFor<T, NichePolicy>::type {
     public:
       /** @brief Creates an empty optional */
-      Optional(): present_(false) { }
+      Optional() { }
       
       /** @brief Creates an optional containing a copy of @e v
        *
        *  @param v  Value optional will contain
        */
-      explicit Optional(const T& v): present_(true) {
-	new(reinterpret_cast<T*>(data_)) T(v);
-      }
+      explicit Optional(const T& v) { this->construct_(v); }
 
       /** @brief Creates an optional containing @e v by moving it
        *
        *  @param v  Value optional will contain
        */
-      explicit Optional(T&& v): present_(true) {
-	new(reinterpret_cast<T*>(data_)) T(std::move(v));
-      }
-
-      /** @brief Creates a copy of @e other
-       *
-       *  Because we declare a move constructor, we need to declare an
-       *  explicit copy constructor rather than relying on the template.
-       *
-       *  @param other  Optional to copy
-       */
-      Optional(const Optional& other): present_(other.present()) {
-	if (present_) {
-	  new(reinterpret_cast<T*>(data_)) T(other.value());
-	}
-      }
+      explicit Optional(T&& v) { this->construct_(std::move(v)); }
 
       /** @brief Creates a copy of @e other, performing a type conversion
        *         if needed.
        *
+       *  Copying and moving an Optional of the same type is done by
+       *  its storage.
+       *
        *  @pre  @e U is convertible to @e T
        *  @param other  Optional to copy
        */
-      template <typename U>
-      Optional(const Optional<U>& other): present_(other.present()) {
-	if (present_) {
-	  new(reinterpret_cast<T*>(data_)) T(other.value());
-	}
-      }
-
-      /** @brief Moves @e other into this.
-       *
-       *  After the move, @e other is empty
-       *
-       *  @param other  Optional to move
-       */
-      Optional(Optional&& other): present_(other.present_) {
-	if (present_) {
-	  new(reinterpret_cast<T*>(data_))
-	    T(std::move(*reinterpret_cast<T*>(other.data_)));
-	  other.present_ = false;
+      template <typename U, typename P>
+      Optional(const Optional<U, P>& other) {
+	if (other.present()) {
+	  this->construct_(other.value());
 	}
       }
 
-      /** @brief Destroys this optional */
-      ~Optional() { clear(); }
-
       /** @brief True if this optional does not contain a value */
-      bool empty() const { return !present_; }
+      bool empty() const { return !this->hasValue_(); }
 
       /** @brief True if this optional contains a value */
-      bool present() const { return present_; }
+      bool present() const { return this->hasValue_(); }
 
       /** @brief Return this optional's value
        *
        *  @returns The value contained in this optional
        *  @throws OptionalEmptyError if the optional does not contain a value
        */
-      const T& value() const {
+      const T& value() const & {
 	checkForValue_([](){ return PISTIS_EX_HERE; });
 	return value_();
       }
@@ -120,11 +333,22 @@ namespace pistis {
        *  @returns The value contained in this optional
        *  @throws OptionalEmptyError if the optional does not contain a value
        */
-      T& value() {
+      T& value() & {
 	checkForValue_([]() { return PISTIS_EX_HERE; });
 	return value_();
       }
 
+      /** @brief Return this optional's value, which the caller may move
+       *         from
+       *
+       *  @returns The value contained in this optional
+       *  @throws OptionalEmptyError if the optional does not contain a value
+       */
+      T&& value() && {
+	checkForValue_([]() { return PISTIS_EX_HERE; });
+	return std::move(value_());
+      }
+
       /** @brief Return this optional's value, if present, or @e defaultValue
        *         if the optional is empty
        *
@@ -132,10 +356,17 @@ namespace pistis {
        *           or @e defaultValue (converted to type T) if the optional
        *           is empty.
        */
-      const T& valueOr(const T& defaultValue) const {
+      const T& valueOr(const T& defaultValue) const & {
 	return present() ? value_() : defaultValue;
       }
 
+      /** @brief Move this optional's value out of it, if present, or
+       *         return @e defaultValue if the optional is empty.
+       */
+      T valueOr(T defaultValue) && {
+	return present() ? std::move(value_()) : std::move(defaultValue);
+      }
+
       /** @brief Return this optional's value, if present, or the result
        *         of calling @e f if the optional is empty.
        *
@@ -146,10 +377,18 @@ namespace pistis {
        *            <c>this->present() ? this->value() : f()</c>
        */
       template <typename Function>
-      T valueOrCall(Function f) const {
+      T valueOrCall(Function f) const & {
 	return present() ? value_() : static_cast<T>(f());
       }
 
+      /** @brief Move this optional's value out of it, if present, or
+       *         return the result of calling @e f if the optional is empty.
+       */
+      template <typename Function>
+      T valueOrCall(Function f) && {
+	return present() ? std::move(value_()) : static_cast<T>(f());
+      }
+
       /** @brief Apply @e f to this optional's value if it has one.
        *
        *  Does nothing if this optional is empty.
@@ -159,13 +398,25 @@ namespace pistis {
        *  @returns *this
        */
       template <typename Function>
-      const Optional<T>& ifPresent(Function f) const {
+      const Optional& ifPresent(Function f) const & {
 	if (present()) {
-	  f(value());
+	  f(value_());
 	}
 	return *this;
       }
 
+      /** @brief Move this optional's value into @e f if it has one.
+       *
+       *  @returns  This optional, whose value has been moved from
+       */
+      template <typename Function>
+      Optional&& ifPresent(Function f) && {
+	if (present()) {
+	  f(std::move(value_()));
+	}
+	return std::move(*this);
+      }
+
       /** @brief Call @e f if this optional is empty.
        *
        *  The @e orElse method allows for constructs like:
@@ -179,7 +430,7 @@ namespace pistis {
        *  @returns  *this
        */
       template <typename Function>
-      const Optional<T>& orElse(Function f) const {
+      const Optional& orElse(Function f) const {
 	if (empty()) {
 	  f();
 	}
@@ -206,13 +457,30 @@ namespace pistis {
        *            type of @e f.
        */
       template <typename Function>
-      auto map(Function f) const -> Optional<decltype(f(*(T*)0))> {
+      auto map(Function f) const & -> Optional<decltype(f(*(T*)0))> {
 	if (present()) {
 	  return Optional<decltype(f(*(T*)0))>(f(value_()));
 	}
 	return Optional<decltype(f(*(T*)0))>();
       }
 
+      /** @brief Move the value of this optional into @e f and return an
+       *         optional containing the result.
+       *
+       *  Chaining <c>map()</c> on a temporary optional thus moves the
+       *  value from step to step rather than copying it.
+       */
+      template <typename Function>
+      auto map(Function f) && ->
+	  Optional<decltype(f(std::declval<T>()))> {
+	if (present()) {
+	  return Optional<decltype(f(std::declval<T>()))>(
+	      f(std::move(value_()))
+	  );
+	}
+	return Optional<decltype(f(std::declval<T>()))>();
+      }
+
       /** @brief Apply @e f to the value of this optional and return
        *         the result.
        *
@@ -226,13 +494,24 @@ namespace pistis {
        *            where @e U is the return type of @e f.
        */
       template <typename Function>
-      auto apply(Function f) const -> decltype(f(*(T*)0)) {
+      auto apply(Function f) const & -> decltype(f(*(T*)0)) {
 	if (present()) {
 	  return f(value_());
 	}
 	return decltype(f(*(T*)0))();
       }
 
+      /** @brief Move the value of this optional into @e f and return
+       *         the result, or <c>U()</c> if this optional is empty.
+       */
+      template <typename Function>
+      auto apply(Function f) && -> decltype(f(std::declval<T>())) {
+	if (present()) {
+	  return f(std::move(value_()));
+	}
+	return decltype(f(std::declval<T>()))();
+      }
+
       /** @brief Apply @f to the value of this optional and return the
        *         result.  Return <c>g()</c> if this optional is empty.
        *
@@ -246,7 +525,7 @@ namespace pistis {
        *            <c>opt.present() ? f(opt.value()) : g()</c>
        */
       template <typename PresentFunction, typename AbsentFunction>
-      auto applyOr(PresentFunction f, AbsentFunction g) const ->
+      auto applyOr(PresentFunction f, AbsentFunction g) const & ->
 	decltype(f(*(T*)0)) {
 	if (present()) {
 	  return f(value_());
@@ -254,6 +533,18 @@ namespace pistis {
 	return g();
       }
 
+      /** @brief Move the value of this optional into @e f and return the
+       *         result.  Return <c>g()</c> if this optional is empty.
+       */
+      template <typename PresentFunction, typename AbsentFunction>
+      auto applyOr(PresentFunction f, AbsentFunction g) && ->
+	  decltype(f(std::declval<T>())) {
+	if (present()) {
+	  return f(std::move(value_()));
+	}
+	return g();
+      }
+
       /** @brief Returns this optional if <c>p(value())</c> is true, or
        *         an empty optional if this optional is empty or
        *         <c>p(value())</c> is false.
@@ -265,20 +556,27 @@ namespace pistis {
        *            <c>p(value())</c> is true; an empty optional otherwise.
        */
       template <typename Predicate>
-      const Optional<T>& filter(Predicate p) {
+      const Optional& filter(Predicate p) {
 	return (empty() || p(value_())) ? *this : emptyOptional_();
       }
 
+      /** @brief Replace the value of this optional with one constructed
+       *         in place from @e args
+       *
+       *  @returns  The new value
+       */
+      template <typename... Args>
+      T& emplace(Args&&... args) {
+	clear();
+	this->construct_(std::forward<Args>(args)...);
+	return value_();
+      }
+
       /** @brief Destroy the value this optional contains, leaving it empty.
        *
        *  Does nothing if the optional is empty.
        */
-      void clear() {
-	if (present()) {
-	  reinterpret_cast<T*>(data_)->~T();
-	  present_ = false;
-	}
-      }
+      void clear() noexcept { this->destroy_(); }
 
       /** @brief True if the optional contains a value. */
       operator bool() const { return present(); }
@@ -290,8 +588,8 @@ namespace pistis {
        *  @returns  True if this optional and @e other are both empty or
        *            contain values that are equal.
        */
-      template <typename U>
-      bool operator==(const Optional<U>& other) const {
+      template <typename U, typename P>
+      bool operator==(const Optional<U, P>& other) const {
 	if (other.present()) {
 	  return present() && (value_() == other.value());
 	}
@@ -306,8 +604,8 @@ namespace pistis {
        *  @returns  True if this optional and @ other contain different
        *            values or one is empty while the other isn't.
        */
-      template <typename U>
-      bool operator!=(const Optional<U>& other) const {
+      template <typename U, typename P>
+      bool operator!=(const Optional<U, P>& other) const {
 	if (other.present()) {
 	  return empty() || (value_() != other.value());
 	}
@@ -316,79 +614,69 @@ namespace pistis {
 
       /** @brief Copy-assign @e other to this optional
        *
-       *  Because we declare a move-assignment operator, we need to declare
-       *  an explicit copy-assign operator rather than relying on the
-       *  template.
-       *
-       *  @param other  Value to assign
-       *  @returns  <c>*this</c>
-       */
-      Optional& operator=(const Optional& other) {
-	if (&other != this) {
-	  clear();
-	  present_ = other.present();
-	  if (present_) {
-	    new(reinterpret_cast<T*>(data_)) T(other.value());
-	  }
-	}
-	return *this;
-      }
-
-      /** @brief Copy-assign @e other to this optional
+       *  Assigning an Optional of the same type is done by its storage.
        *
        *  @pre  @e U is copy-assignable to @e T
        *  @param other  Value to assign
        *  @returns  <c>*this</c>
        */
-      template <typename U>
-      Optional& operator=(const Optional<U>& other) {
+      template <typename U, typename P>
+      Optional& operator=(const Optional<U, P>& other) {
 	// Self-assignment not possible unless the application works
 	// very hard
 	clear();
-	present_ = other.present();
-	if (present_) {
-	  new(reinterpret_cast<T*>(data_)) T(other.value());
+	if (other.present()) {
+	  this->construct_(other.value());
 	}
 	return *this;
       }
 
-      /** @brief Move-assign @e other to this optional
+      /** @brief Exchange the contents of this optional and @e other
        *
-       *  @e other will be empty after the move.
+       *  Swaps the values with the swap() found by argument-dependent
+       *  lookup if both optionals contain values, and otherwise moves the
+       *  value, if any, into the empty optional.
        *
-       *  @param other  Value to move
-       *  @returns <c>*this</c>
+       *  @param other  Optional to exchange contents with
        */
-      Optional& operator=(Optional&& other) {
-	if (&other != this) {
-	  clear();
-	  present_ = other.present();
-	  if (present_) {
-	    new(reinterpret_cast<T*>(data_)) T(std::move(other.value_()));
-	    other.present_ = false;
+      void swap(Optional& other)
+	  noexcept(std::is_nothrow_move_constructible<T>::value &&
+		   detail::optional_swap::IsNothrowSwappable<T>::value) {
+	if (present()) {
+	  if (other.present()) {
+	    using std::swap;
+	    swap(value_(), other.value_());
+	  } else {
+	    other.moveFrom_(*this);
 	  }
+	} else if (other.present()) {
+	  moveFrom_(other);
 	}
-	return *this;
       }
 
     private:
-      bool present_; ///< True if the value is present
-      alignas(T) uint8_t data_[sizeof(T)]; ///< Object stored here when present
-
       /** @brief Returns the value contained in this optional.
        *
        *  @pre  <c>present()</c> is true.
        */
-      const T& value_() const {
-	return *reinterpret_cast<const T*>(data_);
-      }
+      const T& value_() const { return *this->ptr_(); }
 
       /** @brief Returns the value contained in this optional.
        *
        *  @pre  <c>present()</c> is true.
        */
-      T& value_() { return *reinterpret_cast<T*>(data_); }
+      T& value_() { return *this->ptr_(); }
       
+      /** @brief Move the value of @e other into this optional, leaving
+       *         @e other empty
+       *
+       *  @pre  This optional is empty and @e other is not
+       */
+      void moveFrom_(Optional& other) {
+	this->construct_(std::move(other.value_()));
+	other.clear();
+      }
+
       /** @brief Return an empty optional of this type */
       static const Optional& emptyOptional_() {
 	static const Optional EMPTY;
@@ -412,6 +700,23 @@ namespace pistis {
 
     };
 
+    /** @brief Exchange the contents of @e left and @e right
+     *
+     *  Found by argument-dependent lookup, so
+     *  <c>using std::swap; swap(a, b);</c> calls Optional::swap().
+     */
+    template <typename T, typename P>
+    inline void swap(Optional<T, P>& left, Optional<T, P>& right)
+	noexcept(noexcept(left.swap(right))) {
+      left.swap(right);
+    }
+
+    /** @brief An Optional can be copied by copying its bits if its value
+     *         can be
+     */
+    template <typename T, typename P>
+    struct IsBitCopyable< Optional<T, P> > : public IsBitCopyable<T> { };
+
     template <typename T>
     inline Optional<T> makeOptional(const T& v) { return Optional<T>(v); }
 
@@ -420,8 +725,9 @@ namespace pistis {
       return Optional<T>(std::move(v));
     }
 
-    template <typename T>
-    inline std::ostream& operator<<(std::ostream& out, const Optional<T>& o) {
+    template <typename T, typename P>
+    inline std::ostream& operator<<(std::ostream& out,
+				    const Optional<T, P>& o) {
       if (o.present()) {
 	out << o.value();
       }
@@ -0,0 +1,335 @@
+#ifndef __PISTIS__TYPEUTIL__OPTIONALCOLUMN_HPP__
+#define __PISTIS__TYPEUTIL__OPTIONALCOLUMN_HPP__
+
+#include <pistis/typeutil/Optional.hpp>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pistis {
+  namespace typeutil {
+
+    /** @brief A sequence of optional values, stored as an array of values
+     *         and a bitmap of which values are present
+     *
+     *  Bit <c>i % 64</c> of word <c>i / 64</c> of the bitmap is set if
+     *  entry @e i is present, as in Apache Arrow.  Compared with a
+     *  std::vector of Optional<T>, the column needs one bit rather than
+     *  a padded flag per entry, and the bulk operations work on the
+     *  whole value array in loops the compiler can vectorize, or test
+     *  each 64-entry block's bitmap word as a whole and visit only the
+     *  entries whose bits are set.
+     *
+     *  Absent entries hold T(), so sum() adds up every value without
+     *  looking at the bitmap.  map(), filter() and reduce() call their
+     *  functions on present values only.
+     */
+    template <typename T>
+    class OptionalColumn {
+      static_assert(!std::is_same<T, bool>::value,
+		    "std::vector<bool> has no data(); use uint8_t instead");
+
+    public:
+      typedef T ValueType;
+
+      /** @brief Number of entries covered by one word of the bitmap */
+      enum : size_t { BLOCK_SIZE = 64 };
+
+    public:
+      /** @brief Create an empty column */
+      OptionalColumn(): size_(0) { }
+
+      /** @brief Create a column of @e n absent entries */
+      explicit OptionalColumn(size_t n):
+	  values_(n), validity_(wordsFor_(n), 0), size_(n) {
+      }
+
+      /** @brief Create a column of @e n entries equal to @e v */
+      OptionalColumn(size_t n, const T& v):
+	  values_(n, v), validity_(wordsFor_(n), ~(uint64_t)0), size_(n) {
+	clearUnusedBits_();
+      }
+
+      /** @brief Create a column from a sequence of Optional values */
+      template <typename Iterator,
+		typename = typename std::enable_if<
+		    !std::is_integral<Iterator>::value
+		>::type>
+      OptionalColumn(Iterator begin, Iterator end): size_(0) {
+	for (; begin != end; ++begin) {
+	  push_back(*begin);
+	}
+      }
+
+      /** @brief Number of entries, present or absent */
+      size_t size() const { return size_; }
+
+      bool empty() const { return !size_; }
+
+      /** @brief Number of entries that are present */
+      size_t count() const {
+	size_t n = 0;
+	for (uint64_t word : validity_) {
+	  n += __builtin_popcountll(word);
+	}
+	return n;
+      }
+
+      bool present(size_t i) const {
+	return (validity_[i / BLOCK_SIZE] >> (i % BLOCK_SIZE)) & 1;
+      }
+
+      /** @brief Returns entry @e i
+       *
+       *  @pre  <c>i < size()</c>
+       */
+      Optional<T> operator[](size_t i) const {
+	return present(i) ? Optional<T>(values_[i]) : Optional<T>();
+      }
+
+      /** @brief The values of all entries, with T() for absent ones */
+      const T* values() const { return values_.data(); }
+
+      /** @brief The validity bitmap, of <c>(size() + 63) / 64</c> words */
+      const uint64_t* validity() const { return validity_.data(); }
+
+      /** @brief Make entry @e i present with value @e v */
+      void set(size_t i, const T& v) {
+	values_[i] = v;
+	validity_[i / BLOCK_SIZE] |= bit_(i);
+      }
+
+      /** @brief Make entry @e i absent */
+      void clear(size_t i) {
+	values_[i] = T();
+	validity_[i / BLOCK_SIZE] &= ~bit_(i);
+      }
+
+      void push_back(const T& v) {
+	values_.push_back(v);
+	grow_();
+	validity_.back() |= bit_(size_ - 1);
+      }
+
+      template <typename U, typename P>
+      void push_back(const Optional<U, P>& v) {
+	if (v.present()) {
+	  push_back(v.value());
+	} else {
+	  values_.push_back(T());
+	  grow_();
+	}
+      }
+
+      void reserve(size_t n) {
+	values_.reserve(n);
+	validity_.reserve(wordsFor_(n));
+      }
+
+      /** @brief Returns a column of <c>f(v)</c> for each entry @e v, absent
+       *         where this column is absent
+       *
+       *  @e f is called on the present values only, in order.  Blocks in
+       *  which every entry is present are mapped without testing the
+       *  bitmap.
+       */
+      template <typename Function>
+      auto map(Function f) const ->
+	  OptionalColumn<typename std::decay<
+	      decltype(f(std::declval<const T&>()))
+	  >::type> {
+	typedef typename std::decay<
+	    decltype(f(std::declval<const T&>()))
+	>::type U;
+	OptionalColumn<U> result(size_);
+	result.validity_ = validity_;
+
+	const T* const in = values_.data();
+	U* const out = result.values_.data();
+	forEachBlock_([&](size_t start, size_t n, uint64_t word) {
+	  forEachPresent_(start, n, word, [&](size_t i) {
+	      out[i] = f(in[i]);
+	  });
+	});
+	return result;
+      }
+
+      /** @brief Returns a copy of this column in which the entries whose
+       *         values do not satisfy @e p are absent
+       *
+       *  Like Optional::filter(), the result has the same size as this
+       *  column.  @e p is called on the present values only, in order.
+       */
+      template <typename Predicate>
+      OptionalColumn filter(Predicate p) const {
+	OptionalColumn result(*this);
+	T* const out = result.values_.data();
+	forEachBlock_([&](size_t start, size_t n, uint64_t& word) {
+	  uint64_t keep = 0;
+	  forEachPresent_(start, n, word, [&](size_t i) {
+	      keep |= (uint64_t)(bool)p(out[i]) << (i - start);
+	  });
+	  fillValues_(out + start, word & ~keep, T());
+	  word &= keep;
+	}, result.validity_);
+	return result;
+      }
+
+      /** @brief Returns the value of each entry, or @e defaultValue for
+       *         each absent entry
+       */
+      std::vector<T> valueOr(const T& defaultValue) const {
+	std::vector<T> result(values_);
+	T* const out = result.data();
+	forEachBlock_([&](size_t start, size_t n, uint64_t word) {
+	  fillValues_(out + start, ~word & blockMask_(n), defaultValue);
+	});
+	return result;
+      }
+
+      /** @brief Returns the sum of the present values, or T() if there
+       *         are none
+       *
+       *  Adds the T() of absent entries too.  Values are summed in
+       *  several lanes that are added at the end, so a sum of
+       *  floating-point values may differ in its last bits from one
+       *  computed in order.
+       */
+      T sum() const {
+	enum : size_t { LANES = 8 };
+	T lanes[LANES];
+	for (size_t k = 0; k < LANES; ++k) {
+	  lanes[k] = T();
+	}
+
+	const T* const v = values_.data();
+	size_t i = 0;
+	for (; i + LANES <= size_; i += LANES) {
+	  for (size_t k = 0; k < LANES; ++k) {
+	    lanes[k] += v[i + k];
+	  }
+	}
+	for (; i < size_; ++i) {
+	  lanes[0] += v[i];
+	}
+
+	T total = T();
+	for (size_t k = 0; k < LANES; ++k) {
+	  total += lanes[k];
+	}
+	return total;
+      }
+
+      /** @brief Returns <c>f(...f(f(init, v0), v1)..., vn)</c> over the
+       *         present values, in order
+       *
+       *  Blocks in which every entry is present are folded without
+       *  testing the bitmap, and blocks in which none is are skipped.
+       */
+      template <typename Function>
+      T reduce(T init, Function f) const {
+	const T* const v = values_.data();
+	forEachBlock_([&](size_t start, size_t n, uint64_t word) {
+	  forEachPresent_(start, n, word, [&](size_t i) {
+	      init = f(init, v[i]);
+	  });
+	});
+	return init;
+      }
+
+    private:
+      std::vector<T> values_;
+      std::vector<uint64_t> validity_;
+      size_t size_;
+
+      template <typename> friend class OptionalColumn;
+
+      static size_t wordsFor_(size_t n) {
+	return (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+      }
+
+      static uint64_t bit_(size_t i) {
+	return (uint64_t)1 << (i % BLOCK_SIZE);
+      }
+
+      /** @brief Bits of a word for the first @e n entries it covers */
+      static uint64_t blockMask_(size_t n) {
+	return (n == BLOCK_SIZE) ? ~(uint64_t)0 : bit_(n) - 1;
+      }
+
+      /** @brief Set <c>values[j]</c> to @e v for each bit @e j set in
+       *         @e bits
+       */
+      template <typename U>
+      static void fillValues_(U* values, uint64_t bits, const U& v) {
+	for (; bits; bits &= bits - 1) {
+	  values[__builtin_ctzll(bits)] = v;
+	}
+      }
+
+      /** @brief Account for an entry just appended to values_ */
+      void grow_() {
+	if (!(size_ % BLOCK_SIZE)) {
+	  validity_.push_back(0);
+	}
+	++size_;
+      }
+
+      /** @brief Clear the bits past the last entry, which must be zero
+       *         for count() to be right
+       */
+      void clearUnusedBits_() {
+	if (size_ % BLOCK_SIZE) {
+	  validity_.back() &= bit_(size_) - 1;
+	}
+      }
+
+      /** @brief Call <c>kernel(start, n, word)</c> for each word of
+       *         @e validity, where the word covers the @e n entries
+       *         starting at @e start
+       *
+       *  @e n is BLOCK_SIZE for every word but the last.
+       */
+      template <typename Kernel, typename Validity>
+      void forEachBlock_(Kernel kernel, Validity& validity) const {
+	const size_t fullBlocks = size_ / BLOCK_SIZE;
+	for (size_t b = 0; b < fullBlocks; ++b) {
+	  kernel(b * BLOCK_SIZE, (size_t)BLOCK_SIZE, validity[b]);
+	}
+	if (size_ % BLOCK_SIZE) {
+	  kernel(fullBlocks * BLOCK_SIZE, size_ % BLOCK_SIZE,
+		 validity[fullBlocks]);
+	}
+      }
+
+      template <typename Kernel>
+      void forEachBlock_(Kernel kernel) const {
+	forEachBlock_(kernel, validity_);
+      }
+
+      /** @brief Call <c>visit(i)</c> for each present entry @e i of the
+       *         block of @e n entries starting at @e start, in order
+       *
+       *  @e word is the block's bitmap word.  A full block is visited in
+       *  a plain loop, and any other by scanning the bits that are set.
+       */
+      template <typename Visitor>
+      static void forEachPresent_(size_t start, size_t n, uint64_t word,
+				  Visitor visit) {
+	if ((n == BLOCK_SIZE) && !~word) {
+	  for (size_t j = 0; j < BLOCK_SIZE; ++j) {
+	    visit(start + j);
+	  }
+	} else {
+	  for (; word; word &= word - 1) {
+	    visit(start + __builtin_ctzll(word));
+	  }
+	}
+      }
+    };
+
+  }
+}
+#endif
@@ -0,0 +1,314 @@
+#ifndef __PISTIS__TYPEUTIL__PERFECTHASH_HPP__
+#define __PISTIS__TYPEUTIL__PERFECTHASH_HPP__
+
+#include <pistis/typeutil/StringView.hpp>
+#include <algorithm>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+namespace pistis {
+  namespace typeutil {
+    namespace detail {
+
+      /** @brief 64-bit FNV-1a hash of @e n bytes starting at @e s */
+      inline uint64_t fnv1a64(const char* s, size_t n,
+			      uint64_t basis = 0xcbf29ce484222325ULL) {
+	uint64_t h = basis;
+	for (size_t i = 0; i < n; ++i) {
+	  h = (h ^ (uint8_t)s[i]) * 0x100000001b3ULL;
+	}
+	return h;
+      }
+
+      /** @brief Scramble the bits of @e h (the splitmix64 finalizer) */
+      inline uint64_t mixHash(uint64_t h) {
+	h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+	return h ^ (h >> 31);
+      }
+
+      inline uint64_t load64(const char* p) {
+	uint64_t v;
+	::memcpy(&v, p, sizeof(v));
+	return v;
+      }
+
+      inline uint32_t load32(const char* p) {
+	uint32_t v;
+	::memcpy(&v, p, sizeof(v));
+	return v;
+      }
+
+      /** @brief 64-bit hash of @e n bytes starting at @e s
+       *
+       *  Reads the key a word at a time.  Keys of up to 16 bytes, which
+       *  covers most identifiers, are read with two possibly-overlapping
+       *  loads, so hashing them takes no loop and a single branch on the
+       *  length.
+       */
+      inline uint64_t hashBytes(const char* s, size_t n, uint64_t seed) {
+	const uint64_t K = 0x9e3779b97f4a7c15ULL;
+	uint64_t a;
+	uint64_t b;
+	if (n <= 16) {
+	  if (n >= 8) {
+	    a = load64(s);
+	    b = load64(s + n - 8);
+	  } else if (n >= 4) {
+	    a = load32(s);
+	    b = load32(s + n - 4);
+	  } else if (n) {
+	    a = ((uint64_t)(uint8_t)s[0] << 16) |
+		  ((uint64_t)(uint8_t)s[n >> 1] << 8) | (uint8_t)s[n - 1];
+	    b = 0;
+	  } else {
+	    a = 0;
+	    b = 0;
+	  }
+	} else {
+	  uint64_t h = seed;
+	  for (size_t i = 0; i + 16 < n; i += 16) {
+	    h = mixHash(h ^ load64(s + i) ^ (load64(s + i + 8) * K));
+	  }
+	  a = h ^ load64(s + n - 16);
+	  b = load64(s + n - 8);
+	}
+	return mixHash(mixHash(a ^ seed) ^ (b * K) ^ n);
+      }
+
+      /** @brief Map @e h uniformly onto <c>[0, n)</c> without a division */
+      inline uint32_t reduceHash(uint32_t h, uint32_t n) {
+	return (uint32_t)(((uint64_t)h * n) >> 32);
+      }
+    }
+
+    /** @brief Read-only view of the tables of a PerfectHashIndex
+     *
+     *  The view does not own the tables, so it can look up keys in a
+     *  PerfectHashIndex that was built elsewhere and saved, for example
+     *  in a memory-mapped file.  See PerfectHashIndex::seeds() and
+     *  PerfectHashIndex::slots().
+     */
+    class PerfectHashView {
+    public:
+      enum : uint32_t { NOT_FOUND = ~(uint32_t)0 };
+
+    public:
+      PerfectHashView():
+	  salt_(0), seeds_(nullptr), numSeeds_(0), slots_(nullptr),
+	  numSlots_(0) {
+      }
+
+      PerfectHashView(uint64_t salt, const uint32_t* seeds, size_t numSeeds,
+		      const uint32_t* slots, size_t numSlots):
+	  salt_(salt), seeds_(seeds), numSeeds_((uint32_t)numSeeds),
+	  slots_(slots), numSlots_((uint32_t)numSlots) {
+      }
+
+      /** @brief Number of keys in the index */
+      size_t size() const { return numSlots_; }
+
+      /** @brief Returns the id of the only key that @e s could be,
+       *         or NOT_FOUND if the index is empty.
+       */
+      uint32_t find(const char* s, size_t n) const {
+	if (!numSlots_) {
+	  return NOT_FOUND;
+	}
+	const uint64_t h = hash_(s, n, salt_);
+	const uint32_t seed = seeds_[bucketOf_(h, numSeeds_)];
+	return slots_[slotOf_(h, seed, numSlots_)];
+      }
+
+      uint32_t find(const StringView& s) const {
+	return find(s.data(), s.size());
+      }
+
+    private:
+      uint64_t salt_;
+      const uint32_t* seeds_;
+      uint32_t numSeeds_;
+      const uint32_t* slots_;
+      uint32_t numSlots_;
+
+      static uint64_t hash_(const char* s, size_t n, uint64_t salt) {
+	return detail::hashBytes(s, n, 0xcbf29ce484222325ULL ^ salt);
+      }
+
+      static uint32_t bucketOf_(uint64_t h, uint32_t numBuckets) {
+	return detail::reduceHash((uint32_t)(h >> 32), numBuckets);
+      }
+
+      static uint32_t slotOf_(uint64_t h, uint32_t seed, uint32_t numSlots) {
+	const uint64_t m =
+	    detail::mixHash(h + (uint64_t)seed * 0x9e3779b97f4a7c15ULL);
+	return detail::reduceHash((uint32_t)(m >> 32), numSlots);
+      }
+
+      friend class PerfectHashIndex;
+    };
+
+    /** @brief A minimal perfect hash over a fixed set of strings
+     *
+     *  PerfectHashIndex maps each of the @e n keys it was built from onto
+     *  a distinct slot in <c>[0, n)</c> and stores a caller-supplied id
+     *  in that slot.  It uses the "hash and displace" construction:  keys
+     *  are first grouped into buckets by one half of a 64-bit hash, and
+     *  each bucket then gets a displacement seed that scatters its keys
+     *  into free slots.  A lookup hashes the key once and reads one seed
+     *  and one slot.
+     *
+     *  Like any perfect hash, the index cannot tell whether a string is
+     *  one of its keys, so find() returns a candidate id that the caller
+     *  must confirm by comparing the key it looked up against the key
+     *  with that id.
+     */
+    class PerfectHashIndex {
+    public:
+      enum : uint32_t { NOT_FOUND = ~(uint32_t)0 };
+
+    public:
+      PerfectHashIndex(): salt_(0) { }
+
+      /** @brief Number of keys in the index */
+      size_t size() const { return slots_.size(); }
+
+      /** @brief Build the index
+       *
+       *  @param keys  The keys to index.  Must not contain duplicates.
+       *  @param ids   Id to associate with each key
+       *  @param n     Number of keys
+       */
+      void build(const StringView* keys, const uint32_t* ids, size_t n) {
+	std::vector<uint64_t> hashes(n);
+	std::vector< std::vector<uint32_t> > buckets;
+	std::vector<uint32_t> order;
+	std::vector<bool> occupied;
+	std::vector<uint32_t> candidates;
+
+	const uint32_t numBuckets = (uint32_t)(n / 2 + 1);
+	for (salt_ = 0; ; ++salt_) {
+	  buckets.assign(numBuckets, std::vector<uint32_t>());
+	  for (size_t i = 0; i < n; ++i) {
+	    hashes[i] = hash_(keys[i].data(), keys[i].size());
+	    buckets[bucketOf_(hashes[i], numBuckets)].push_back((uint32_t)i);
+	  }
+
+	  order.resize(numBuckets);
+	  for (uint32_t b = 0; b < numBuckets; ++b) {
+	    order[b] = b;
+	  }
+	  std::stable_sort(order.begin(), order.end(),
+			   [&buckets](uint32_t x, uint32_t y) {
+			     return buckets[x].size() > buckets[y].size();
+			   });
+
+	  seeds_.assign(numBuckets, 0);
+	  slots_.assign(n, NOT_FOUND);
+	  occupied.assign(n, false);
+	  if (placeBuckets_(buckets, order, hashes, ids, occupied,
+			    candidates)) {
+	    return;
+	  }
+	}
+      }
+
+      /** @brief Returns the id of the only key that @e s could be,
+       *         or NOT_FOUND if the index is empty.
+       */
+      uint32_t find(const char* s, size_t n) const {
+	return view().find(s, n);
+      }
+
+      uint32_t find(const StringView& s) const {
+	return find(s.data(), s.size());
+      }
+
+      /** @brief The tables of the index.  Saving these, along with the
+       *         salt, lets a PerfectHashView look up keys without
+       *         rebuilding the index.
+       */
+      uint64_t salt() const { return salt_; }
+      const std::vector<uint32_t>& seeds() const { return seeds_; }
+      const std::vector<uint32_t>& slots() const { return slots_; }
+
+      PerfectHashView view() const {
+	return PerfectHashView(salt_, seeds_.data(), seeds_.size(),
+			       slots_.data(), slots_.size());
+      }
+
+    private:
+      static constexpr uint32_t MAX_SEED = 1 << 20;
+
+      uint64_t salt_;
+      std::vector<uint32_t> seeds_;
+      std::vector<uint32_t> slots_;
+
+      uint64_t hash_(const char* s, size_t n) const {
+	return PerfectHashView::hash_(s, n, salt_);
+      }
+
+      static uint32_t bucketOf_(uint64_t h, uint32_t numBuckets) {
+	return PerfectHashView::bucketOf_(h, numBuckets);
+      }
+
+      static uint32_t slotOf_(uint64_t h, uint32_t seed, uint32_t numSlots) {
+	return PerfectHashView::slotOf_(h, seed, numSlots);
+      }
+
+      bool placeBuckets_(const std::vector< std::vector<uint32_t> >& buckets,
+			 const std::vector<uint32_t>& order,
+			 const std::vector<uint64_t>& hashes,
+			 const uint32_t* ids, std::vector<bool>& occupied,
+			 std::vector<uint32_t>& candidates) {
+	const uint32_t numSlots = (uint32_t)slots_.size();
+	for (uint32_t b : order) {
+	  const std::vector<uint32_t>& keys = buckets[b];
+	  if (keys.empty()) {
+	    return true;
+	  }
+
+	  // Keys with identical hashes can never be separated by a seed.
+	  for (size_t i = 0; i < keys.size(); ++i) {
+	    for (size_t j = i + 1; j < keys.size(); ++j) {
+	      if (hashes[keys[i]] == hashes[keys[j]]) {
+		return false;
+	      }
+	    }
+	  }
+
+	  uint32_t seed = 0;
+	  for (; seed < MAX_SEED; ++seed) {
+	    candidates.clear();
+	    for (uint32_t k : keys) {
+	      const uint32_t slot = slotOf_(hashes[k], seed, numSlots);
+	      if (occupied[slot] ||
+		  (std::find(candidates.begin(), candidates.end(), slot) !=
+		     candidates.end())) {
+		break;
+	      }
+	      candidates.push_back(slot);
+	    }
+	    if (candidates.size() == keys.size()) {
+	      break;
+	    }
+	  }
+	  if (seed == MAX_SEED) {
+	    return false;
+	  }
+
+	  seeds_[b] = seed;
+	  for (size_t i = 0; i < keys.size(); ++i) {
+	    occupied[candidates[i]] = true;
+	    slots_[candidates[i]] = ids[keys[i]];
+	  }
+	}
+	return true;
+      }
+    };
+
+  }
+}
+#endif
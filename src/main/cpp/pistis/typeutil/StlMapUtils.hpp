@@ -4,6 +4,8 @@
 #include <pistis/exceptions/NoSuchItem.hpp>
 #include <functional>
 #include <iterator>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace pistis {
@@ -44,6 +46,13 @@ namespace pistis {
 
       template <typename Map>
       class ConstValueIterator {
+      public:
+	typedef std::forward_iterator_tag iterator_category;
+	typedef typename Map::mapped_type value_type;
+	typedef const typename Map::mapped_type& reference;
+	typedef const typename Map::mapped_type* pointer;
+	typedef std::ptrdiff_t difference_type;
+
       public:
 	ConstValueIterator() : p_() { }
 	ConstValueIterator(const typename Map::const_iterator& p) : p_(p) { }
@@ -69,6 +78,14 @@ namespace pistis {
       
       template <typename Map>
       class ValueIterator {
+      public:
+	typedef std::forward_iterator_tag iterator_category;
+	typedef typename Map::mapped_type value_type;
+	typedef typename Map::mapped_type& reference;
+	typedef typename Map::mapped_type* pointer;
+	typedef std::ptrdiff_t difference_type;
+
+      public:
 	ValueIterator() : p_() { }
 	ValueIterator(const typename Map::iterator& p) : p_(p) { }
 
@@ -137,8 +154,8 @@ namespace pistis {
       const typename Map::mapped_type& get(
 	  const Map& m, const typename Map::key_type& k
       ) {
-	auto i = map.find(k);
-	if (i != map.end()) {
+	auto i = m.find(k);
+	if (i != m.end()) {
 	  return i->second;
 	} else {
 	  throw pistis::exceptions::NoSuchItem("", PISTIS_EX_HERE);
@@ -150,9 +167,9 @@ namespace pistis {
 	  const Map& m, const typename Map::key_type& k,
 	  std::function<std::string (const typename Map::key_type&)> name
       ) {
-	auto i = map.find(k);
-	if (i == map.end()) {
-	  throw pistis::exceptions::NoSuchItem(name(), PISTIS_EX_HERE);
+	auto i = m.find(k);
+	if (i == m.end()) {
+	  throw pistis::exceptions::NoSuchItem(name(k), PISTIS_EX_HERE);
 	}
 	return i->second;
       }
@@ -160,8 +177,8 @@ namespace pistis {
       template <typename Map>
       typename Map::mapped_type& get(Map& m,
 				     const typename Map::key_type& k) {
-	auto i = map.find(k);
-	if (i == map.end()) {
+	auto i = m.find(k);
+	if (i == m.end()) {
 	  throw pistis::exceptions::NoSuchItem("", PISTIS_EX_HERE);
 	}
 	return i->second;
@@ -172,9 +189,9 @@ namespace pistis {
 	  Map& m, const typename Map::key_type& k,
 	  std::function< std::string (const typename Map::key_type&) > name
       ) {
-	auto i = map.find(k);
-	if (i == map.end()) {
-	  throw pistis::exceptions::NoSuchItem(name(), PISTIS_EX_HERE);
+	auto i = m.find(k);
+	if (i == m.end()) {
+	  throw pistis::exceptions::NoSuchItem(name(k), PISTIS_EX_HERE);
 	}
 	return i->second;
       }
@@ -184,31 +201,32 @@ namespace pistis {
 	  const Map& m, const typename Map::key_type& k,
 	  const typename Map::mapped_type& dv
       ) {
-	auto i = map.find(k);
-	return (i != map.end()) ? i->second : dv;
+	auto i = m.find(k);
+	return (i != m.end()) ? i->second : dv;
       }
 
       template <typename Map>
-      Map::mapped_type& get(Map& m, const typename Map::key_type& k,
-			    Map::mapped_type& dv) {
-	auto i = map.find(k);
-	return (i != map.end()) ? i->second : dv;
+      typename Map::mapped_type& get(Map& m,
+				     const typename Map::key_type& k,
+				     typename Map::mapped_type& dv) {
+	auto i = m.find(k);
+	return (i != m.end()) ? i->second : dv;
       }
 
       template <typename Map, typename Function>
       typename Map::mapped_type getOrCall(const Map& m,
 					  const typename Map::key_type& k,
 					  Function f) {
-	auto i = map.find(k);
-	return (i != map.end()) ? i->second : f();
+	auto i = m.find(k);
+	return (i != m.end()) ? i->second : f();
       }
 
       template <typename Map, typename Function>
       typename Map::mapped_type getOrUpdate(Map& m,
-					    const typename Map::mapped_type& k,
+					    const typename Map::key_type& k,
 					    Function f) {
-	auto i = map.find(k);
-	if (i != map.end()) {
+	auto i = m.find(k);
+	if (i != m.end()) {
 	  return i->second;
 	} else {
 	  auto j = m.insert(std::make_pair(k, f()));
@@ -0,0 +1,144 @@
+#ifndef __PISTIS__TYPEUTIL__STRINGVIEW_HPP__
+#define __PISTIS__TYPEUTIL__STRINGVIEW_HPP__
+
+#include <ostream>
+#include <string>
+#include <stddef.h>
+#include <string.h>
+
+namespace pistis {
+  namespace typeutil {
+
+    /** @brief A non-owning reference to a sequence of characters
+     *
+     *  StringView lets functions accept a std::string, a null-terminated
+     *  string or a pointer/length pair (such as a slice of a parse buffer)
+     *  without first copying the characters into a temporary std::string.
+     *  The referenced characters must outlive the view.  Views built from
+     *  string literals can be constructed at compile time.
+     */
+    class StringView {
+    public:
+      typedef char value_type;
+      typedef const char* const_iterator;
+      typedef const char* iterator;
+      typedef size_t size_type;
+
+    public:
+      /** @brief Create an empty view */
+      constexpr StringView(): data_(""), size_(0) { }
+
+      /** @brief Create a view of the @e n characters starting at @e s */
+      constexpr StringView(const char* s, size_t n): data_(s), size_(n) { }
+
+      /** @brief Create a view of the null-terminated string @e s */
+      constexpr StringView(const char* s): data_(s), size_(length_(s)) { }
+
+      /** @brief Create a view of the contents of @e s */
+      StringView(const std::string& s): data_(s.data()), size_(s.size()) { }
+
+      constexpr const char* data() const { return data_; }
+      constexpr size_t size() const { return size_; }
+      constexpr bool empty() const { return !size_; }
+      constexpr const char* begin() const { return data_; }
+      constexpr const char* end() const { return data_ + size_; }
+      constexpr char operator[](size_t i) const { return data_[i]; }
+
+      /** @brief Returns a view of at most @e n characters starting
+       *         at @e pos
+       *
+       *  @pre  <c>pos <= size()</c>
+       */
+      constexpr StringView substr(size_t pos, size_t n = (size_t)-1) const {
+	return StringView(data_ + pos, (n < size_ - pos) ? n : size_ - pos);
+      }
+
+      /** @brief Copy the referenced characters into a std::string */
+      std::string str() const { return std::string(data_, size_); }
+
+      /** @brief Copy the characters into @e buffer, which has room for
+       *         @e n characters, with snprintf() semantics
+       *
+       *  Writes at most <c>n - 1</c> characters followed by a null and
+       *  returns size(), so a result of @e n or more means the copy was
+       *  truncated.  Writes nothing if @e n is zero.
+       */
+      size_t copyTo(char* buffer, size_t n) const {
+	if (n) {
+	  const size_t count = (size_ < n) ? size_ : n - 1;
+	  ::memcpy(buffer, data_, count);
+	  buffer[count] = 0;
+	}
+	return size_;
+      }
+
+      /** @brief Three-way comparison, with the same sign as
+       *         std::string::compare()
+       */
+      constexpr int compare(const StringView& other) const {
+	const size_t n = (size_ < other.size_) ? size_ : other.size_;
+	for (size_t i = 0; i < n; ++i) {
+	  if (data_[i] != other.data_[i]) {
+	    return ((unsigned char)data_[i] < (unsigned char)other.data_[i])
+		     ? -1 : 1;
+	  }
+	}
+	return (size_ < other.size_) ? -1 : (size_ > other.size_) ? 1 : 0;
+      }
+
+      constexpr bool operator==(const StringView& other) const {
+	if (size_ != other.size_) {
+	  return false;
+	}
+	for (size_t i = 0; i < size_; ++i) {
+	  if (data_[i] != other.data_[i]) {
+	    return false;
+	  }
+	}
+	return true;
+      }
+
+      constexpr bool operator!=(const StringView& other) const {
+	return !(*this == other);
+      }
+
+      constexpr bool operator<(const StringView& other) const {
+	return compare(other) < 0;
+      }
+
+    private:
+      const char* data_;
+      size_t size_;
+
+      static constexpr size_t length_(const char* s) {
+	size_t n = 0;
+	while (s[n]) {
+	  ++n;
+	}
+	return n;
+      }
+    };
+
+    inline bool operator==(const char* left, const StringView& right) {
+      return right == left;
+    }
+
+    inline bool operator!=(const char* left, const StringView& right) {
+      return right != left;
+    }
+
+    inline bool operator==(const std::string& left, const StringView& right) {
+      return right == left;
+    }
+
+    inline bool operator!=(const std::string& left, const StringView& right) {
+      return right != left;
+    }
+
+    inline std::ostream& operator<<(std::ostream& out, const StringView& s) {
+      return out.write(s.data(), s.size());
+    }
+
+  }
+}
+#endif
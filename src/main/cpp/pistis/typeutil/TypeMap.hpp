@@ -0,0 +1,301 @@
+#ifndef __PISTIS__TYPEUTIL__TYPEMAP_HPP__
+#define __PISTIS__TYPEUTIL__TYPEMAP_HPP__
+
+#include <pistis/typeutil/NameOf.hpp>
+#include <pistis/typeutil/Optional.hpp>
+#include <pistis/exceptions/IllegalValueError.hpp>
+#include <pistis/exceptions/NoSuchItem.hpp>
+#include <sstream>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace pistis {
+  namespace typeutil {
+
+    /** @brief A hash map from types, identified by their TypeId, to
+     *         values
+     *
+     *  TypeMap suits tables such as message handlers that are looked up
+     *  by the type of the message.  The ids live in one array and the
+     *  values in another, probed linearly from a slot chosen by
+     *  multiplying the id by a constant.  The map is kept at most half
+     *  full, so most lookups compare a single id.  erase() shifts later
+     *  entries back rather than leaving tombstones.
+     */
+    template <typename V>
+    class TypeMap {
+    public:
+      typedef TypeId KeyType;
+      typedef V ValueType;
+
+    public:
+      /** @brief Create an empty map */
+      TypeMap(): mask_(0), shift_(64), size_(0) { }
+
+      /** @brief Number of types in the map */
+      size_t size() const { return size_; }
+
+      bool empty() const { return !size_; }
+
+      bool contains(TypeId id) const { return slotOf_(id) != NOT_FOUND; }
+
+      template <typename T>
+      bool contains() const { return contains(typeId<T>()); }
+
+      /** @brief Returns the value for the type with id @e id, or null if
+       *         that type is not in the map
+       */
+      V* find(TypeId id) {
+	const size_t i = slotOf_(id);
+	return (i == NOT_FOUND) ? nullptr : &values_[i].value();
+      }
+
+      const V* find(TypeId id) const {
+	const size_t i = slotOf_(id);
+	return (i == NOT_FOUND) ? nullptr : &values_[i].value();
+      }
+
+      template <typename T>
+      V* find() { return find(typeId<T>()); }
+
+      template <typename T>
+      const V* find() const { return find(typeId<T>()); }
+
+      /** @brief Returns the value for the type with id @e id
+       *
+       *  @throws NoSuchItem  if that type is not in the map
+       */
+      V& at(TypeId id) {
+	V* v = find(id);
+	if (!v) {
+	  throwMissing_(id);
+	}
+	return *v;
+      }
+
+      const V& at(TypeId id) const {
+	const V* v = find(id);
+	if (!v) {
+	  throwMissing_(id);
+	}
+	return *v;
+      }
+
+      /** @brief Returns the value for type T
+       *
+       *  @throws NoSuchItem  if T is not in the map
+       */
+      template <typename T>
+      V& at() {
+	V* v = find<T>();
+	if (!v) {
+	  throwMissing_<T>();
+	}
+	return *v;
+      }
+
+      template <typename T>
+      const V& at() const {
+	const V* v = find<T>();
+	if (!v) {
+	  throwMissing_<T>();
+	}
+	return *v;
+      }
+
+      /** @brief Returns the value for the type with id @e id, first
+       *         mapping it to a default-constructed value if it is not in
+       *         the map
+       *
+       *  @throws IllegalValueError  if @e id is zero, which typeId()
+       *                             never returns
+       */
+      V& operator[](TypeId id) {
+	V* v = find(id);
+	return v ? *v : add_(checkId_(id), V());
+      }
+
+      /** @brief Map the type with id @e id to @e v if it is not already
+       *         in the map.  Returns true if it was added.
+       *
+       *  @throws IllegalValueError  if @e id is zero
+       */
+      bool insert(TypeId id, const V& v) {
+	if (find(checkId_(id))) {
+	  return false;
+	}
+	add_(id, v);
+	return true;
+      }
+
+      template <typename T>
+      bool insert(const V& v) { return insert(typeId<T>(), v); }
+
+      /** @brief Remove the type with id @e id from the map.  Returns true
+       *         if it was in the map.
+       */
+      bool erase(TypeId id) {
+	size_t hole = slotOf_(id);
+	if (hole == NOT_FOUND) {
+	  return false;
+	}
+
+	// Move back each following entry whose home slot does not lie
+	// between the hole and the entry, so no probe sequence is broken
+	for (size_t i = (hole + 1) & mask_; ids_[i]; i = (i + 1) & mask_) {
+	  const size_t home = homeOf_(ids_[i]);
+	  if (((i - home) & mask_) >= ((i - hole) & mask_)) {
+	    ids_[hole] = ids_[i];
+	    values_[hole] = std::move(values_[i]);
+	    hole = i;
+	  }
+	}
+	ids_[hole] = EMPTY;
+	values_[hole].clear();
+	--size_;
+	return true;
+      }
+
+      template <typename T>
+      bool erase() { return erase(typeId<T>()); }
+
+      /** @brief Remove every type from the map, keeping its capacity */
+      void clear() {
+	for (size_t i = 0; i < ids_.size(); ++i) {
+	  ids_[i] = EMPTY;
+	  values_[i].clear();
+	}
+	size_ = 0;
+      }
+
+      /** @brief Make room for @e n types without rehashing */
+      void reserve(size_t n) {
+	size_t capacity = MIN_CAPACITY;
+	while (capacity * MAX_LOAD_NUMERATOR < n * MAX_LOAD_DENOMINATOR) {
+	  capacity *= 2;
+	}
+	if (capacity > ids_.size()) {
+	  rehash_(capacity);
+	}
+      }
+
+      /** @brief Call <c>f(id, value)</c> for each type in the map, in no
+       *         particular order
+       */
+      template <typename Function>
+      void forEach(Function f) {
+	for (size_t i = 0; i < ids_.size(); ++i) {
+	  if (ids_[i]) {
+	    f(ids_[i], values_[i].value());
+	  }
+	}
+      }
+
+      template <typename Function>
+      void forEach(Function f) const {
+	for (size_t i = 0; i < ids_.size(); ++i) {
+	  if (ids_[i]) {
+	    f(ids_[i], values_[i].value());
+	  }
+	}
+      }
+
+    private:
+      enum : size_t {
+	NOT_FOUND = ~(size_t)0,
+	MIN_CAPACITY = 8,
+	MAX_LOAD_NUMERATOR = 1,
+	MAX_LOAD_DENOMINATOR = 2
+      };
+
+      enum : TypeId { EMPTY = 0 };
+
+      std::vector<TypeId> ids_;  ///< EMPTY for unused slots
+      std::vector< Optional<V> > values_;
+      size_t mask_;
+      unsigned shift_;
+      size_t size_;
+
+      size_t homeOf_(TypeId id) const {
+	return (size_t)((id * 0x9E3779B97F4A7C15ull) >> shift_) & mask_;
+      }
+
+      size_t slotOf_(TypeId id) const {
+	if (!size_) {
+	  return NOT_FOUND;
+	}
+	for (size_t i = homeOf_(id); ids_[i]; i = (i + 1) & mask_) {
+	  if (ids_[i] == id) {
+	    return i;
+	  }
+	}
+	return NOT_FOUND;
+      }
+
+      V& add_(TypeId id, V&& v) {
+	if ((size_ + 1) * MAX_LOAD_DENOMINATOR >
+	      ids_.size() * MAX_LOAD_NUMERATOR) {
+	  rehash_(ids_.empty() ? (size_t)MIN_CAPACITY : ids_.size() * 2);
+	}
+	size_t i = homeOf_(id);
+	while (ids_[i]) {
+	  i = (i + 1) & mask_;
+	}
+	ids_[i] = id;
+	values_[i] = Optional<V>(std::move(v));
+	++size_;
+	return values_[i].value();
+      }
+
+      V& add_(TypeId id, const V& v) { return add_(id, V(v)); }
+
+      void rehash_(size_t capacity) {
+	std::vector<TypeId> oldIds(capacity, (TypeId)EMPTY);
+	std::vector< Optional<V> > oldValues(capacity);
+	oldIds.swap(ids_);
+	oldValues.swap(values_);
+	mask_ = capacity - 1;
+	shift_ = 64 - __builtin_ctzll(capacity);
+	for (size_t j = 0; j < oldIds.size(); ++j) {
+	  if (oldIds[j]) {
+	    size_t i = homeOf_(oldIds[j]);
+	    while (ids_[i]) {
+	      i = (i + 1) & mask_;
+	    }
+	    ids_[i] = oldIds[j];
+	    values_[i] = std::move(oldValues[j]);
+	  }
+	}
+      }
+
+      /** @brief Returns @e id, which must not be EMPTY, the id that
+       *         marks unused slots
+       */
+      static TypeId checkId_(TypeId id) {
+	if (id == EMPTY) {
+	  throw exceptions::IllegalValueError(
+	      "Type id 0 cannot be a key of a TypeMap", PISTIS_EX_HERE
+	  );
+	}
+	return id;
+      }
+
+      static void throwMissing_(TypeId id) {
+	std::ostringstream msg;
+	msg << "Entry for type id " << std::hex << id << " in TypeMap";
+	throw exceptions::NoSuchItem(msg.str(), PISTIS_EX_HERE);
+      }
+
+      template <typename T>
+      static void throwMissing_() {
+	std::ostringstream msg;
+	msg << "Entry for type " << typeName<T>() << " in TypeMap";
+	throw exceptions::NoSuchItem(msg.str(), PISTIS_EX_HERE);
+      }
+    };
+
+  }
+}
+#endif
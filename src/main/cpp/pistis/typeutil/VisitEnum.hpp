@@ -0,0 +1,150 @@
+#ifndef __PISTIS__TYPEUTIL__VISITENUM_HPP__
+#define __PISTIS__TYPEUTIL__VISITENUM_HPP__
+
+#include <pistis/typeutil/LambdaOverload.hpp>
+#include <pistis/typeutil/NameOf.hpp>
+#include <pistis/exceptions/NoSuchItem.hpp>
+#include <sstream>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <stddef.h>
+
+namespace pistis {
+  namespace typeutil {
+
+    /** @brief Type passed to a visitEnum() visitor to identify the member
+     *
+     *  With a ConstexprEnum, the ordinal of a member is a constant
+     *  expression, so a visitor can be written as
+     *  <code>
+     *    overloadLambda(
+     *      [](EnumOrdinal<Color::RED.ordinal()>) { return "stop"; },
+     *      [](EnumOrdinal<Color::GREEN.ordinal()>) { return "go"; },
+     *      [](auto) { return "slow down"; }
+     *    )
+     *  </code>
+     */
+    template <size_t Ordinal>
+    using EnumOrdinal = std::integral_constant<size_t, Ordinal>;
+
+    namespace detail {
+
+      template <typename E, typename = void>
+      struct HasConstexprEnumTable : std::false_type { };
+
+      template <typename E>
+      struct HasConstexprEnumTable<
+	  E, decltype((void)std::integral_constant<size_t, E::TABLE.size()>())
+      > : std::true_type {
+      };
+
+      template <typename R, typename Visitor, size_t Ordinal>
+      R invokeEnumVisitor(Visitor& visitor) {
+	return visitor(EnumOrdinal<Ordinal>());
+      }
+
+      template <typename R, typename Handlers, size_t Ordinal>
+      R invokeEnumHandler(Handlers& handlers) {
+	return std::get<Ordinal>(handlers)();
+      }
+
+      // Both dispatchers call entry "ordinal" of a table of thunks, one
+      // per ordinal, so dispatch is a single indirect call.
+      template <typename R, typename Visitor, size_t... Ordinals>
+      R visitByOrdinal(size_t ordinal, Visitor& visitor,
+		       std::index_sequence<Ordinals...>) {
+	static constexpr R (*TABLE[])(Visitor&) = {
+	  &invokeEnumVisitor<R, Visitor, Ordinals>...
+	};
+	return TABLE[ordinal](visitor);
+      }
+
+      template <typename R, typename Handlers, size_t... Ordinals>
+      R callHandlerByOrdinal(size_t ordinal, Handlers& handlers,
+			     std::index_sequence<Ordinals...>) {
+	static constexpr R (*TABLE[])(Handlers&) = {
+	  &invokeEnumHandler<R, Handlers, Ordinals>...
+	};
+	return TABLE[ordinal](handlers);
+      }
+
+      template <typename E>
+      void throwMissingHandler(const E& e) {
+	std::ostringstream msg;
+	msg << "Handler for member " << e.name() << " of " << typeName<E>();
+	throw exceptions::NoSuchItem(msg.str(), PISTIS_EX_HERE);
+      }
+
+      template <typename E, size_t NUM_HANDLERS,
+		bool IS_CONSTEXPR = HasConstexprEnumTable<E>::value>
+      struct EnumHandlerCount {
+	static void check(const E& e) {
+	  if (__builtin_expect(e.ordinal() >= NUM_HANDLERS, 0)) {
+	    throwMissingHandler(e);
+	  }
+	}
+      };
+
+      template <typename E, size_t NUM_HANDLERS>
+      struct EnumHandlerCount<E, NUM_HANDLERS, true> {
+	static_assert(NUM_HANDLERS == E::TABLE.size(),
+		      "visitEnum() needs exactly one handler per member");
+	static void check(const E&) { }
+      };
+
+    }
+
+    /** @brief Call @e visitor with the EnumOrdinal of @e e
+     *
+     *  Compiles to an indirect call through a table with one entry per
+     *  member, so it takes the place of a switch statement on the
+     *  members of @e E, which must be a ConstexprEnum.  Build the visitor
+     *  with overloadLambda() to handle members separately.  Because the
+     *  visitor is instantiated for every member, leaving a member without
+     *  a matching overload is a compile-time error.
+     *
+     *  @returns  The value returned by the visitor
+     */
+    template <typename E, typename Visitor>
+    auto visitEnum(const E& e, Visitor visitor)
+	-> decltype(visitor(EnumOrdinal<0>())) {
+      static_assert(detail::HasConstexprEnumTable<E>::value,
+		    "A single-visitor visitEnum() needs a ConstexprEnum. "
+		    "Pass one handler per member instead.");
+      typedef decltype(visitor(EnumOrdinal<0>())) ResultType;
+      return detail::visitByOrdinal<ResultType>(
+	  e.ordinal(), visitor, std::make_index_sequence<E::TABLE.size()>()
+      );
+    }
+
+    /** @brief Call the handler for @e e, where the handlers are given
+     *         in ordinal order, one per member.
+     *
+     *  Each handler takes no arguments.  The handlers' results must have
+     *  a common type, which is the result of visitEnum().  When @e E is
+     *  a ConstexprEnum, passing the wrong number of handlers fails to
+     *  compile.  For an Enum, whose members are only known at run time,
+     *  a member without a handler causes a NoSuchItem exception.
+     */
+    template <typename E, typename Handler1, typename Handler2,
+	      typename... Handlers>
+    auto visitEnum(const E& e, Handler1 h1, Handler2 h2, Handlers... h)
+	-> typename std::common_type<decltype(h1()), decltype(h2()),
+				     decltype(h())...>::type {
+      typedef typename std::common_type<
+	  decltype(h1()), decltype(h2()), decltype(h())...
+      >::type ResultType;
+      typedef std::tuple<Handler1, Handler2, Handlers...> HandlerTuple;
+      constexpr size_t NUM_HANDLERS = sizeof...(Handlers) + 2;
+
+      detail::EnumHandlerCount<E, NUM_HANDLERS>::check(e);
+      HandlerTuple handlers(h1, h2, h...);
+      return detail::callHandlerByOrdinal<ResultType>(
+	  e.ordinal(), handlers, std::make_index_sequence<NUM_HANDLERS>()
+      );
+    }
+
+  }
+}
+#endif
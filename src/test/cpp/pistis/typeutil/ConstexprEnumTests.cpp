@@ -0,0 +1,169 @@
+/** @file ConstexprEnumTests.cpp
+ *
+ *  Unit tests for pistis::typeutil::ConstexprEnum
+ */
+
+#include <pistis/typeutil/ConstexprEnum.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <vector>
+
+using namespace pistis::exceptions;
+using namespace pistis::typeutil;
+
+namespace {
+  class Color : public ConstexprEnum<Color> {
+  public:
+    static const Color RED;
+    static const Color GREEN;
+    static const Color BLUE;
+
+    static constexpr auto TABLE = makeConstexprEnumTable<int>({
+      { 3, "RED" }, { 1, "GREEN" }, { 2, "BLUE" }
+    });
+
+  public:
+    constexpr Color(): ConstexprEnum(0) { }
+
+  private:
+    friend class ConstexprEnum<Color>;
+    constexpr Color(uint32_t ordinal): ConstexprEnum(ordinal) { }
+  };
+
+  constexpr decltype(Color::TABLE) Color::TABLE;
+  constexpr Color Color::RED(TABLE.findName("RED"));
+  constexpr Color Color::GREEN(TABLE.findName("GREEN"));
+  constexpr Color Color::BLUE(TABLE.findName("BLUE"));
+
+  class Code : public ConstexprEnum<Code, long> {
+  public:
+    static const Code OK;
+    static const Code NOT_FOUND;
+    static const Code ERROR;
+
+    static constexpr auto TABLE = makeConstexprEnumTable<long>({
+      { 200, "OK" }, { 404, "NOT_FOUND" }, { 500, "ERROR" }
+    });
+
+  private:
+    friend class ConstexprEnum<Code, long>;
+    constexpr Code(uint32_t ordinal): ConstexprEnum(ordinal) { }
+  };
+
+  constexpr decltype(Code::TABLE) Code::TABLE;
+  constexpr Code Code::OK(TABLE.findName("OK"));
+  constexpr Code Code::NOT_FOUND(TABLE.findName("NOT_FOUND"));
+  constexpr Code Code::ERROR(TABLE.findName("ERROR"));
+
+  class Ratio : public ConstexprEnum<Ratio, double> {
+  public:
+    static const Ratio ONE;
+    static const Ratio TWO;
+
+    static constexpr auto TABLE = makeConstexprEnumTable<double>({
+      { 1.0, "ONE" }, { 2.0, "TWO" }
+    });
+
+  private:
+    friend class ConstexprEnum<Ratio, double>;
+    constexpr Ratio(uint32_t ordinal): ConstexprEnum(ordinal) { }
+  };
+
+  constexpr decltype(Ratio::TABLE) Ratio::TABLE;
+  constexpr Ratio Ratio::ONE(TABLE.findName("ONE"));
+  constexpr Ratio Ratio::TWO(TABLE.findName("TWO"));
+
+  // Everything is available at compile time
+  static_assert(Color::GREEN.value() == 1, "Wrong value");
+  static_assert(Color::BLUE.ordinal() == 2, "Wrong ordinal");
+  static_assert(Color::RED.name() == StringView("RED"), "Wrong name");
+  static_assert(Color::TABLE.findName("BLUE") == 2, "Wrong name lookup");
+  static_assert(Color::TABLE.findValue(3) == 0, "Wrong value lookup");
+  static_assert(Code::TABLE.findValue(404) == 1, "Wrong value lookup");
+  static_assert(Code::TABLE.findValue(403) == 3, "Wrong value lookup");
+  static_assert(Color::values().size() == 3, "Wrong size");
+  static_assert(Ratio::TABLE.findValue(1.5) == 2, "Wrong value lookup");
+  static_assert(Color::fromOrdinal(1) == Color::GREEN, "Wrong ordinal");
+}
+
+TEST(ConstexprEnumTests, ValueAndName) {
+  EXPECT_EQ(3, Color::RED.value());
+  EXPECT_EQ(1, Color::GREEN.value());
+  EXPECT_EQ(2, Color::BLUE.value());
+  EXPECT_EQ("RED", Color::RED.name());
+  EXPECT_EQ("GREEN", Color::GREEN.name());
+  EXPECT_EQ("BLUE", Color::BLUE.name());
+  EXPECT_EQ(0, Color::RED.ordinal());
+  EXPECT_EQ(2, Color::BLUE.ordinal());
+}
+
+TEST(ConstexprEnumTests, Comparison) {
+  Color c;
+
+  EXPECT_EQ(Color::RED, c);
+  EXPECT_NE(Color::GREEN, c);
+  EXPECT_TRUE(Color::GREEN < Color::BLUE);
+  EXPECT_TRUE(Color::RED > Color::BLUE);
+  EXPECT_TRUE(Color::RED >= Color::RED);
+  EXPECT_FALSE(Color::RED <= Color::GREEN);
+}
+
+TEST(ConstexprEnumTests, FromValue) {
+  EXPECT_EQ(Color::RED, Color::fromValue(3));
+  EXPECT_EQ(Color::GREEN, Color::fromValue(1));
+  EXPECT_EQ(Color::BLUE, Color::fromValue(2));
+  EXPECT_THROW(Color::fromValue(0), NoSuchItem);
+  EXPECT_THROW(Color::fromValue(4), NoSuchItem);
+
+  EXPECT_EQ(Code::ERROR, Code::fromValue(500));
+  EXPECT_THROW(Code::fromValue(501), NoSuchItem);
+  EXPECT_EQ(makeOptional(Code::OK), Code::tryFromValue(200));
+  EXPECT_TRUE(Code::tryFromValue(0).empty());
+}
+
+TEST(ConstexprEnumTests, FromName) {
+  EXPECT_EQ(Color::RED, Color::fromName("RED"));
+  EXPECT_EQ(Color::GREEN, Color::fromName(std::string("GREEN")));
+  EXPECT_EQ(Color::BLUE, Color::fromName("BLUE,RED", 4));
+  EXPECT_THROW(Color::fromName("PURPLE"), NoSuchItem);
+  EXPECT_EQ(makeOptional(Code::NOT_FOUND), Code::tryFromName("NOT_FOUND"));
+  EXPECT_TRUE(Code::tryFromName("NOT").empty());
+}
+
+TEST(ConstexprEnumTests, Values) {
+  std::vector<Color> values(Color::values().begin(), Color::values().end());
+
+  ASSERT_EQ(3, values.size());
+  EXPECT_EQ(Color::RED, values[0]);
+  EXPECT_EQ(Color::GREEN, values[1]);
+  EXPECT_EQ(Color::BLUE, values[2]);
+  EXPECT_EQ(Color::BLUE, Color::values()[2]);
+}
+
+TEST(ConstexprEnumTests, Print) {
+  std::ostringstream msg;
+  msg << Color::RED << " " << Color::GREEN << " " << Color::BLUE;
+  EXPECT_EQ("RED GREEN BLUE", msg.str());
+}
+
+TEST(ConstexprEnumTests, Format) {
+  char buffer[4];
+  EXPECT_EQ(5, Color::GREEN.formatTo(buffer, sizeof(buffer)));
+  EXPECT_STREQ("GRE", buffer);
+
+  std::string out("color=");
+  Color::BLUE.appendTo(out);
+  EXPECT_EQ("color=BLUE", out);
+}
+
+TEST(ConstexprEnumTests, FromFloatingPointValue) {
+  EXPECT_EQ(Ratio::ONE, Ratio::fromValue(1.0));
+  EXPECT_EQ(Ratio::TWO, Ratio::fromValue(2.0));
+  EXPECT_TRUE(Ratio::tryFromValue(1.5).empty());
+  EXPECT_THROW(Ratio::fromValue(1.5), NoSuchItem);
+}
+
+TEST(ConstexprEnumTests, FromOrdinal) {
+  EXPECT_EQ(Color::BLUE, Color::fromOrdinal(2));
+  EXPECT_THROW(Color::fromOrdinal(3), NoSuchItem);
+}
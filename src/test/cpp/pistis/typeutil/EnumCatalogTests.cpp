@@ -0,0 +1,299 @@
+/** @file EnumCatalogTests.cpp
+ *
+ *  Unit tests for pistis::typeutil::EnumCatalog and
+ *  pistis::typeutil::CatalogEnum
+ */
+
+#include <pistis/typeutil/EnumCatalog.hpp>
+#include <pistis/typeutil/EnumMap.hpp>
+#include <pistis/typeutil/EnumSet.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+
+using namespace pistis::exceptions;
+using namespace pistis::typeutil;
+
+namespace {
+  // Copies a catalog into storage aligned for EnumCatalog
+  class CatalogBuffer {
+  public:
+    CatalogBuffer(const std::string& bytes):
+	words_((bytes.size() + 7) / 8), size_(bytes.size()) {
+      std::copy(bytes.begin(), bytes.end(), (char*)words_.data());
+    }
+
+    char* data() { return (char*)words_.data(); }
+    size_t size() const { return size_; }
+    EnumCatalog catalog() const { return EnumCatalog(words_.data(), size_); }
+
+  private:
+    std::vector<uint64_t> words_;
+    size_t size_;
+  };
+
+  std::string colorCatalog() {
+    EnumCatalogWriter writer;
+    writer.add(3, "RED");
+    writer.add(1, "GREEN");
+    writer.add(2, "BLUE");
+    return writer.build();
+  }
+
+  std::string errorCatalog() {
+    EnumCatalogWriter writer;
+    writer.add(200, "OK");
+    writer.add(404, "NOT_FOUND");
+    writer.add(500, "SERVER_ERROR");
+    writer.add(404, "GONE_AWAY");
+    return writer.build();
+  }
+
+  std::string catalogPath(const std::string& name) {
+    return ::testing::TempDir() + "/EnumCatalogTests-" + name + ".cat";
+  }
+
+  class Color : public CatalogEnum<Color, int> {
+  private:
+    friend class CatalogEnum<Color, int>;
+    Color(uint32_t ordinal): CatalogEnum(ordinal) { }
+  };
+
+  class Status : public CatalogEnum<Status> {
+  private:
+    friend class CatalogEnum<Status>;
+    Status(uint32_t ordinal): CatalogEnum(ordinal) { }
+  };
+
+  class Tiny : public CatalogEnum<Tiny, int8_t> {
+  private:
+    friend class CatalogEnum<Tiny, int8_t>;
+    Tiny(uint32_t ordinal): CatalogEnum(ordinal) { }
+  };
+}
+
+TEST(EnumCatalogTests, ReadConsecutiveValues) {
+  const CatalogBuffer buffer(colorCatalog());
+  const EnumCatalog catalog = buffer.catalog();
+
+  ASSERT_EQ(3, catalog.size());
+  EXPECT_EQ(3, catalog.value(0));
+  EXPECT_EQ("GREEN", catalog.name(1));
+  EXPECT_EQ(1, catalog.minValue());
+  EXPECT_EQ(3, catalog.maxValue());
+
+  EXPECT_EQ(0, catalog.findName("RED"));
+  EXPECT_EQ(2, catalog.findName("BLUE"));
+  EXPECT_EQ(EnumCatalog::NOT_FOUND, catalog.findName("BLU"));
+  EXPECT_EQ(1, catalog.findValue(1));
+  EXPECT_EQ(0, catalog.findValue(3));
+  EXPECT_EQ(EnumCatalog::NOT_FOUND, catalog.findValue(0));
+  EXPECT_EQ(EnumCatalog::NOT_FOUND, catalog.findValue(4));
+}
+
+TEST(EnumCatalogTests, ReadSparseValues) {
+  const CatalogBuffer buffer(errorCatalog());
+  const EnumCatalog catalog = buffer.catalog();
+
+  ASSERT_EQ(4, catalog.size());
+  EXPECT_EQ(0, catalog.findValue(200));
+  EXPECT_EQ(2, catalog.findValue(500));
+  EXPECT_EQ(EnumCatalog::NOT_FOUND, catalog.findValue(403));
+
+  // The lowest ordinal wins when values repeat
+  EXPECT_EQ(1, catalog.findValue(404));
+  EXPECT_EQ(3, catalog.findName("GONE_AWAY"));
+  catalog.verify();
+}
+
+TEST(EnumCatalogTests, EmptyCatalog) {
+  const CatalogBuffer buffer(EnumCatalogWriter().build());
+  const EnumCatalog catalog = buffer.catalog();
+
+  EXPECT_EQ(0, catalog.size());
+  EXPECT_EQ(EnumCatalog::NOT_FOUND, catalog.findName(""));
+  EXPECT_EQ(EnumCatalog::NOT_FOUND, catalog.findValue(0));
+  catalog.verify();
+}
+
+TEST(EnumCatalogTests, ManyMembers) {
+  EnumCatalogWriter writer;
+  for (int i = 0; i < 10000; ++i) {
+    std::ostringstream name;
+    name << "INSTRUMENT_" << i;
+    writer.add(i * 3 - 5000, name.str());
+  }
+  const CatalogBuffer buffer(writer.build());
+  const EnumCatalog catalog = buffer.catalog();
+
+  catalog.verify();
+  for (uint32_t i = 0; i < 10000; ++i) {
+    EXPECT_EQ(i, catalog.findName(catalog.name(i)));
+    EXPECT_EQ(i, catalog.findValue(catalog.value(i)));
+  }
+  EXPECT_EQ(EnumCatalog::NOT_FOUND, catalog.findValue(-4999));
+  EXPECT_EQ(EnumCatalog::NOT_FOUND, catalog.findName("INSTRUMENT_10000"));
+}
+
+TEST(EnumCatalogTests, WriterRejectsDuplicateNames) {
+  EnumCatalogWriter writer;
+  writer.add(1, "A");
+  EXPECT_THROW(writer.add(2, "A"), EnumCatalogError);
+  EXPECT_EQ(1, writer.size());
+}
+
+TEST(EnumCatalogTests, RejectInvalidCatalogs) {
+  const std::string bytes = colorCatalog();
+
+  CatalogBuffer badMagic(bytes);
+  badMagic.data()[0] = 'X';
+  EXPECT_THROW(badMagic.catalog(), EnumCatalogError);
+
+  CatalogBuffer badVersion(bytes);
+  badVersion.data()[8] = 99;
+  EXPECT_THROW(badVersion.catalog(), EnumCatalogError);
+
+  const CatalogBuffer truncated(bytes.substr(0, bytes.size() - 8));
+  EXPECT_THROW(truncated.catalog(), EnumCatalogError);
+
+  const CatalogBuffer tooShort(bytes.substr(0, 16));
+  EXPECT_THROW(tooShort.catalog(), EnumCatalogError);
+}
+
+TEST(EnumCatalogTests, VerifyFindsCorruption) {
+  const std::string bytes = colorCatalog();
+  CatalogBuffer corrupt(bytes);
+  const detail::EnumCatalogHeader* header =
+      (const detail::EnumCatalogHeader*)corrupt.data();
+
+  // Swap the first two entries of the value index
+  uint32_t* byValue = (uint32_t*)(corrupt.data() + header->byValueOffset);
+  std::swap(byValue[0], byValue[1]);
+
+  const EnumCatalog catalog = corrupt.catalog();
+  EXPECT_THROW(catalog.verify(), EnumCatalogError);
+}
+
+TEST(EnumCatalogTests, VerifyFindsCorruptUnusedValueSlot) {
+  // 2 has a slot in the value table, but no member
+  EnumCatalogWriter writer;
+  writer.add(1, "ONE");
+  writer.add(3, "THREE");
+  const std::string bytes = writer.build();
+
+  const CatalogBuffer intact(bytes);
+  ASSERT_EQ(EnumCatalog::NOT_FOUND, intact.catalog().findValue(2));
+  intact.catalog().verify();
+
+  for (uint32_t ordinal : { 0u, 7u }) {
+    CatalogBuffer corrupt(bytes);
+    const detail::EnumCatalogHeader* header =
+	(const detail::EnumCatalogHeader*)corrupt.data();
+    ASSERT_EQ(3, header->valueTableSize);
+    uint32_t* valueTable =
+	(uint32_t*)(corrupt.data() + header->valueTableOffset);
+    valueTable[1] = ordinal;
+
+    const EnumCatalog catalog = corrupt.catalog();
+    EXPECT_THROW(catalog.verify(), EnumCatalogError);
+  }
+}
+
+TEST(EnumCatalogTests, WriteAndOpen) {
+  const std::string path = catalogPath("WriteAndOpen");
+  EnumCatalogWriter writer;
+  writer.add(7, "SEVEN");
+  writer.add(11, "ELEVEN");
+  writer.write(path);
+
+  const EnumCatalog catalog = EnumCatalog::open(path);
+  ::remove(path.c_str());
+
+  ASSERT_EQ(2, catalog.size());
+  EXPECT_EQ(1, catalog.findName("ELEVEN"));
+  EXPECT_EQ("SEVEN", catalog.name(catalog.findValue(7)));
+  catalog.verify();
+}
+
+TEST(EnumCatalogTests, OpenMissingFile) {
+  EXPECT_THROW(EnumCatalog::open(catalogPath("DoesNotExist")),
+	       EnumCatalogError);
+}
+
+TEST(EnumCatalogTests, CatalogEnum) {
+  EXPECT_FALSE(Color::attached());
+  EXPECT_THROW(Color::fromName("RED"), EnumCatalogError);
+
+  const std::string path = catalogPath("CatalogEnum");
+  {
+    EnumCatalogWriter writer;
+    writer.add(3, "RED");
+    writer.add(1, "GREEN");
+    writer.add(2, "BLUE");
+    writer.write(path);
+  }
+  Color::load(path);
+  ::remove(path.c_str());
+  ASSERT_TRUE(Color::attached());
+
+  const Color red = Color::fromName("RED");
+  const Color green = Color::fromValue(1);
+  EXPECT_EQ(3, red.value());
+  EXPECT_EQ("GREEN", green.name());
+  EXPECT_EQ(1, green.ordinal());
+  EXPECT_TRUE(green < red);
+  EXPECT_TRUE(red != green);
+  EXPECT_EQ(red, Color::fromOrdinal(0));
+  EXPECT_THROW(Color::fromOrdinal(3), NoSuchItem);
+
+  EXPECT_THROW(Color::fromName("PURPLE"), NoSuchItem);
+  EXPECT_THROW(Color::fromValue(4), NoSuchItem);
+  EXPECT_EQ(Color::tryFromName("BLUE"), makeOptional(Color::fromValue(2)));
+  EXPECT_TRUE(Color::tryFromName("PURPLE").empty());
+  EXPECT_EQ(Color::tryFromValue(3), makeOptional(red));
+  EXPECT_TRUE(Color::tryFromValue(0).empty());
+
+  std::vector<std::string> names;
+  for (const Color& c : Color::values()) {
+    names.push_back(c.name().str());
+  }
+  EXPECT_EQ(std::vector<std::string>({ "RED", "GREEN", "BLUE" }), names);
+
+  std::ostringstream out;
+  out << red << "," << green;
+  EXPECT_EQ("RED,GREEN", out.str());
+
+  std::string appended;
+  red.appendTo(appended);
+  EXPECT_EQ("RED", appended);
+
+  // The catalog stays attached for good
+  EXPECT_THROW(Color::load(path), EnumCatalogError);
+}
+
+TEST(EnumCatalogTests, CatalogEnumWithContainers) {
+  // Attached catalogs must outlive every member
+  static const CatalogBuffer buffer(errorCatalog());
+  Status::attach(buffer.catalog());
+
+  EnumSet<Status> errors{ Status::fromValue(404), Status::fromValue(500) };
+  EXPECT_EQ(2, errors.size());
+  EXPECT_TRUE(errors.contains(Status::fromName("SERVER_ERROR")));
+  EXPECT_FALSE(errors.contains(Status::fromName("OK")));
+
+  EnumMap<Status, int> counts(0);
+  ++counts[Status::fromName("GONE_AWAY")];
+  EXPECT_EQ(4, counts.size());
+  EXPECT_EQ(1, counts[Status::fromOrdinal(3)]);
+  EXPECT_EQ(Status::fromOrdinal(3), counts.keyAt(3));
+}
+
+TEST(EnumCatalogTests, CatalogEnumValueOutOfRange) {
+  const CatalogBuffer buffer(errorCatalog());
+
+  EXPECT_THROW(Tiny::attach(buffer.catalog()), EnumCatalogError);
+  EXPECT_FALSE(Tiny::attached());
+}
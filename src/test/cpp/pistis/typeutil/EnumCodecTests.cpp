@@ -0,0 +1,271 @@
+/** @file EnumCodecTests.cpp
+ *
+ *  Unit tests for pistis::typeutil::EnumCodec
+ */
+
+#include <pistis/typeutil/EnumCodec.hpp>
+#include <pistis/typeutil/ConstexprEnum.hpp>
+#include <pistis/typeutil/Enum.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <vector>
+
+using namespace pistis::exceptions;
+using namespace pistis::typeutil;
+
+namespace {
+  class Temperature : public Enum<Temperature> {
+  public:
+    static const Temperature FREEZING;
+    static const Temperature COLD;
+    static const Temperature WARM;
+    static const Temperature HOT;
+
+  public:
+    Temperature(): Enum<Temperature>(WARM) { }
+
+  private:
+    Temperature(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const Temperature Temperature::FREEZING(-1000, "FREEZING");
+  const Temperature Temperature::COLD(-5, "COLD");
+  const Temperature Temperature::WARM(20, "WARM");
+  const Temperature Temperature::HOT(40, "HOT");
+
+  // Same names as Temperature, different values
+  class Weather : public Enum<Weather> {
+  public:
+    static const Weather FREEZING;
+    static const Weather COLD;
+    static const Weather WARM;
+    static const Weather HOT;
+
+  private:
+    Weather(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const Weather Weather::FREEZING(0, "FREEZING");
+  const Weather Weather::COLD(1, "COLD");
+  const Weather Weather::WARM(2, "WARM");
+  const Weather Weather::HOT(3, "HOT");
+
+  class Wide : public Enum<Wide> {
+  public:
+    static const std::vector<Wide> ALL;
+
+  public:
+    static std::vector<Wide> create(int n) {
+      std::vector<Wide> members;
+      for (int i = 0; i < n; ++i) {
+	std::ostringstream name;
+	name << "WIDE_" << i;
+	members.push_back(Wide(i, name.str()));
+      }
+      return members;
+    }
+
+  private:
+    Wide(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const std::vector<Wide> Wide::ALL = Wide::create(200);
+
+  class Size : public ConstexprEnum<Size, unsigned> {
+  public:
+    static const Size SMALL;
+    static const Size LARGE;
+
+    static constexpr auto TABLE = makeConstexprEnumTable<unsigned>({
+      { 1, "SMALL" }, { 1u << 20, "LARGE" }
+    });
+
+  private:
+    friend class ConstexprEnum<Size, unsigned>;
+    constexpr Size(uint32_t ordinal): ConstexprEnum(ordinal) { }
+  };
+
+  constexpr decltype(Size::TABLE) Size::TABLE;
+  constexpr Size Size::SMALL(TABLE.findName("SMALL"));
+  constexpr Size Size::LARGE(TABLE.findName("LARGE"));
+
+  class Level : public ConstexprEnum<Level, uint8_t> {
+  public:
+    static const Level LOW;
+    static const Level HIGH;
+
+    static constexpr auto TABLE = makeConstexprEnumTable<uint8_t>({
+      { 1, "LOW" }, { 2, "HIGH" }
+    });
+
+  private:
+    friend class ConstexprEnum<Level, uint8_t>;
+    constexpr Level(uint32_t ordinal): ConstexprEnum(ordinal) { }
+  };
+
+  constexpr decltype(Level::TABLE) Level::TABLE;
+  constexpr Level Level::LOW(TABLE.findName("LOW"));
+  constexpr Level Level::HIGH(TABLE.findName("HIGH"));
+}
+
+TEST(EnumCodecTests, OrdinalRoundTrip) {
+  typedef EnumCodec<Temperature> Codec;
+  const std::vector<Temperature> members = {
+    Temperature::HOT, Temperature::FREEZING, Temperature::WARM,
+    Temperature::HOT
+  };
+  std::vector<uint8_t> buffer;
+  Codec::encodeOrdinal(Temperature::COLD, buffer);
+  Codec::encodeOrdinals(members.data(), members.size(), buffer);
+  EXPECT_EQ(5, buffer.size());
+
+  const uint8_t* p = buffer.data();
+  const uint8_t* end = p + buffer.size();
+  EXPECT_EQ(Temperature::COLD, Codec::decodeOrdinal(p, end));
+
+  std::vector<Temperature> decoded(members.size());
+  Codec::decodeOrdinals(p, end, decoded.data(), decoded.size());
+  EXPECT_EQ(members, decoded);
+  EXPECT_EQ(end, p);
+  EXPECT_THROW(Codec::decodeOrdinal(p, end), EnumCodecError);
+}
+
+TEST(EnumCodecTests, ValueRoundTrip) {
+  typedef EnumCodec<Temperature> Codec;
+  const std::vector<Temperature> members = {
+    Temperature::COLD, Temperature::FREEZING, Temperature::HOT
+  };
+  std::vector<uint8_t> buffer;
+  Codec::encodeValues(members.data(), members.size(), buffer);
+
+  // Zigzag encoding keeps -5 to one byte, while -1000 takes two
+  EXPECT_EQ(4, buffer.size());
+  EXPECT_EQ(9, buffer[0]);
+
+  const uint8_t* p = buffer.data();
+  std::vector<Temperature> decoded(members.size());
+  Codec::decodeValues(p, p + buffer.size(), decoded.data(), decoded.size());
+  EXPECT_EQ(members, decoded);
+
+  buffer.clear();
+  EnumCodec<Size>::encodeValue(Size::LARGE, buffer);
+  EXPECT_EQ(3, buffer.size());
+  p = buffer.data();
+  EXPECT_EQ(Size::LARGE, EnumCodec<Size>::decodeValue(p, p + buffer.size()));
+}
+
+TEST(EnumCodecTests, InvalidInput) {
+  typedef EnumCodec<Temperature> Codec;
+  const uint8_t badOrdinal[] = { 4 };
+  const uint8_t badValue[] = { 2 };
+  const uint8_t truncated[] = { 0x80, 0x80 };
+  const uint8_t tooLong[] = {
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01
+  };
+  const uint8_t* p = badOrdinal;
+
+  EXPECT_THROW(Codec::decodeOrdinal(p, badOrdinal + 1), EnumCodecError);
+  p = badValue;
+  EXPECT_THROW(Codec::decodeValue(p, badValue + 1), EnumCodecError);
+  p = truncated;
+  EXPECT_THROW(Codec::decodeOrdinal(p, truncated + 2), EnumCodecError);
+  p = tooLong;
+  EXPECT_THROW(Codec::decodeOrdinal(p, tooLong + sizeof(tooLong)),
+	       EnumCodecError);
+}
+
+TEST(EnumCodecTests, VarintWithTenBytes) {
+  uint8_t buffer[10];
+  const uint8_t* end = detail::writeVarint(~(uint64_t)0, buffer);
+  const uint8_t* p = buffer;
+  ASSERT_EQ(buffer + 10, end);
+  EXPECT_EQ(~(uint64_t)0, detail::readVarint(p, end));
+  EXPECT_EQ(end, p);
+
+  // The tenth byte may only hold bit 63
+  buffer[9] = 0x02;
+  p = buffer;
+  EXPECT_THROW(detail::readVarint(p, end), EnumCodecError);
+  buffer[9] = 0x7f;
+  p = buffer;
+  EXPECT_THROW(detail::readVarint(p, end), EnumCodecError);
+}
+
+TEST(EnumCodecTests, ValueOutOfRange) {
+  // 257 would be LOW if it were truncated to 8 bits
+  uint8_t buffer[10];
+  const uint8_t* end = detail::writeVarint(257, buffer);
+  const uint8_t* p = buffer;
+  EXPECT_THROW(EnumCodec<Level>::decodeValue(p, end), EnumCodecError);
+
+  // -5 plus 2^32, which is COLD if it were truncated to 32 bits
+  end = detail::writeVarint(
+      detail::toVarintValue((int64_t)-5 + ((int64_t)1 << 32),
+			    std::true_type()),
+      buffer
+  );
+  p = buffer;
+  EXPECT_THROW(EnumCodec<Temperature>::decodeValue(p, end), EnumCodecError);
+
+  end = detail::writeVarint(2, buffer);
+  p = buffer;
+  EXPECT_EQ(Level::HIGH, EnumCodec<Level>::decodeValue(p, end));
+}
+
+TEST(EnumCodecTests, SetRoundTrip) {
+  typedef EnumCodec<Wide> Codec;
+  EnumSet<Wide> s{ Wide::ALL[3], Wide::ALL[64], Wide::ALL[130] };
+  std::vector<uint8_t> buffer;
+  Codec::encodeSet(s, buffer);
+  Codec::encodeSet(EnumSet<Wide>(), buffer);
+  EXPECT_EQ(1 + 3 * 8 + 1, buffer.size());
+
+  const uint8_t* p = buffer.data();
+  const uint8_t* end = p + buffer.size();
+  EXPECT_EQ(s, Codec::decodeSet(p, end));
+  EXPECT_TRUE(Codec::decodeSet(p, end).empty());
+  EXPECT_EQ(end, p);
+
+  // Drops trailing empty words
+  buffer.clear();
+  EnumCodec<Temperature>::encodeSet(EnumSet<Temperature>(), buffer);
+  EXPECT_EQ(std::vector<uint8_t>{ 0 }, buffer);
+}
+
+TEST(EnumCodecTests, SetWithUnknownMembers) {
+  // Bit 4 is past the last member of Temperature
+  const uint8_t data[] = { 1, 0x10, 0, 0, 0, 0, 0, 0, 0 };
+  const uint8_t* p = data;
+  EXPECT_THROW(EnumCodec<Temperature>::decodeSet(p, data + sizeof(data)),
+	       EnumCodecError);
+
+  const uint8_t tooManyWords[] = { 2 };
+  p = tooManyWords;
+  EXPECT_THROW(EnumCodec<Temperature>::decodeSet(p, tooManyWords + 1),
+	       EnumCodecError);
+
+  const uint8_t truncated[] = { 1, 0x01, 0 };
+  p = truncated;
+  EXPECT_THROW(EnumCodec<Temperature>::decodeSet(p, truncated + 3),
+	       EnumCodecError);
+}
+
+TEST(EnumCodecTests, Fingerprint) {
+  EXPECT_EQ(EnumCodec<Temperature>::fingerprint(),
+	    EnumCodec<Temperature>::fingerprint());
+  EXPECT_NE(EnumCodec<Temperature>::fingerprint(),
+	    EnumCodec<Weather>::fingerprint());
+  EXPECT_NE(EnumCodec<Size>::fingerprint(), 0);
+
+  std::vector<uint8_t> buffer;
+  EnumCodec<Temperature>::writeFingerprint(buffer);
+  EnumCodec<Temperature>::encodeOrdinal(Temperature::HOT, buffer);
+  ASSERT_EQ(9, buffer.size());
+
+  const uint8_t* p = buffer.data();
+  const uint8_t* end = p + buffer.size();
+  EXPECT_THROW(EnumCodec<Weather>::checkFingerprint(p, end), EnumCodecError);
+  EXPECT_EQ(buffer.data(), p);
+  EnumCodec<Temperature>::checkFingerprint(p, end);
+  EXPECT_EQ(Temperature::HOT, EnumCodec<Temperature>::decodeOrdinal(p, end));
+}
@@ -0,0 +1,107 @@
+/** @file EnumHashTests.cpp
+ *
+ *  Unit tests for pistis::typeutil::EnumHash
+ */
+
+#include <pistis/typeutil/EnumHash.hpp>
+#include <pistis/typeutil/ConstexprEnum.hpp>
+#include <pistis/typeutil/Enum.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace pistis::typeutil;
+
+namespace {
+  class Planet : public Enum<Planet> {
+  public:
+    static const Planet MERCURY;
+    static const Planet VENUS;
+    static const Planet EARTH;
+
+  public:
+    Planet(): Enum<Planet>(MERCURY) { }
+
+  private:
+    Planet(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const Planet Planet::MERCURY(1, "MERCURY");
+  const Planet Planet::VENUS(2, "VENUS");
+  const Planet Planet::EARTH(3, "EARTH");
+
+  class Moon : public Enum<Moon, InlineEnumImpl<int> > {
+  public:
+    static const Moon LUNA;
+    static const Moon PHOBOS;
+    static const Moon DEIMOS;
+
+  private:
+    Moon(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const Moon Moon::LUNA(3, "LUNA");
+  const Moon Moon::PHOBOS(4, "PHOBOS");
+  const Moon Moon::DEIMOS(5, "DEIMOS");
+
+  class Suit : public ConstexprEnum<Suit> {
+  public:
+    static const Suit CLUBS;
+    static const Suit HEARTS;
+
+    static constexpr auto TABLE = makeConstexprEnumTable<int>({
+      { 1, "CLUBS" }, { 2, "HEARTS" }
+    });
+
+  private:
+    friend class ConstexprEnum<Suit>;
+    constexpr Suit(uint32_t ordinal): ConstexprEnum(ordinal) { }
+  };
+
+  constexpr decltype(Suit::TABLE) Suit::TABLE;
+  constexpr Suit Suit::CLUBS(TABLE.findName("CLUBS"));
+  constexpr Suit Suit::HEARTS(TABLE.findName("HEARTS"));
+}
+
+PISTIS_ENUM_HASH(Planet)
+PISTIS_ENUM_HASH(Moon)
+PISTIS_ENUM_HASH(Suit)
+
+TEST(EnumHashTests, EqualMembersHaveEqualHashes) {
+  const Planet earth(Planet::EARTH);
+
+  EXPECT_EQ(Planet::EARTH.hash(), earth.hash());
+  EXPECT_EQ(Planet::EARTH.hash(), Planet::fromName("EARTH").hash());
+  EXPECT_NE(Planet::EARTH.hash(), Planet::VENUS.hash());
+  EXPECT_EQ(EnumHash<Planet>()(earth), std::hash<Planet>()(Planet::EARTH));
+}
+
+TEST(EnumHashTests, InlineHandlesHashTheOrdinal) {
+  EXPECT_EQ(0, Moon::LUNA.hash());
+  EXPECT_EQ(2, Moon::DEIMOS.hash());
+  EXPECT_EQ(1, std::hash<Moon>()(Moon::PHOBOS));
+}
+
+TEST(EnumHashTests, ConstexprEnumHashesTheOrdinal) {
+  static_assert(Suit::HEARTS.hash() == 1, "Wrong hash");
+  EXPECT_EQ(0, std::hash<Suit>()(Suit::CLUBS));
+}
+
+TEST(EnumHashTests, UnorderedContainers) {
+  std::unordered_map<Planet, std::string> moons;
+  moons[Planet::EARTH] = "LUNA";
+  moons[Planet::MERCURY] = "";
+
+  EXPECT_EQ(2, moons.size());
+  EXPECT_EQ("LUNA", moons.at(Planet::fromValue(3)));
+  EXPECT_EQ(0, moons.count(Planet::VENUS));
+
+  std::unordered_set<Moon> moonsOfMars{ Moon::PHOBOS, Moon::DEIMOS };
+  EXPECT_EQ(1, moonsOfMars.count(Moon::PHOBOS));
+  EXPECT_EQ(0, moonsOfMars.count(Moon::LUNA));
+
+  std::unordered_set<Suit> red{ Suit::HEARTS };
+  EXPECT_EQ(1, red.count(Suit::HEARTS));
+  EXPECT_EQ(0, red.count(Suit::CLUBS));
+}
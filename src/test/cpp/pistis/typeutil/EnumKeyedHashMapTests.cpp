@@ -0,0 +1,156 @@
+/** @file EnumKeyedHashMapTests.cpp
+ *
+ *  Unit tests for pistis::typeutil::EnumKeyedHashMap
+ */
+
+#include <pistis/typeutil/EnumKeyedHashMap.hpp>
+#include <pistis/typeutil/Enum.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace pistis::exceptions;
+using namespace pistis::typeutil;
+
+namespace {
+  class Fruit : public Enum<Fruit> {
+  public:
+    static const Fruit APPLE;
+    static const Fruit BANANA;
+    static const Fruit CHERRY;
+
+  public:
+    Fruit(): Enum<Fruit>(APPLE) { }
+
+  private:
+    Fruit(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const Fruit Fruit::APPLE(10, "APPLE");
+  const Fruit Fruit::BANANA(5, "BANANA");
+  const Fruit Fruit::CHERRY(20, "CHERRY");
+
+  class Part : public Enum<Part> {
+  public:
+    static const std::vector<Part> ALL;
+
+  public:
+    static std::vector<Part> create(int n) {
+      std::vector<Part> parts;
+      for (int i = 0; i < n; ++i) {
+	std::ostringstream name;
+	name << "PART_" << i;
+	parts.push_back(Part(i, name.str()));
+      }
+      return parts;
+    }
+
+  private:
+    Part(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const std::vector<Part> Part::ALL = Part::create(4096);
+}
+
+TEST(EnumKeyedHashMapTests, InsertAndFind) {
+  EnumKeyedHashMap<Fruit, int> m;
+
+  EXPECT_TRUE(m.empty());
+  EXPECT_EQ(nullptr, m.find(Fruit::APPLE));
+
+  EXPECT_TRUE(m.insert(Fruit::BANANA, 7));
+  EXPECT_FALSE(m.insert(Fruit::BANANA, 8));
+  m[Fruit::CHERRY] = 9;
+
+  EXPECT_EQ(2, m.size());
+  EXPECT_FALSE(m.contains(Fruit::APPLE));
+  EXPECT_TRUE(m.contains(Fruit::BANANA));
+  ASSERT_NE(nullptr, m.find(Fruit::BANANA));
+  EXPECT_EQ(7, *m.find(Fruit::BANANA));
+  EXPECT_EQ(9, m.at(Fruit::CHERRY));
+  EXPECT_EQ(0, m[Fruit::APPLE]);
+  EXPECT_EQ(3, m.size());
+}
+
+TEST(EnumKeyedHashMapTests, AtThrowsForMissingMember) {
+  EnumKeyedHashMap<Fruit, std::string> m;
+  m[Fruit::APPLE] = "red";
+
+  EXPECT_EQ("red", m.at(Fruit::APPLE));
+  EXPECT_THROW(m.at(Fruit::CHERRY), NoSuchItem);
+}
+
+TEST(EnumKeyedHashMapTests, EraseAndClear) {
+  EnumKeyedHashMap<Fruit, std::string> m;
+  m[Fruit::APPLE] = "red";
+  m[Fruit::BANANA] = "yellow";
+
+  EXPECT_TRUE(m.erase(Fruit::APPLE));
+  EXPECT_FALSE(m.erase(Fruit::APPLE));
+  EXPECT_FALSE(m.erase(Fruit::CHERRY));
+  EXPECT_EQ(1, m.size());
+  EXPECT_FALSE(m.contains(Fruit::APPLE));
+  EXPECT_EQ("yellow", m.at(Fruit::BANANA));
+
+  m.clear();
+  EXPECT_TRUE(m.empty());
+  EXPECT_FALSE(m.contains(Fruit::BANANA));
+  m[Fruit::CHERRY] = "dark red";
+  EXPECT_EQ("dark red", m.at(Fruit::CHERRY));
+}
+
+TEST(EnumKeyedHashMapTests, ForEach) {
+  EnumKeyedHashMap<Fruit, int> m;
+  m[Fruit::APPLE] = 1;
+  m[Fruit::CHERRY] = 3;
+
+  std::map<std::string, int> seen;
+  m.forEach([&seen](const Fruit& f, int& v) { seen[f.name()] = v++; });
+  EXPECT_EQ((std::map<std::string, int>{ { "APPLE", 1 }, { "CHERRY", 3 } }),
+	    seen);
+  EXPECT_EQ(2, m.at(Fruit::APPLE));
+}
+
+TEST(EnumKeyedHashMapTests, AgreesWithStdMap) {
+  EnumKeyedHashMap<Part, int> m;
+  std::map<Part, int> expected;
+  std::mt19937 rng(1);
+
+  // Inserts outnumber erases, so the map grows and rehashes while
+  // erases shift entries back along long probe sequences
+  for (int i = 0; i < 20000; ++i) {
+    const Part& p = Part::ALL[rng() % 1024];
+    if (rng() % 3) {
+      m[p] = i;
+      expected[p] = i;
+    } else {
+      EXPECT_EQ(expected.erase(p) > 0, m.erase(p));
+    }
+  }
+
+  ASSERT_EQ(expected.size(), m.size());
+  for (const Part& p : Part::ALL) {
+    auto i = expected.find(p);
+    if (i == expected.end()) {
+      EXPECT_FALSE(m.contains(p));
+    } else {
+      EXPECT_EQ(i->second, m.at(p));
+    }
+  }
+}
+
+TEST(EnumKeyedHashMapTests, Reserve) {
+  EnumKeyedHashMap<Part, int> m;
+  m.reserve(3000);
+  for (int i = 0; i < 3000; ++i) {
+    m[Part::ALL[i]] = i;
+  }
+
+  EXPECT_EQ(3000, m.size());
+  EXPECT_EQ(2999, m.at(Part::ALL[2999]));
+  EXPECT_FALSE(m.contains(Part::ALL[3000]));
+}
@@ -0,0 +1,76 @@
+/** @file EnumMapTests.cpp
+ *
+ *  Unit tests for pistis::typeutil::EnumMap
+ */
+
+#include <pistis/typeutil/EnumMap.hpp>
+#include <pistis/typeutil/Enum.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace pistis::typeutil;
+
+namespace {
+  class Fruit : public Enum<Fruit> {
+  public:
+    static const Fruit APPLE;
+    static const Fruit BANANA;
+    static const Fruit CHERRY;
+
+  public:
+    Fruit(): Enum<Fruit>(APPLE) { }
+
+  private:
+    Fruit(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const Fruit Fruit::APPLE(10, "APPLE");
+  const Fruit Fruit::BANANA(5, "BANANA");
+  const Fruit Fruit::CHERRY(20, "CHERRY");
+}
+
+TEST(EnumMapTests, Ordinals) {
+  EXPECT_EQ(0, Fruit::APPLE.ordinal());
+  EXPECT_EQ(1, Fruit::BANANA.ordinal());
+  EXPECT_EQ(2, Fruit::CHERRY.ordinal());
+  EXPECT_EQ(Fruit::BANANA, Fruit::fromOrdinal(1));
+}
+
+TEST(EnumMapTests, CreateAndAccess) {
+  EnumMap<Fruit, int> m(-1);
+
+  ASSERT_EQ(3, m.size());
+  EXPECT_EQ(-1, m[Fruit::APPLE]);
+  EXPECT_EQ(-1, m[Fruit::CHERRY]);
+
+  m[Fruit::BANANA] = 7;
+  m.at(Fruit::CHERRY) = 9;
+  EXPECT_EQ(-1, m[Fruit::APPLE]);
+  EXPECT_EQ(7, m.at(Fruit::BANANA));
+  EXPECT_EQ(9, m[Fruit::CHERRY]);
+  EXPECT_EQ(std::vector<int>({ -1, 7, 9 }),
+	    std::vector<int>(m.begin(), m.end()));
+}
+
+TEST(EnumMapTests, ForEach) {
+  EnumMap<Fruit, std::string> m;
+  m.forEach([](const Fruit& f, std::string& v) { v = f.name() + "!"; });
+
+  std::vector<std::string> seen;
+  m.forEach([&seen](const Fruit&, const std::string& v) {
+      seen.push_back(v);
+  });
+  EXPECT_EQ(std::vector<std::string>({ "APPLE!", "BANANA!", "CHERRY!" }),
+	    seen);
+  EXPECT_EQ(Fruit::CHERRY, m.keyAt(2));
+}
+
+TEST(EnumMapTests, FillAndCompare) {
+  EnumMap<Fruit, int> m1;
+  EnumMap<Fruit, int> m2(3);
+
+  EXPECT_NE(m1, m2);
+  m1.fill(3);
+  EXPECT_EQ(m1, m2);
+}
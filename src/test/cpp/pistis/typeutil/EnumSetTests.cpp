@@ -0,0 +1,101 @@
+/** @file EnumSetTests.cpp
+ *
+ *  Unit tests for pistis::typeutil::EnumSet
+ */
+
+#include <pistis/typeutil/EnumSet.hpp>
+#include <pistis/typeutil/ConstexprEnum.hpp>
+#include <pistis/typeutil/Enum.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <vector>
+
+using namespace pistis::typeutil;
+
+namespace {
+  class Day : public ConstexprEnum<Day> {
+  public:
+    static const Day MON;
+    static const Day TUE;
+    static const Day WED;
+
+    static constexpr auto TABLE = makeConstexprEnumTable<int>({
+      { 1, "MON" }, { 2, "TUE" }, { 3, "WED" }
+    });
+
+  private:
+    friend class ConstexprEnum<Day>;
+    constexpr Day(uint32_t ordinal): ConstexprEnum(ordinal) { }
+  };
+
+  constexpr decltype(Day::TABLE) Day::TABLE;
+  constexpr Day Day::MON(TABLE.findName("MON"));
+  constexpr Day Day::TUE(TABLE.findName("TUE"));
+  constexpr Day Day::WED(TABLE.findName("WED"));
+
+  // An enumeration large enough to need several words
+  class Code : public Enum<Code> {
+  public:
+    static const std::vector<Code> ALL;
+
+  public:
+    Code(): Enum<Code>(ALL[0]) { }
+
+    static std::vector<Code> create(int n) {
+      std::vector<Code> codes;
+      for (int i = 0; i < n; ++i) {
+	std::ostringstream name;
+	name << "C" << i;
+	codes.push_back(Code(i, name.str()));
+      }
+      return codes;
+    }
+
+  private:
+    Code(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const std::vector<Code> Code::ALL = Code::create(150);
+}
+
+TEST(EnumSetTests, InsertEraseContains) {
+  EnumSet<Day> s;
+
+  EXPECT_TRUE(s.empty());
+  EXPECT_EQ(0, s.size());
+  EXPECT_TRUE(s.insert(Day::TUE));
+  EXPECT_FALSE(s.insert(Day::TUE));
+  EXPECT_FALSE(s.empty());
+  EXPECT_EQ(1, s.size());
+  EXPECT_TRUE(s.contains(Day::TUE));
+  EXPECT_FALSE(s.contains(Day::MON));
+
+  EXPECT_FALSE(s.erase(Day::MON));
+  EXPECT_TRUE(s.erase(Day::TUE));
+  EXPECT_TRUE(s.empty());
+}
+
+TEST(EnumSetTests, Iterate) {
+  EnumSet<Day> s{ Day::WED, Day::MON };
+
+  EXPECT_EQ(std::vector<Day>({ Day::MON, Day::WED }),
+	    std::vector<Day>(s.begin(), s.end()));
+  EXPECT_EQ(EnumSet<Day>({ Day::MON, Day::TUE, Day::WED }),
+	    EnumSet<Day>::all());
+}
+
+TEST(EnumSetTests, MultipleWords) {
+  EnumSet<Code> s{ Code::ALL[0], Code::ALL[63], Code::ALL[64],
+		   Code::ALL[149] };
+
+  EXPECT_EQ(3, s.words().size());
+  EXPECT_EQ(4, s.size());
+  EXPECT_EQ(std::vector<Code>({ Code::ALL[0], Code::ALL[63], Code::ALL[64],
+				Code::ALL[149] }),
+	    std::vector<Code>(s.begin(), s.end()));
+  EXPECT_EQ(150, EnumSet<Code>::all().size());
+
+  s.clear();
+  EXPECT_TRUE(s.empty());
+  EXPECT_EQ(s.begin(), s.end());
+}
@@ -5,7 +5,11 @@
 
 #include <pistis/typeutil/Enum.hpp>
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
 #include <sstream>
+#include <thread>
+#include <type_traits>
 
 using namespace pistis::exceptions;
 using namespace pistis::typeutil;
@@ -41,6 +45,17 @@ TEST(EnumTests, Name) {
   EXPECT_EQ(TestEnum::ONE.name(), "ONE");
   EXPECT_EQ(TestEnum::TWO.name(), "TWO");
   EXPECT_EQ(TestEnum::THREE.name(), "THREE");
+
+  const std::string& ref = TestEnum::TWO.name();
+  const std::string copy = TestEnum::TWO.name();
+  EXPECT_EQ(&ref, &TestEnum::TWO.name());
+  EXPECT_EQ("TWO", copy);
+}
+
+TEST(EnumTests, NameView) {
+  EXPECT_EQ(StringView("ONE"), TestEnum::ONE.nameView());
+  EXPECT_EQ(StringView(TestEnum::TWO.name()), TestEnum::TWO.nameView());
+  EXPECT_EQ('\0', TestEnum::TWO.nameView().data()[3]);
 }
 
 TEST(EnumTests, Equality) {
@@ -93,6 +108,123 @@ TEST(EnumTests, FromValue) {
   EXPECT_THROW(TestEnum::fromValue(4), NoSuchItem);
 }
 
+namespace {
+  class GappedEnum : public Enum<GappedEnum> {
+  public:
+    static const GappedEnum MINUS_TWO;
+    static const GappedEnum ZERO;
+    static const GappedEnum FIVE;
+
+  public:
+    GappedEnum(): Enum<GappedEnum>(ZERO) { }
+
+    static bool hasDenseValueIndex() {
+      return _getMembers()->hasDenseValueIndex();
+    }
+
+  private:
+    GappedEnum(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const GappedEnum GappedEnum::MINUS_TWO(-2, "MINUS_TWO");
+  const GappedEnum GappedEnum::ZERO(0, "ZERO");
+  const GappedEnum GappedEnum::FIVE(5, "FIVE");
+
+  class SparseEnum : public Enum<SparseEnum> {
+  public:
+    static const SparseEnum SMALL;
+    static const SparseEnum LARGE;
+    static const SparseEnum NEGATIVE;
+
+  public:
+    SparseEnum(): Enum<SparseEnum>(SMALL) { }
+
+    static bool hasDenseValueIndex() {
+      return _getMembers()->hasDenseValueIndex();
+    }
+
+  private:
+    SparseEnum(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const SparseEnum SparseEnum::SMALL(1, "SMALL");
+  const SparseEnum SparseEnum::LARGE(1000000, "LARGE");
+  const SparseEnum SparseEnum::NEGATIVE(-1000000, "NEGATIVE");
+}
+
+TEST(EnumTests, FromValueWithDenseIndex) {
+  ASSERT_TRUE(GappedEnum::hasDenseValueIndex());
+  EXPECT_EQ(GappedEnum::fromValue(-2), GappedEnum::MINUS_TWO);
+  EXPECT_EQ(GappedEnum::fromValue(0), GappedEnum::ZERO);
+  EXPECT_EQ(GappedEnum::fromValue(5), GappedEnum::FIVE);
+  EXPECT_THROW(GappedEnum::fromValue(-3), NoSuchItem);
+  EXPECT_THROW(GappedEnum::fromValue(1), NoSuchItem);
+  EXPECT_THROW(GappedEnum::fromValue(6), NoSuchItem);
+  EXPECT_THROW(GappedEnum::fromValue(1 << 30), NoSuchItem);
+}
+
+TEST(EnumTests, FromValueWithSparseIndex) {
+  ASSERT_FALSE(SparseEnum::hasDenseValueIndex());
+  EXPECT_EQ(SparseEnum::fromValue(1), SparseEnum::SMALL);
+  EXPECT_EQ(SparseEnum::fromValue(1000000), SparseEnum::LARGE);
+  EXPECT_EQ(SparseEnum::fromValue(-1000000), SparseEnum::NEGATIVE);
+  EXPECT_THROW(SparseEnum::fromValue(2), NoSuchItem);
+}
+
+namespace {
+  class GrowingEnum : public Enum<GrowingEnum> {
+  public:
+    static const GrowingEnum ZERO;
+
+  public:
+    GrowingEnum(): Enum<GrowingEnum>(ZERO) { }
+
+    static GrowingEnum create(int value) {
+      std::ostringstream name;
+      name << "VALUE_" << value;
+      return GrowingEnum(value, name.str());
+    }
+
+    static bool hasDenseValueIndex() {
+      return _getMembers()->hasDenseValueIndex();
+    }
+
+  private:
+    GrowingEnum(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const GrowingEnum GrowingEnum::ZERO(0, "ZERO");
+}
+
+TEST(EnumTests, FromValueAsTheValueRangeGrows) {
+  // Each member moves the bottom of the range down
+  std::vector<GrowingEnum> members;
+  for (int i= 1; i < 1000; ++i) {
+    members.push_back(GrowingEnum::create(-i));
+  }
+  ASSERT_TRUE(GrowingEnum::hasDenseValueIndex());
+  EXPECT_EQ(GrowingEnum::ZERO, GrowingEnum::fromValue(0));
+  for (int i= 1; i < 1000; ++i) {
+    EXPECT_EQ(members[i - 1], GrowingEnum::fromValue(-i));
+  }
+
+  // Too wide for a table until enough members fill it in
+  const GrowingEnum far= GrowingEnum::create(5000);
+  EXPECT_FALSE(GrowingEnum::hasDenseValueIndex());
+  EXPECT_EQ(far, GrowingEnum::fromValue(5000));
+  EXPECT_EQ(members[499], GrowingEnum::fromValue(-500));
+
+  for (int i= 1; i < 1000; ++i) {
+    members.push_back(GrowingEnum::create(i));
+  }
+  ASSERT_TRUE(GrowingEnum::hasDenseValueIndex());
+  EXPECT_EQ(far, GrowingEnum::fromValue(5000));
+  EXPECT_EQ(members[1498], GrowingEnum::fromValue(500));
+  EXPECT_EQ(members[499], GrowingEnum::fromValue(-500));
+  EXPECT_THROW(GrowingEnum::fromValue(1000), NoSuchItem);
+  EXPECT_THROW(GrowingEnum::fromValue(-1000), NoSuchItem);
+}
+
 TEST(EnumTests, FromName) {
   EXPECT_EQ(TestEnum::fromName("ONE"), TestEnum::ONE);
   EXPECT_EQ(TestEnum::fromName("TWO"), TestEnum::TWO);
@@ -100,6 +232,345 @@ TEST(EnumTests, FromName) {
   EXPECT_THROW(TestEnum::fromName("FOUR"), NoSuchItem);
 }
 
+TEST(EnumTests, FromNameWithoutString) {
+  static const char BUFFER[]= "TWO,THREE";
+
+  EXPECT_EQ(TestEnum::fromName(std::string("ONE")), TestEnum::ONE);
+  EXPECT_EQ(TestEnum::fromName(BUFFER, 3), TestEnum::TWO);
+  EXPECT_EQ(TestEnum::fromName(StringView(BUFFER + 4, 5)), TestEnum::THREE);
+  EXPECT_THROW(TestEnum::fromName(BUFFER, 2), NoSuchItem);
+  EXPECT_THROW(TestEnum::fromName(BUFFER, 4), NoSuchItem);
+  EXPECT_THROW(TestEnum::fromName(""), NoSuchItem);
+}
+
+TEST(EnumTests, TryFromValue) {
+  EXPECT_EQ(TestEnum::tryFromValue(2), makeOptional(TestEnum::TWO));
+  EXPECT_TRUE(TestEnum::tryFromValue(4).empty());
+  EXPECT_EQ(SparseEnum::tryFromValue(1000000), makeOptional(SparseEnum::LARGE));
+  EXPECT_TRUE(SparseEnum::tryFromValue(999999).empty());
+}
+
+TEST(EnumTests, TryFromName) {
+  EXPECT_EQ(TestEnum::tryFromName("THREE"), makeOptional(TestEnum::THREE));
+  EXPECT_EQ(TestEnum::tryFromName("ONE,TWO", 3), makeOptional(TestEnum::ONE));
+  EXPECT_TRUE(TestEnum::tryFromName("FOUR").empty());
+  EXPECT_TRUE(TestEnum::tryFromName("ONE,TWO", 4).empty());
+}
+
+TEST(EnumTests, TryFromNameIgnoringCase) {
+  EXPECT_EQ(TestEnum::tryFromNameIgnoringCase("three"),
+	    makeOptional(TestEnum::THREE));
+  EXPECT_EQ(TestEnum::tryFromNameIgnoringCase("One"),
+	    makeOptional(TestEnum::ONE));
+  EXPECT_TRUE(TestEnum::tryFromNameIgnoringCase("TW").empty());
+  EXPECT_TRUE(TestEnum::tryFromNameIgnoringCase("four").empty());
+}
+
+TEST(EnumTests, TryFromPrefix) {
+  EXPECT_EQ(TestEnum::tryFromPrefix("o"), makeOptional(TestEnum::ONE));
+  EXPECT_EQ(TestEnum::tryFromPrefix("th"), makeOptional(TestEnum::THREE));
+  EXPECT_EQ(TestEnum::tryFromPrefix("Two"), makeOptional(TestEnum::TWO));
+
+  // "T" begins both TWO and THREE
+  EXPECT_TRUE(TestEnum::tryFromPrefix("T").empty());
+  EXPECT_TRUE(TestEnum::tryFromPrefix("F").empty());
+  EXPECT_TRUE(TestEnum::tryFromPrefix("ONES").empty());
+}
+
+TEST(EnumTests, TryFromLongestPrefix) {
+  EXPECT_EQ(TestEnum::tryFromLongestPrefix("two-thirds"),
+	    makeOptional(TestEnum::TWO));
+  EXPECT_EQ(TestEnum::tryFromLongestPrefix("ONE"),
+	    makeOptional(TestEnum::ONE));
+  EXPECT_TRUE(TestEnum::tryFromLongestPrefix("TH").empty());
+}
+
+namespace {
+  class LogLevel : public Enum<LogLevel> {
+  public:
+    static const LogLevel IN;
+    static const LogLevel INFO;
+    static const LogLevel INFORMATIONAL;
+    static const LogLevel WARN;
+
+  public:
+    LogLevel(): Enum<LogLevel>(IN) { }
+
+  private:
+    LogLevel(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const LogLevel LogLevel::IN(0, "IN");
+  const LogLevel LogLevel::INFO(1, "INFO");
+  const LogLevel LogLevel::INFORMATIONAL(2, "INFORMATIONAL");
+  const LogLevel LogLevel::WARN(3, "WARN");
+}
+
+TEST(EnumTests, MatchName) {
+  EnumNameMatch<LogLevel> m = LogLevel::matchName("in");
+  EXPECT_EQ(m.exact, makeOptional(LogLevel::IN));
+  EXPECT_TRUE(m.uniquePrefix.empty());
+  EXPECT_EQ(m.longestPrefix, makeOptional(LogLevel::IN));
+  EXPECT_EQ(2, m.longestPrefixLength);
+
+  m = LogLevel::matchName("Inform");
+  EXPECT_TRUE(m.exact.empty());
+  EXPECT_EQ(m.uniquePrefix, makeOptional(LogLevel::INFORMATIONAL));
+  EXPECT_EQ(m.longestPrefix, makeOptional(LogLevel::INFO));
+  EXPECT_EQ(4, m.longestPrefixLength);
+
+  m = LogLevel::matchName("error");
+  EXPECT_TRUE(m.exact.empty());
+  EXPECT_TRUE(m.uniquePrefix.empty());
+  EXPECT_TRUE(m.longestPrefix.empty());
+  EXPECT_EQ(0, m.longestPrefixLength);
+
+  // An exact match wins over a longer name with the same prefix
+  EXPECT_EQ(LogLevel::tryFromPrefix("IN"), makeOptional(LogLevel::IN));
+  EXPECT_EQ(LogLevel::tryFromPrefix("w"), makeOptional(LogLevel::WARN));
+  EXPECT_TRUE(LogLevel::tryFromPrefix("INF").empty());
+}
+
+TEST(EnumTests, DecodeNames) {
+  typedef BasicEnumMemberData<TestEnum, BasicEnumImpl<int> > MemberData;
+
+  // More than 64 rows, so the invalid-row bitmap spans two words
+  std::vector<StringView> names;
+  for (int i= 0; i < 70; ++i) {
+    names.push_back((i % 7) ? "TWO" : "SEVEN");
+  }
+  names[65]= StringView("THREE,", 5);
+  names[66]= "";
+  names[67]= "TWOS";
+
+  std::vector<uint32_t> ordinals(names.size());
+  uint64_t invalid[2]= { 0, 0 };
+  EXPECT_EQ(12, TestEnum::decodeNames(names.data(), names.size(),
+				      ordinals.data(), invalid));
+  for (size_t i= 0; i < names.size(); ++i) {
+    const bool bad= (i % 7 == 0) || (i == 66) || (i == 67);
+    EXPECT_EQ(bad, (bool)((invalid[i / 64] >> (i % 64)) & 1));
+    if (bad) {
+      EXPECT_EQ(MemberData::NO_MEMBER, ordinals[i]);
+    } else if (i == 65) {
+      EXPECT_EQ(TestEnum::THREE.ordinal(), ordinals[i]);
+    } else {
+      EXPECT_EQ(TestEnum::TWO.ordinal(), ordinals[i]);
+    }
+  }
+
+  std::vector<TestEnum> members(names.size(), TestEnum::ONE);
+  EXPECT_EQ(12, TestEnum::decodeNames(names.data(), names.size(),
+				      members.data(), nullptr));
+  EXPECT_EQ(TestEnum::ONE, members[0]);
+  EXPECT_EQ(TestEnum::TWO, members[1]);
+  EXPECT_EQ(TestEnum::THREE, members[65]);
+  EXPECT_EQ(TestEnum::ONE, members[66]);
+}
+
+TEST(EnumTests, DecodeNamesFromBuffer) {
+  const char data[]= "ONEFOURTHREETWO";
+  const uint32_t offsets[]= { 0, 3, 7, 12, 15 };
+  uint32_t ordinals[4];
+  uint64_t invalid= 0;
+
+  EXPECT_EQ(1, TestEnum::decodeNames(data, offsets, 4, ordinals, &invalid));
+  EXPECT_EQ(0x2, invalid);
+  EXPECT_EQ(TestEnum::ONE.ordinal(), ordinals[0]);
+  EXPECT_EQ(TestEnum::THREE.ordinal(), ordinals[2]);
+  EXPECT_EQ(TestEnum::TWO.ordinal(), ordinals[3]);
+}
+
+TEST(EnumTests, DecodeValues) {
+  const int gapped[]= { 5, -2, 1, 0, 6, -3 };
+  uint32_t ordinals[6];
+  uint64_t invalid= 0;
+
+  EXPECT_EQ(3, GappedEnum::decodeValues(gapped, 6, ordinals, &invalid));
+  EXPECT_EQ(0x34, invalid);
+  EXPECT_EQ(GappedEnum::FIVE.ordinal(), ordinals[0]);
+  EXPECT_EQ(GappedEnum::MINUS_TWO.ordinal(), ordinals[1]);
+  EXPECT_EQ(GappedEnum::ZERO.ordinal(), ordinals[3]);
+
+  const int sparse[]= { 1000000, 2, -1000000 };
+  std::vector<SparseEnum> members(3);
+  EXPECT_EQ(1, SparseEnum::decodeValues(sparse, 3, members.data(), &invalid));
+  EXPECT_EQ(0x2, invalid);
+  EXPECT_EQ(SparseEnum::LARGE, members[0]);
+  EXPECT_EQ(SparseEnum::SMALL, members[1]);
+  EXPECT_EQ(SparseEnum::NEGATIVE, members[2]);
+}
+
+namespace {
+  class LongNameEnum : public Enum<LongNameEnum> {
+  public:
+    static const std::vector<LongNameEnum> ALL;
+
+  public:
+    LongNameEnum(): Enum<LongNameEnum>(ALL[0]) { }
+
+    static std::string nameFor(int i) {
+      std::ostringstream name;
+      name << "A_MEMBER_NAME_TOO_LONG_FOR_THE_SMALL_STRING_BUFFER_" << i;
+      return name.str();
+    }
+
+    static std::vector<LongNameEnum> create(int n) {
+      std::vector<LongNameEnum> members;
+      for (int i= 0; i < n; ++i) {
+	members.push_back(LongNameEnum(i * 7, nameFor(i)));
+      }
+      return members;
+    }
+
+  private:
+    LongNameEnum(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const std::vector<LongNameEnum> LongNameEnum::ALL= LongNameEnum::create(500);
+}
+
+namespace {
+  // Tearing down an enumeration only frees the chunks of its arena
+  static_assert(std::is_trivially_destructible< BasicEnumImpl<int> >::value,
+		"BasicEnumImpl has a destructor");
+  static_assert(
+      std::is_trivially_destructible< InlineEnumImpl<int> >::value,
+      "InlineEnumImpl has a destructor"
+  );
+}
+
+TEST(EnumTests, ManyMembersWithLongNames) {
+  ASSERT_EQ(500, LongNameEnum::values().size());
+  for (int i= 0; i < 500; ++i) {
+    const LongNameEnum& e= LongNameEnum::ALL[i];
+    EXPECT_EQ(LongNameEnum::nameFor(i), e.name());
+    EXPECT_EQ(i * 7, e.value());
+    EXPECT_EQ(e, LongNameEnum::fromName(LongNameEnum::nameFor(i)));
+    EXPECT_EQ(e, LongNameEnum::fromValue(i * 7));
+  }
+}
+
+namespace {
+  class LateEnum : public Enum<LateEnum> {
+  public:
+    static const LateEnum FIRST;
+    static const LateEnum SECOND;
+
+  public:
+    LateEnum(): Enum<LateEnum>(FIRST) { }
+
+    static LateEnum create(int value) {
+      std::ostringstream name;
+      name << "LATE_" << value;
+      return LateEnum(value, name.str());
+    }
+
+    static bool frozen() { return _getMembers()->frozen(); }
+
+  private:
+    LateEnum(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const LateEnum LateEnum::FIRST(1, "FIRST");
+  const LateEnum LateEnum::SECOND(2, "SECOND");
+}
+
+TEST(EnumTests, LateRegistrationAfterFreeze) {
+  LateEnum::freeze();
+  ASSERT_TRUE(LateEnum::frozen());
+
+  const std::vector<LateEnum>& before= LateEnum::values();
+  ASSERT_EQ(2, before.size());
+
+  std::atomic<bool> done(false);
+  std::atomic<int> failures(0);
+  std::vector<std::thread> readers;
+  for (int i= 0; i < 4; ++i) {
+    readers.push_back(std::thread([&done, &failures]() {
+      while (!done.load()) {
+	if ((LateEnum::fromValue(2) != LateEnum::SECOND) ||
+	    (LateEnum::fromName("FIRST") != LateEnum::FIRST) ||
+	    (LateEnum::values().size() < 2)) {
+	  ++failures;
+	}
+      }
+    }));
+  }
+
+  std::vector<LateEnum> late;
+  for (int i= 3; i < 200; ++i) {
+    late.push_back(LateEnum::create(i));
+  }
+  done= true;
+  for (auto& t : readers) {
+    t.join();
+  }
+
+  EXPECT_EQ(0, failures.load());
+  EXPECT_EQ(2, before.size());  // Old snapshot is unchanged
+  ASSERT_EQ(199, LateEnum::values().size());
+  for (int i= 3; i < 200; ++i) {
+    EXPECT_EQ(late[i - 3], LateEnum::fromValue(i));
+    EXPECT_EQ(late[i - 3], LateEnum::fromName(late[i - 3].name()));
+    EXPECT_EQ(i - 1, late[i - 3].ordinal());
+  }
+}
+
+namespace {
+  class PluginEnum : public Enum<PluginEnum> {
+  public:
+    static PluginEnum create(int value) {
+      std::ostringstream name;
+      name << "PLUGIN_" << value;
+      return PluginEnum(value, name.str());
+    }
+
+  private:
+    PluginEnum(int value, const std::string& name): Enum(value, name) { }
+  };
+}
+
+TEST(EnumTests, ManyLateRegistrationsAfterFreeze) {
+  // Frozen before any member exists
+  PluginEnum::freeze();
+  EXPECT_TRUE(PluginEnum::values().empty());
+
+  const size_t numMembers= 8000;
+  std::atomic<bool> done(false);
+  std::atomic<int> failures(0);
+  std::vector<std::thread> readers;
+  for (int i= 0; i < 4; ++i) {
+    readers.push_back(std::thread([&done, &failures]() {
+      while (!done.load()) {
+	const size_t n= PluginEnum::values().size();
+	const Optional<PluginEnum> first= PluginEnum::tryFromValue(0);
+	if ((n && !first) ||
+	    (first && (PluginEnum::fromName("PLUGIN_0") != first.value()))) {
+	  ++failures;
+	}
+      }
+    }));
+  }
+
+  std::vector<PluginEnum> plugins;
+  for (size_t i= 0; i < numMembers; ++i) {
+    plugins.push_back(PluginEnum::create((int)i));
+  }
+  done= true;
+  for (auto& t : readers) {
+    t.join();
+  }
+
+  EXPECT_EQ(0, failures.load());
+  ASSERT_EQ(numMembers, PluginEnum::values().size());
+  for (size_t i= 0; i < numMembers; ++i) {
+    EXPECT_EQ(plugins[i], PluginEnum::fromValue((int)i));
+    EXPECT_EQ(plugins[i], PluginEnum::fromName(plugins[i].name()));
+    EXPECT_EQ(i, plugins[i].ordinal());
+  }
+}
+
 TEST(EnumTests, Values) {
   const std::vector<TestEnum>& v= TestEnum::values();
   ASSERT_EQ(v.size(), 3);
@@ -114,6 +585,62 @@ TEST(EnumTests, Print) {
   EXPECT_EQ(msg.str(), "ONE TWO THREE");
 }
 
+TEST(EnumTests, FormatTo) {
+  char buffer[8];
+  EXPECT_EQ(5, TestEnum::THREE.formatTo(buffer, sizeof(buffer)));
+  EXPECT_STREQ("THREE", buffer);
+
+  // Truncates like snprintf()
+  EXPECT_EQ(5, TestEnum::THREE.formatTo(buffer, 3));
+  EXPECT_STREQ("TH", buffer);
+  EXPECT_EQ(5, TestEnum::THREE.formatTo(nullptr, 0));
+}
+
+TEST(EnumTests, AppendTo) {
+  std::string out("level=");
+  TestEnum::TWO.appendTo(out);
+  out+= ',';
+  TestEnum::ONE.appendTo(out);
+  EXPECT_EQ("level=TWO,ONE", out);
+}
+
+namespace {
+  class InlineEnum : public Enum<InlineEnum, InlineEnumImpl<long> > {
+  public:
+    static const InlineEnum LOW;
+    static const InlineEnum MIDDLE;
+    static const InlineEnum HIGH;
+
+  public:
+    InlineEnum(): Enum<InlineEnum, InlineEnumImpl<long> >(LOW) { }
+
+  private:
+    InlineEnum(long value, const std::string& name): Enum(value, name) { }
+  };
+
+  const InlineEnum InlineEnum::LOW(-10, "LOW");
+  const InlineEnum InlineEnum::MIDDLE(0, "MIDDLE");
+  const InlineEnum InlineEnum::HIGH(10, "HIGH");
+}
+
+TEST(EnumTests, InlineEnum) {
+  EXPECT_EQ(sizeof(void*), sizeof(TestEnum));
+  EXPECT_EQ(sizeof(long) + 2 * sizeof(void*), sizeof(InlineEnum));
+
+  EXPECT_EQ(-10, InlineEnum::LOW.value());
+  EXPECT_EQ("MIDDLE", InlineEnum::MIDDLE.name());
+  EXPECT_EQ(2, InlineEnum::HIGH.ordinal());
+  EXPECT_EQ(InlineEnum::HIGH, InlineEnum::fromValue(10));
+  EXPECT_EQ(InlineEnum::MIDDLE, InlineEnum::fromName("MIDDLE"));
+
+  std::vector<InlineEnum> v{ InlineEnum::HIGH, InlineEnum::LOW,
+			     InlineEnum::MIDDLE, InlineEnum::LOW };
+  std::sort(v.begin(), v.end());
+  EXPECT_EQ(std::vector<InlineEnum>({ InlineEnum::LOW, InlineEnum::LOW,
+				      InlineEnum::MIDDLE, InlineEnum::HIGH }),
+	    v);
+}
+
 namespace {
   template <typename DerivedT, typename ImplT>
   class CustomEnumMemberData : public BasicEnumMemberData<DerivedT, ImplT> {
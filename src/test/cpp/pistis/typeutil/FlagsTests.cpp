@@ -0,0 +1,261 @@
+/** @file FlagsTests.cpp
+ *
+ *  Unit tests for pistis::typeutil::Flags
+ */
+
+#include <pistis/typeutil/Flags.hpp>
+#include <pistis/typeutil/Enum.hpp>
+#include <gtest/gtest.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace pistis::exceptions;
+using namespace pistis::typeutil;
+
+namespace {
+  class Permission : public Enum<Permission> {
+  public:
+    static const Permission READ;
+    static const Permission WRITE;
+    static const Permission EXECUTE;
+    static const Permission ADMIN;
+
+  public:
+    Permission(): Enum<Permission>(READ) { }
+
+  private:
+    Permission(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const Permission Permission::READ(4, "READ");
+  const Permission Permission::WRITE(2, "WRITE");
+  const Permission Permission::EXECUTE(1, "EXECUTE");
+  const Permission Permission::ADMIN(8, "ADMIN");
+
+  typedef Flags<Permission> Permissions;
+
+  class Feature : public Enum<Feature> {
+  public:
+    static const std::vector<Feature> ALL;
+
+  public:
+    static std::vector<Feature> create(int n) {
+      std::vector<Feature> features;
+      for (int i = 0; i < n; ++i) {
+	std::ostringstream name;
+	name << "FEATURE_" << i;
+	features.push_back(Feature(i, name.str()));
+      }
+      return features;
+    }
+
+  private:
+    Feature(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const std::vector<Feature> Feature::ALL = Feature::create(300);
+
+  typedef Flags<Feature, 300> Features;
+}
+
+TEST(FlagsTests, Layout) {
+  EXPECT_EQ(sizeof(uint64_t), sizeof(Permissions));
+  EXPECT_EQ(5 * sizeof(uint64_t), sizeof(Features));
+}
+
+TEST(FlagsTests, InsertAndErase) {
+  Permissions p;
+  EXPECT_TRUE(p.empty());
+
+  EXPECT_TRUE(p.insert(Permission::WRITE));
+  EXPECT_FALSE(p.insert(Permission::WRITE));
+  EXPECT_TRUE(p.insert(Permission::ADMIN));
+  EXPECT_EQ(2, p.size());
+  EXPECT_TRUE(p.contains(Permission::WRITE));
+  EXPECT_FALSE(p.contains(Permission::READ));
+  EXPECT_EQ(0xA, p.mask());
+
+  EXPECT_TRUE(p.erase(Permission::WRITE));
+  EXPECT_FALSE(p.erase(Permission::WRITE));
+  EXPECT_EQ(Permissions::of(Permission::ADMIN), p);
+
+  p.clear();
+  EXPECT_TRUE(p.empty());
+}
+
+TEST(FlagsTests, SetOperations) {
+  const Permissions rw{ Permission::READ, Permission::WRITE };
+  const Permissions rx{ Permission::READ, Permission::EXECUTE };
+
+  EXPECT_EQ(Permissions({ Permission::READ, Permission::WRITE,
+			  Permission::EXECUTE }), rw | rx);
+  EXPECT_EQ(Permissions::of(Permission::READ), rw & rx);
+  EXPECT_EQ(Permissions::of(Permission::WRITE), rw - rx);
+  EXPECT_EQ(rw, Permissions::of(Permission::READ) | Permission::WRITE);
+
+  EXPECT_TRUE(Permissions::of(Permission::READ).isSubsetOf(rw));
+  EXPECT_FALSE(rx.isSubsetOf(rw));
+  EXPECT_TRUE(Permissions().isSubsetOf(rw));
+  EXPECT_TRUE(rw.containsAll(Permissions::of(Permission::WRITE)));
+  EXPECT_TRUE(rw.containsAny(rx));
+  EXPECT_FALSE(rw.containsAny(Permissions::of(Permission::ADMIN)));
+}
+
+TEST(FlagsTests, Iteration) {
+  const Permissions p{ Permission::ADMIN, Permission::READ };
+  std::vector<Permission> members(p.begin(), p.end());
+
+  EXPECT_EQ(std::vector<Permission>({ Permission::READ, Permission::ADMIN }),
+	    members);
+  EXPECT_EQ(Permissions().begin(), Permissions().end());
+}
+
+TEST(FlagsTests, ManyWords) {
+  Features f;
+  f.insert(Feature::ALL[0]);
+  f.insert(Feature::ALL[130]);
+  f.insert(Feature::ALL[299]);
+  const Features g{ Feature::ALL[130], Feature::ALL[200] };
+
+  EXPECT_EQ(3, f.size());
+  EXPECT_EQ(4, (f | g).size());
+  EXPECT_EQ(Features::of(Feature::ALL[130]), f & g);
+  EXPECT_EQ(2, (f - g).size());
+  EXPECT_TRUE((f & g).isSubsetOf(f));
+  EXPECT_FALSE(g.isSubsetOf(f));
+
+  std::vector<Feature> members(f.begin(), f.end());
+  ASSERT_EQ(3, members.size());
+  EXPECT_EQ(Feature::ALL[299], members[2]);
+}
+
+TEST(FlagsTests, TooFewBits) {
+  typedef Flags<Feature, 100> SmallFeatures;
+  SmallFeatures f;
+
+  EXPECT_THROW(f.insert(Feature::ALL[100]), IllegalValueError);
+  EXPECT_FALSE(f.contains(Feature::ALL[100]));
+  EXPECT_FALSE(f.erase(Feature::ALL[100]));
+  EXPECT_TRUE(SmallFeatures::tryParse("FEATURE_150").empty());
+}
+
+TEST(FlagsTests, BulkOperations) {
+  std::mt19937_64 rng(1);
+  std::vector<Features> a(37);
+  std::vector<Features> b(37);
+  for (size_t i = 0; i < a.size(); ++i) {
+    uint64_t x[Features::NUM_WORDS];
+    uint64_t y[Features::NUM_WORDS];
+    for (size_t j = 0; j < Features::NUM_WORDS; ++j) {
+      x[j] = rng();
+      y[j] = rng();
+    }
+    x[Features::NUM_WORDS - 1] &= 0xFFFFFFFFFFFull;
+    y[Features::NUM_WORDS - 1] &= 0xFFFFFFFFFFFull;
+    a[i] = Features::fromWords(x);
+    b[i] = Features::fromWords(y);
+  }
+
+  std::vector<Features> out(a.size());
+  Features::unionOf(a.data(), b.data(), out.data(), a.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    EXPECT_EQ(a[i] | b[i], out[i]);
+  }
+
+  Features::intersectionOf(a.data(), b.data(), out.data(), a.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    EXPECT_EQ(a[i] & b[i], out[i]);
+  }
+
+  // The output may be one of the inputs
+  std::vector<Features> c(a);
+  Features::differenceOf(c.data(), b.data(), c.data(), c.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    EXPECT_EQ(a[i] - b[i], c[i]);
+  }
+}
+
+TEST(FlagsTests, SelectContainingAll) {
+  std::mt19937 rng(1);
+  std::vector<Permissions> rows(150);
+  for (Permissions& p : rows) {
+    for (const Permission& x : Permission::values()) {
+      if (rng() % 2) {
+	p.insert(x);
+      }
+    }
+  }
+
+  const Permissions required{ Permission::READ, Permission::WRITE };
+  std::vector<uint64_t> bitmap(3);
+  const size_t count = Permissions::selectContainingAll(
+      rows.data(), rows.size(), required, bitmap.data()
+  );
+
+  size_t expected = 0;
+  for (size_t i = 0; i < rows.size(); ++i) {
+    const bool selected = (bitmap[i / 64] >> (i % 64)) & 1;
+    EXPECT_EQ(rows[i].containsAll(required), selected);
+    expected += selected;
+  }
+  EXPECT_EQ(expected, count);
+  EXPECT_EQ(0, bitmap[2] >> (150 - 128));
+
+  std::vector<Features> features(70);
+  features[3].insert(Feature::ALL[200]);
+  features[66].insert(Feature::ALL[200]);
+  EXPECT_EQ(2, Features::selectContainingAll(features.data(),
+					     features.size(),
+					     Features::of(Feature::ALL[200]),
+					     bitmap.data()));
+  EXPECT_EQ(1ull << 3, bitmap[0]);
+  EXPECT_EQ(1ull << 2, bitmap[1]);
+}
+
+TEST(FlagsTests, Parse) {
+  EXPECT_EQ(Permissions({ Permission::READ, Permission::ADMIN }),
+	    Permissions::parse("ADMIN|READ"));
+  EXPECT_EQ(Permissions({ Permission::READ, Permission::WRITE }),
+	    Permissions::parse(" READ | WRITE "));
+  EXPECT_EQ(Permissions::of(Permission::EXECUTE),
+	    Permissions::parse("EXECUTE,EXECUTE", ','));
+  EXPECT_TRUE(Permissions::parse("").empty());
+  EXPECT_TRUE(Permissions::parse("  ").empty());
+
+  EXPECT_THROW(Permissions::parse("READ|DELETE"), NoSuchItem);
+  EXPECT_THROW(Permissions::parse("READ|"), NoSuchItem);
+  EXPECT_THROW(Permissions::parse("|READ"), NoSuchItem);
+  EXPECT_THROW(Permissions::parse("READ||WRITE"), NoSuchItem);
+  EXPECT_TRUE(Permissions::tryParse("read").empty());
+  EXPECT_EQ(makeOptional(Permissions::of(Permission::WRITE)),
+	    Permissions::tryParse("WRITE"));
+}
+
+TEST(FlagsTests, Format) {
+  const Permissions p{ Permission::ADMIN, Permission::READ,
+		       Permission::WRITE };
+
+  EXPECT_EQ("READ|WRITE|ADMIN", p.str());
+  EXPECT_EQ("", Permissions().str());
+
+  std::string appended("p=");
+  p.appendTo(appended, ',');
+  EXPECT_EQ("p=READ,WRITE,ADMIN", appended);
+
+  std::ostringstream out;
+  out << p;
+  EXPECT_EQ("READ|WRITE|ADMIN", out.str());
+
+  char buffer[32];
+  EXPECT_EQ(16, p.formatTo(buffer, sizeof(buffer)));
+  EXPECT_STREQ("READ|WRITE|ADMIN", buffer);
+  EXPECT_EQ(16, p.formatTo(buffer, 6));
+  EXPECT_STREQ("READ|", buffer);
+  EXPECT_EQ(16, p.formatTo(buffer, 5));
+  EXPECT_STREQ("READ", buffer);
+  EXPECT_EQ(16, p.formatTo(buffer, 0));
+  EXPECT_EQ(0, Permissions().formatTo(buffer, sizeof(buffer)));
+  EXPECT_STREQ("", buffer);
+}
@@ -0,0 +1,174 @@
+/** @file NameOfTests.cpp
+ *
+ *  Unit tests for pistis::typeutil::nameOf, cachedNameOf, typeName and
+ *  typeId
+ */
+
+#include <pistis/typeutil/NameOf.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace pistis::typeutil;
+
+namespace pistis {
+  namespace typeutil {
+    namespace testing {
+      struct Widget { };
+
+      template <typename T, int N>
+      struct Box { };
+    }
+  }
+}
+
+namespace {
+  struct Hidden { };
+
+  // Each test of the registry uses its own types, since counts persist
+  // for the life of the program
+  struct Counted { };
+  struct Shared { };
+  struct Dumped { };
+  struct Uncounted { };
+
+  uint64_t countOf(const std::string& name) {
+    const std::vector<NameOfUsage> usage = nameOfUsage();
+    auto i = std::find_if(usage.begin(), usage.end(),
+			  [&name](const NameOfUsage& u) {
+			    return u.name == name;
+			  });
+    return (i == usage.end()) ? 0 : i->count;
+  }
+}
+
+TEST(NameOfTests, NameOf) {
+  EXPECT_EQ("int", nameOf<int>());
+  EXPECT_EQ("pistis::typeutil::testing::Widget",
+	    nameOf<pistis::typeutil::testing::Widget>());
+}
+
+TEST(NameOfTests, CachedNameOf) {
+  countNameOfCalls(true);
+  const std::string& name = cachedNameOf<Counted>();
+  EXPECT_EQ(nameOf<Counted>(), name);
+  EXPECT_EQ(&name, &cachedNameOf<Counted>());
+  EXPECT_EQ(2, countOf(name));
+}
+
+TEST(NameOfTests, CachedNameOfWithoutCounting) {
+  countNameOfCalls(false);
+  const std::string& name = cachedNameOf<Uncounted>();
+  EXPECT_EQ(nameOf<Uncounted>(), name);
+  EXPECT_EQ(0, countOf(name));
+
+  countNameOfCalls(true);
+  cachedNameOf<Uncounted>();
+  countNameOfCalls(false);
+  cachedNameOf<Uncounted>();
+  EXPECT_EQ(1, countOf(name));
+}
+
+TEST(NameOfTests, CachedNameOfFromManyThreads) {
+  const size_t NUM_THREADS = 4;
+  const size_t NUM_CALLS = 10000;
+  std::vector<const std::string*> names(NUM_THREADS);
+  countNameOfCalls(true);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < NUM_THREADS; ++i) {
+    threads.push_back(std::thread([&names, i]() {
+      for (size_t j = 0; j < NUM_CALLS; ++j) {
+	names[i] = &cachedNameOf<Shared>();
+      }
+    }));
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+
+  for (const std::string* name : names) {
+    EXPECT_EQ(names[0], name);
+  }
+  EXPECT_EQ(nameOf<Shared>(), *names[0]);
+  EXPECT_EQ(NUM_THREADS * NUM_CALLS, countOf(*names[0]));
+}
+
+TEST(NameOfTests, DumpNameOfUsage) {
+  countNameOfCalls(true);
+  for (int i = 0; i < 3; ++i) {
+    cachedNameOf<Dumped>();
+  }
+
+  const std::vector<NameOfUsage> usage = nameOfUsage();
+  for (size_t i = 1; i < usage.size(); ++i) {
+    EXPECT_GE(usage[i - 1].count, usage[i].count);
+  }
+
+  std::ostringstream out;
+  dumpNameOfUsage(out);
+  EXPECT_NE(std::string::npos,
+	    out.str().find("3 " + nameOf<Dumped>() + "\n"));
+}
+
+#if PISTIS_HAS_CONSTEXPR_TYPE_NAME
+
+TEST(NameOfTests, TypeNameIsConstexpr) {
+  constexpr StringView name = typeName<int>();
+  static_assert(name == StringView("int"), "Wrong name for int");
+  static_assert(typeName<double>().size() == 6, "Wrong name for double");
+  static_assert(typeId<int>() == typeIdOfName("int"), "Wrong id for int");
+  EXPECT_EQ("int", name);
+}
+
+#endif
+
+TEST(NameOfTests, TypeName) {
+  EXPECT_EQ("int", typeName<int>());
+  EXPECT_EQ("unsigned int", typeName<unsigned>());
+  EXPECT_EQ("const char*", typeName<const char*>());
+  EXPECT_EQ("pistis::typeutil::testing::Widget",
+	    typeName<pistis::typeutil::testing::Widget>());
+  typedef pistis::typeutil::testing::Box<
+      pistis::typeutil::testing::Widget, 3> WidgetBox;
+  EXPECT_EQ("pistis::typeutil::testing::Box<"
+		"pistis::typeutil::testing::Widget, 3>",
+	    typeName<WidgetBox>());
+}
+
+TEST(NameOfTests, TypeNameWithBrackets) {
+  const std::string name = typeName<int[4]>().str();
+  EXPECT_EQ(0, name.find("int"));
+  EXPECT_EQ(name.size() - 3, name.find("[4]"));
+}
+
+TEST(NameOfTests, TypeNameInAnonymousNamespace) {
+  const std::string name = typeName<Hidden>().str();
+  EXPECT_EQ(name.size() - 8, name.rfind("::Hidden"));
+  EXPECT_NE(std::string::npos, name.find("anonymous"));
+}
+
+TEST(NameOfTests, TypeIdOfName) {
+  // Published FNV-1a test vectors
+  EXPECT_EQ(0xcbf29ce484222325ull, typeIdOfName(""));
+  EXPECT_EQ(0xaf63dc4c8601ec8cull, typeIdOfName("a"));
+  EXPECT_EQ(0x85944171f73967e8ull, typeIdOfName("foobar"));
+}
+
+TEST(NameOfTests, TypeId) {
+  EXPECT_EQ(typeIdOfName(typeName<int>()), typeId<int>());
+  EXPECT_EQ(typeIdOfName("pistis::typeutil::testing::Widget"),
+	    typeId<pistis::typeutil::testing::Widget>());
+  EXPECT_NE(typeId<int>(), typeId<unsigned>());
+  EXPECT_NE(typeId<int>(), typeId<const int>());
+  EXPECT_NE(typeId<Hidden>(), typeId<Counted>());
+}
+
+TEST(NameOfTests, TypeNameIsStable) {
+  const StringView first = typeName<pistis::typeutil::testing::Widget>();
+  const StringView second = typeName<pistis::typeutil::testing::Widget>();
+  EXPECT_EQ(first.data(), second.data());
+  EXPECT_EQ(first.size(), second.size());
+}
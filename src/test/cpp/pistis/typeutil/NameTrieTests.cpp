@@ -0,0 +1,119 @@
+/** @file NameTrieTests.cpp
+ *
+ *  Unit tests for pistis::typeutil::NameTrie
+ */
+
+#include <pistis/typeutil/NameTrie.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <ctype.h>
+
+using namespace pistis::typeutil;
+
+namespace {
+  NameTrie createTrie(const std::vector<StringView>& names) {
+    std::vector<uint32_t> ids;
+    for (uint32_t i = 0; i < names.size(); ++i) {
+      ids.push_back(i * 10);
+    }
+
+    NameTrie trie;
+    trie.build(names.data(), ids.data(), names.size());
+    return trie;
+  }
+}
+
+TEST(NameTrieTests, EmptyTrie) {
+  NameTrie trie;
+  const NameTrie::Match m = trie.match("A");
+
+  EXPECT_TRUE(trie.empty());
+  EXPECT_EQ(NameTrie::NOT_FOUND, m.exact);
+  EXPECT_EQ(NameTrie::NOT_FOUND, m.uniquePrefix);
+  EXPECT_EQ(NameTrie::NOT_FOUND, m.longestPrefix);
+}
+
+TEST(NameTrieTests, ExactMatchIgnoresCase) {
+  const NameTrie trie = createTrie({ "RED", "GREEN", "BLUE" });
+
+  EXPECT_EQ(0, trie.match("red").exact);
+  EXPECT_EQ(10, trie.match("Green").exact);
+  EXPECT_EQ(20, trie.match("BLUE").exact);
+  EXPECT_EQ(NameTrie::NOT_FOUND, trie.match("BLU").exact);
+  EXPECT_EQ(NameTrie::NOT_FOUND, trie.match("BLUER").exact);
+  EXPECT_EQ(NameTrie::NOT_FOUND, trie.match("PURPLE").exact);
+  EXPECT_EQ(NameTrie::NOT_FOUND, trie.match("").exact);
+}
+
+TEST(NameTrieTests, UniquePrefix) {
+  const NameTrie trie = createTrie({ "INFO", "INFINITY", "IN", "OUT" });
+
+  // "i" and "inf" begin more than one name
+  EXPECT_EQ(NameTrie::AMBIGUOUS, trie.match("i").uniquePrefix);
+  EXPECT_EQ(NameTrie::AMBIGUOUS, trie.match("inf").uniquePrefix);
+  EXPECT_EQ(10, trie.match("infi").uniquePrefix);
+  EXPECT_EQ(0, trie.match("INFO").uniquePrefix);
+  EXPECT_EQ(30, trie.match("o").uniquePrefix);
+  EXPECT_EQ(NameTrie::NOT_FOUND, trie.match("x").uniquePrefix);
+  EXPECT_EQ(NameTrie::NOT_FOUND, trie.match("infox").uniquePrefix);
+
+  // "in" is a name and also the prefix of two others
+  const NameTrie::Match m = trie.match("In");
+  EXPECT_EQ(20, m.exact);
+  EXPECT_EQ(NameTrie::AMBIGUOUS, m.uniquePrefix);
+}
+
+TEST(NameTrieTests, LongestPrefix) {
+  const NameTrie trie = createTrie({ "IN", "INFO", "INFORMATION" });
+  NameTrie::Match m = trie.match("information=42");
+
+  EXPECT_EQ(20, m.longestPrefix);
+  EXPECT_EQ(11, m.longestPrefixLength);
+
+  m = trie.match("INFORM");
+  EXPECT_EQ(10, m.longestPrefix);
+  EXPECT_EQ(4, m.longestPrefixLength);
+
+  m = trie.match("INDEX");
+  EXPECT_EQ(0, m.longestPrefix);
+  EXPECT_EQ(2, m.longestPrefixLength);
+
+  m = trie.match("I");
+  EXPECT_EQ(NameTrie::NOT_FOUND, m.longestPrefix);
+  EXPECT_EQ(0, m.longestPrefixLength);
+}
+
+TEST(NameTrieTests, NamesThatDifferOnlyInCase) {
+  const NameTrie trie = createTrie({ "Mode", "MODE", "MODEL" });
+  const NameTrie::Match m = trie.match("mode");
+
+  EXPECT_EQ(NameTrie::AMBIGUOUS, m.exact);
+  EXPECT_EQ(NameTrie::AMBIGUOUS, m.uniquePrefix);
+  EXPECT_EQ(NameTrie::AMBIGUOUS, m.longestPrefix);
+  EXPECT_EQ(20, trie.match("model").exact);
+  EXPECT_EQ(20, trie.match("MODEL").uniquePrefix);
+}
+
+TEST(NameTrieTests, ManyNames) {
+  std::vector<std::string> names;
+  for (int i = 0; i < 1000; ++i) {
+    std::ostringstream name;
+    name << "Code_" << i;
+    names.push_back(name.str());
+  }
+
+  const NameTrie trie =
+      createTrie(std::vector<StringView>(names.begin(), names.end()));
+  for (uint32_t i = 0; i < names.size(); ++i) {
+    std::string upper = names[i];
+    for (char& c : upper) {
+      c = (char)toupper(c);
+    }
+    EXPECT_EQ(i * 10, trie.match(upper).exact);
+  }
+  EXPECT_EQ(990, trie.match("code_99x").longestPrefix);
+  EXPECT_EQ(9990, trie.match("code_999").uniquePrefix);
+  EXPECT_EQ(NameTrie::AMBIGUOUS, trie.match("code_99").uniquePrefix);
+}
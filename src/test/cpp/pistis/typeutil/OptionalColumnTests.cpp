@@ -0,0 +1,165 @@
+/** @file OptionalColumnTests.cpp
+ *
+ *  Unit tests for pistis::typeutil::OptionalColumn
+ */
+#include <pistis/typeutil/OptionalColumn.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include <stdint.h>
+
+using namespace pistis::typeutil;
+
+namespace {
+  // Long enough to have full blocks and a partial one.  Entries whose
+  // index is divisible by 3 are absent.
+  const size_t SIZE = 150;
+
+  OptionalColumn<int64_t> createColumn() {
+    OptionalColumn<int64_t> column;
+    for (size_t i = 0; i < SIZE; ++i) {
+      column.push_back((i % 3) ? Optional<int64_t>((int64_t)i)
+			       : Optional<int64_t>());
+    }
+    return column;
+  }
+}
+
+TEST(OptionalColumnTests, CreateEmpty) {
+  OptionalColumn<double> column;
+  EXPECT_TRUE(column.empty());
+  EXPECT_EQ(0, column.size());
+  EXPECT_EQ(0, column.count());
+  EXPECT_EQ(0.0, column.sum());
+}
+
+TEST(OptionalColumnTests, CreateAbsent) {
+  OptionalColumn<double> column(70);
+  EXPECT_EQ(70, column.size());
+  EXPECT_EQ(0, column.count());
+  EXPECT_TRUE(column[69].empty());
+}
+
+TEST(OptionalColumnTests, CreateFilled) {
+  OptionalColumn<double> column(70, 1.5);
+  EXPECT_EQ(70, column.count());
+  EXPECT_EQ(1.5, column[69].value());
+  EXPECT_EQ(105.0, column.sum());
+}
+
+TEST(OptionalColumnTests, CreateFromOptionals) {
+  const std::vector< Optional<int> > optionals{
+    Optional<int>(1), Optional<int>(), Optional<int>(3)
+  };
+  OptionalColumn<int> column(optionals.begin(), optionals.end());
+  ASSERT_EQ(3, column.size());
+  EXPECT_EQ(2, column.count());
+  EXPECT_TRUE(column[0] == optionals[0]);
+  EXPECT_TRUE(column[1] == optionals[1]);
+  EXPECT_TRUE(column[2] == optionals[2]);
+}
+
+TEST(OptionalColumnTests, AccessEntries) {
+  const OptionalColumn<int64_t> column = createColumn();
+  ASSERT_EQ(SIZE, column.size());
+  EXPECT_EQ(SIZE - 50, column.count());
+  for (size_t i = 0; i < SIZE; ++i) {
+    EXPECT_EQ((bool)(i % 3), column.present(i));
+    EXPECT_EQ((i % 3) ? Optional<int64_t>((int64_t)i) : Optional<int64_t>(),
+	      column[i]);
+  }
+  EXPECT_EQ(0x6DB6DB6DB6DB6DB6ull, column.validity()[0]);
+  EXPECT_EQ(149, column.values()[149]);
+  EXPECT_EQ(0, column.values()[3]);  // Absent entries hold T()
+}
+
+TEST(OptionalColumnTests, SetAndClear) {
+  OptionalColumn<int64_t> column = createColumn();
+  column.set(0, 7);
+  column.clear(1);
+  EXPECT_EQ(7, column[0].value());
+  EXPECT_TRUE(column[1].empty());
+  EXPECT_EQ(0, column.values()[1]);
+  EXPECT_EQ(SIZE - 50, column.count());
+}
+
+TEST(OptionalColumnTests, Map) {
+  const OptionalColumn<double> halves =
+      createColumn().map([](int64_t x) { return (x + 1) / 2.0; });
+  ASSERT_EQ(SIZE, halves.size());
+  for (size_t i = 0; i < SIZE; ++i) {
+    EXPECT_EQ((i % 3) ? Optional<double>((i + 1) / 2.0) : Optional<double>(),
+	      halves[i]);
+  }
+  EXPECT_EQ(0.0, halves.values()[0]);
+}
+
+TEST(OptionalColumnTests, Filter) {
+  const OptionalColumn<int64_t> column = createColumn();
+  const OptionalColumn<int64_t> even =
+      column.filter([](int64_t x) { return !(x % 2); });
+  ASSERT_EQ(SIZE, even.size());
+  for (size_t i = 0; i < SIZE; ++i) {
+    EXPECT_EQ((i % 3) && !(i % 2), even.present(i));
+    EXPECT_EQ(even.present(i) ? (int64_t)i : 0, even.values()[i]);
+  }
+  EXPECT_EQ(SIZE - 50, column.count());  // Source unchanged
+}
+
+TEST(OptionalColumnTests, MapAndFilterSkipAbsentEntries) {
+  // Present values are all nonzero, and absent ones hold zero
+  OptionalColumn<int64_t> column = createColumn();
+  for (size_t i = 64; i < 128; ++i) {
+    column.set(i, (int64_t)i);  // Fill the second block
+  }
+  std::vector<int64_t> seen;
+  column.map([&seen](int64_t x) { seen.push_back(x); return x; });
+  ASSERT_EQ(column.count(), seen.size());
+  for (size_t i = 0, j = 0; i < SIZE; ++i) {
+    if (column.present(i)) {
+      EXPECT_EQ((int64_t)i, seen[j++]);
+    }
+  }
+
+  seen.clear();
+  column.filter([&seen](int64_t x) { seen.push_back(x); return true; });
+  EXPECT_EQ(column.count(), seen.size());
+  EXPECT_EQ(0, std::count(seen.begin(), seen.end(), 0));
+}
+
+TEST(OptionalColumnTests, ValueOr) {
+  const std::vector<int64_t> values = createColumn().valueOr(-1);
+  ASSERT_EQ(SIZE, values.size());
+  for (size_t i = 0; i < SIZE; ++i) {
+    EXPECT_EQ((i % 3) ? (int64_t)i : -1, values[i]);
+  }
+}
+
+TEST(OptionalColumnTests, Sum) {
+  int64_t truth = 0;
+  for (size_t i = 0; i < SIZE; ++i) {
+    if (i % 3) {
+      truth += i;
+    }
+  }
+  EXPECT_EQ(truth, createColumn().sum());
+}
+
+TEST(OptionalColumnTests, Reduce) {
+  OptionalColumn<int64_t> column(130, 1);
+  column.clear(70);
+  column.clear(129);
+
+  std::vector<int64_t> seen;
+  column.reduce(0, [&seen](int64_t n, int64_t x) {
+    seen.push_back(x);
+    return n + x;
+  });
+  EXPECT_EQ(128, seen.size());
+  EXPECT_EQ(128, column.reduce(0, [](int64_t n, int64_t x) {
+    return n + x;
+  }));
+  EXPECT_EQ(1, createColumn().reduce(
+      (int64_t)1000, [](int64_t m, int64_t x) { return x < m ? x : m; }
+  ));
+}
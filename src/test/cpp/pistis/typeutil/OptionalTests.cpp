@@ -5,7 +5,13 @@
 #include <pistis/typeutil/Optional.hpp>
 #include <gtest/gtest.h>
 #include <ostream>
+#include <cmath>
+#include <limits>
 #include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <string.h>
 
 using namespace pistis::exceptions;
 using namespace pistis::typeutil;
@@ -48,6 +54,88 @@ namespace {
   inline std::ostream& operator<<(std::ostream& out, const Value& v) {
     return out << v.value();
   }
+
+  enum class Side { BUY, SELL, NONE };
+
+  typedef Optional<double, NanNiche<double> > OptionalPrice;
+  typedef Optional<const int*, NullNiche<const int*> > OptionalPointer;
+  typedef Optional<int, SentinelNiche<int, std::numeric_limits<int>::max()> >
+      OptionalCount;
+  typedef Optional<Side, SentinelNiche<Side, Side::NONE> > OptionalSide;
+
+  static_assert(sizeof(OptionalPrice) == sizeof(double),
+		"Optional with a NaN niche is larger than its value");
+  static_assert(sizeof(OptionalPointer) == sizeof(const int*),
+		"Optional with a null niche is larger than its value");
+  static_assert(sizeof(OptionalCount) == sizeof(int),
+		"Optional with a sentinel niche is larger than its value");
+  static_assert(sizeof(OptionalSide) == sizeof(Side),
+		"Optional with an enum niche is larger than its value");
+  static_assert(std::is_trivially_copyable<OptionalPrice>::value,
+		"Optional with a niche is not trivially copyable");
+
+  // Counts copies, and has noexcept moves
+  class Tracked {
+  public:
+    static int copies;
+
+  public:
+    explicit Tracked(int v): v_(v) { }
+    Tracked(const Tracked& other): v_(other.v_) { ++copies; }
+    Tracked(Tracked&& other) noexcept: v_(other.v_) { }
+
+    int value() const { return v_; }
+
+    Tracked& operator=(const Tracked& other) {
+      v_ = other.v_;
+      ++copies;
+      return *this;
+    }
+    Tracked& operator=(Tracked&& other) noexcept {
+      v_ = other.v_;
+      return *this;
+    }
+
+  private:
+    int v_;
+  };
+
+  int Tracked::copies = 0;
+
+  static_assert(std::is_nothrow_move_constructible< Optional<int> >::value,
+		"Optional<int> move may throw");
+  static_assert(
+      std::is_nothrow_move_constructible< Optional<std::string> >::value,
+      "Optional<std::string> move may throw"
+  );
+  static_assert(
+      std::is_nothrow_move_assignable< Optional<std::string> >::value,
+      "Optional<std::string> move assignment may throw"
+  );
+  static_assert(
+      noexcept(swap(std::declval< Optional<std::string>& >(),
+		    std::declval< Optional<std::string>& >())),
+      "Optional<std::string> swap may throw"
+  );
+  static_assert(
+      !std::is_nothrow_move_constructible< Optional<Value> >::value,
+      "Optional<Value> move cannot throw, though Value's move can"
+  );
+
+  static_assert(std::is_trivially_copyable< Optional<int> >::value,
+		"Optional<int> is not trivially copyable");
+  static_assert(std::is_trivially_destructible< Optional<double> >::value,
+		"Optional<double> is not trivially destructible");
+  static_assert(IsBitCopyable< Optional<int> >::value,
+		"Optional<int> is not bit-copyable");
+  static_assert(!std::is_trivially_copyable< Optional<std::string> >::value,
+		"Optional<std::string> is trivially copyable");
+  static_assert(
+      !std::is_trivially_destructible< Optional<std::string> >::value,
+      "Optional<std::string> is trivially destructible"
+  );
+  static_assert(!IsBitCopyable< Optional<std::string> >::value,
+		"Optional<std::string> is bit-copyable");
 }
 
 TEST(OptionalTests, CreateEmptyOptional) {
@@ -119,6 +207,27 @@ TEST(OptionalTests, ConstructByMove) {
   EXPECT_TRUE(src.empty());  // Move leaves source empty
 }
 
+TEST(OptionalTests, MoveTriviallyCopyableValue) {
+  Optional<int> src(5);
+  Optional<int> moved(std::move(src));
+  EXPECT_EQ(5, moved.value());
+  EXPECT_TRUE(src.present());  // Move copies trivially copyable values
+
+  Optional<int> assigned;
+  assigned = std::move(moved);
+  EXPECT_EQ(5, assigned.value());
+  EXPECT_TRUE(moved.present());
+}
+
+TEST(OptionalTests, CopyBits) {
+  const Optional<int> values[] = { Optional<int>(7), Optional<int>() };
+  Optional<int> copies[2];
+  memcpy(copies, values, sizeof(values));
+
+  EXPECT_EQ(7, copies[0].value());
+  EXPECT_TRUE(copies[1].empty());
+}
+
 TEST(OptionalTests, AssignCopy) {
   Optional<Value> empty;
   Optional<Value> opt(Value(9));
@@ -187,6 +296,66 @@ TEST(OptionalTests, AssignByMove) {
   EXPECT_TRUE(opt.empty());  // Moving leaves src empty
 }
 
+TEST(OptionalTests, AssignByMoveToPresentValue) {
+  Optional<Value> opt(Value(9));
+  Optional<Value> target(Value(4));
+
+  target = std::move(opt);
+  ASSERT_TRUE(target.present());
+  EXPECT_EQ(9, target.value());
+  EXPECT_TRUE(target.value().moved());
+  EXPECT_TRUE(opt.empty());
+
+  target = Optional<Value>();
+  EXPECT_TRUE(target.empty());
+}
+
+TEST(OptionalTests, VectorReallocationMovesValues) {
+  std::vector< Optional<Tracked> > v;
+  Tracked::copies = 0;
+  for (int i = 0; i < 100; ++i) {
+    v.push_back(Optional<Tracked>(Tracked(i)));
+  }
+
+  EXPECT_EQ(0, Tracked::copies);
+  ASSERT_EQ(100, v.size());
+  EXPECT_EQ(0, v.front().value().value());
+  EXPECT_EQ(99, v.back().value().value());
+}
+
+TEST(OptionalTests, Swap) {
+  Optional<std::string> a("apple");
+  Optional<std::string> b("banana");
+  Optional<std::string> empty;
+
+  a.swap(b);
+  EXPECT_EQ("banana", a.value());
+  EXPECT_EQ("apple", b.value());
+
+  a.swap(empty);
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ("banana", empty.value());
+
+  a.swap(empty);
+  EXPECT_EQ("banana", a.value());
+  EXPECT_TRUE(empty.empty());
+
+  Optional<std::string> alsoEmpty;
+  empty.swap(alsoEmpty);
+  EXPECT_TRUE(empty.empty());
+  EXPECT_TRUE(alsoEmpty.empty());
+}
+
+TEST(OptionalTests, SwapFoundByArgumentDependentLookup) {
+  Optional<int> a(1);
+  Optional<int> b;
+
+  using std::swap;
+  swap(a, b);
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(1, b.value());
+}
+
 TEST(OptionalTests, AccessValue) {
   Optional<int> empty;
   Optional<int> opt(5);
@@ -329,6 +498,71 @@ TEST(OptionalTests, Filter) {
   EXPECT_TRUE(empty.filter(greaterThan5).empty());
 }
 
+TEST(OptionalTests, MoveValueOutOfTemporary) {
+  Tracked::copies = 0;
+  const Tracked t = Optional<Tracked>(Tracked(3)).value();
+  EXPECT_EQ(3, t.value());
+  EXPECT_EQ(
+      4, Optional<Tracked>().valueOr(Tracked(4)).value()
+  );
+  EXPECT_EQ(
+      5, Optional<Tracked>(Tracked(5)).valueOrCall([]() {
+	return Tracked(0);
+      }).value()
+  );
+  EXPECT_EQ(0, Tracked::copies);
+
+  Optional<Tracked> empty;
+  EXPECT_THROW(std::move(empty).value(), OptionalEmptyError);
+}
+
+TEST(OptionalTests, ChainOnTemporary) {
+  auto next = [](Tracked t) { return Tracked(t.value() + 1); };
+  Tracked::copies = 0;
+
+  const Optional<Tracked> result =
+      Optional<Tracked>(Tracked(1)).map(next).map(next);
+  EXPECT_EQ(3, result.value().value());
+  EXPECT_EQ(
+      4, Optional<Tracked>(Tracked(4)).apply([](Tracked t) {
+	return t.value();
+      })
+  );
+  EXPECT_EQ(
+      5, Optional<Tracked>(Tracked(5)).applyOr(
+	  [](Tracked t) { return t.value(); }, []() { return 0; }
+      )
+  );
+
+  int seen = 0;
+  Optional<Tracked>(Tracked(6)).ifPresent([&seen](Tracked t) {
+    seen = t.value();
+  });
+  EXPECT_EQ(6, seen);
+  EXPECT_EQ(0, Tracked::copies);
+
+  // Chaining on a named optional still copies its value
+  result.map(next);
+  EXPECT_EQ(1, Tracked::copies);
+  EXPECT_EQ(3, result.value().value());
+}
+
+TEST(OptionalTests, Emplace) {
+  Optional<std::pair<int, std::string> > opt;
+  std::pair<int, std::string>& v = opt.emplace(1, "one");
+  EXPECT_EQ(&v, &opt.value());
+  EXPECT_EQ(1, opt.value().first);
+  EXPECT_EQ("one", opt.value().second);
+
+  opt.emplace(2, "two");
+  EXPECT_EQ(2, opt.value().first);
+  EXPECT_EQ("two", opt.value().second);
+
+  OptionalCount count;
+  count.emplace(7);
+  EXPECT_EQ(7, count.value());
+}
+
 TEST(OptionalTests, Clear) {
   Optional<int> empty;
   Optional<int> opt(21);
@@ -380,3 +614,71 @@ TEST(OptionalTests, Inequality) {
   EXPECT_FALSE(five != alsoFive);
 }
 
+
+TEST(OptionalTests, NanNiche) {
+  OptionalPrice empty;
+  OptionalPrice price(101.25);
+
+  EXPECT_TRUE(empty.empty());
+  EXPECT_TRUE(price.present());
+  EXPECT_EQ(101.25, price.value());
+  EXPECT_THROW(empty.value(), OptionalEmptyError);
+  EXPECT_EQ(-1.0, empty.valueOr(-1.0));
+
+  // Only the niche's own NaN marks the optional empty
+  OptionalPrice nan(std::numeric_limits<double>::quiet_NaN());
+  EXPECT_TRUE(nan.present());
+  EXPECT_TRUE(std::isnan(nan.value()));
+
+  price.clear();
+  EXPECT_TRUE(price.empty());
+}
+
+TEST(OptionalTests, NullNiche) {
+  const int x = 3;
+  OptionalPointer empty;
+  OptionalPointer p(&x);
+
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(&x, p.value());
+  EXPECT_TRUE(OptionalPointer(nullptr).empty());
+}
+
+TEST(OptionalTests, SentinelNiche) {
+  OptionalCount empty;
+  OptionalCount count(0);
+  OptionalSide side(Side::SELL);
+
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(0, count.value());
+  EXPECT_TRUE(OptionalCount(std::numeric_limits<int>::max()).empty());
+  EXPECT_TRUE(OptionalSide().empty());
+  EXPECT_TRUE(side.value() == Side::SELL);
+}
+
+TEST(OptionalTests, CopyAndSwapWithNiche) {
+  OptionalCount a(4);
+  OptionalCount b;
+
+  OptionalCount copy(a);
+  EXPECT_EQ(4, copy.value());
+  b = a;
+  EXPECT_EQ(4, b.value());
+
+  b.clear();
+  swap(a, b);
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(4, b.value());
+}
+
+TEST(OptionalTests, ConvertBetweenNichePolicies) {
+  const Optional<int> plain(6);
+  OptionalCount count(plain);
+  EXPECT_EQ(6, count.value());
+  EXPECT_TRUE(count == plain);
+
+  count.clear();
+  Optional<int> back(5);
+  back = count;
+  EXPECT_TRUE(back.empty());
+}
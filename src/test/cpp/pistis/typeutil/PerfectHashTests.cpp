@@ -0,0 +1,46 @@
+/** @file PerfectHashTests.cpp
+ *
+ *  Unit tests for pistis::typeutil::PerfectHashIndex
+ */
+
+#include <pistis/typeutil/PerfectHash.hpp>
+#include <gtest/gtest.h>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace pistis::typeutil;
+
+TEST(PerfectHashTests, EmptyIndex) {
+  PerfectHashIndex index;
+
+  EXPECT_EQ(0, index.size());
+  EXPECT_EQ(PerfectHashIndex::NOT_FOUND, index.find("A"));
+}
+
+TEST(PerfectHashTests, MapsEachKeyToItsId) {
+  std::vector<std::string> names;
+  for (int i = 0; i < 1000; ++i) {
+    std::ostringstream name;
+    name << "CODE_" << i;
+    names.push_back(name.str());
+  }
+
+  std::vector<StringView> keys(names.begin(), names.end());
+  std::vector<uint32_t> ids;
+  for (uint32_t i = 0; i < keys.size(); ++i) {
+    ids.push_back(1000 + i);
+  }
+
+  PerfectHashIndex index;
+  index.build(keys.data(), ids.data(), keys.size());
+  ASSERT_EQ(keys.size(), index.size());
+
+  std::set<uint32_t> found;
+  for (uint32_t i = 0; i < keys.size(); ++i) {
+    EXPECT_EQ(ids[i], index.find(keys[i]));
+    found.insert(index.find(keys[i]));
+  }
+  EXPECT_EQ(keys.size(), found.size());
+}
@@ -0,0 +1,73 @@
+/** @file StlMapUtilsTests.cpp
+ *
+ *  Unit tests for pistis::typeutil::stl_map_utils
+ */
+
+#include <pistis/typeutil/StlMapUtils.hpp>
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace pistis::exceptions;
+using namespace pistis::typeutil;
+
+namespace {
+  std::map<int, std::string> numbers() {
+    return std::map<int, std::string>{ { 1, "one" }, { 2, "two" },
+				       { 3, "three" } };
+  }
+}
+
+TEST(StlMapUtilsTests, KeysAndValues) {
+  const std::map<int, std::string> m = numbers();
+  EXPECT_EQ((std::vector<int>{ 1, 2, 3 }), stl_map_utils::keys(m));
+  EXPECT_EQ((std::vector<std::string>{ "one", "two", "three" }),
+	    stl_map_utils::values(m));
+}
+
+TEST(StlMapUtilsTests, Get) {
+  std::map<int, std::string> m = numbers();
+  const std::map<int, std::string>& cm = m;
+
+  EXPECT_EQ("two", stl_map_utils::get(cm, 2));
+  EXPECT_THROW(stl_map_utils::get(cm, 4), NoSuchItem);
+
+  stl_map_utils::get(m, 2) = "deux";
+  EXPECT_EQ("deux", m[2]);
+  EXPECT_THROW(stl_map_utils::get(m, 4), NoSuchItem);
+}
+
+TEST(StlMapUtilsTests, GetWithDefault) {
+  std::unordered_map<int, std::string> m{ { 1, "one" } };
+  const std::unordered_map<int, std::string>& cm = m;
+  const std::string missing = "missing";
+  std::string fallback = "fallback";
+
+  EXPECT_EQ("one", stl_map_utils::get(cm, 1, missing));
+  EXPECT_EQ("missing", stl_map_utils::get(cm, 2, missing));
+  EXPECT_EQ(&fallback, &stl_map_utils::get(m, 2, fallback));
+}
+
+TEST(StlMapUtilsTests, GetWithName) {
+  const std::map<int, std::string> m = numbers();
+  auto name = [](const int& k) { return "number " + std::to_string(k); };
+
+  EXPECT_EQ("one", stl_map_utils::get(m, 1, name));
+  EXPECT_THROW(stl_map_utils::get(m, 4, name), NoSuchItem);
+}
+
+TEST(StlMapUtilsTests, GetOrCallAndGetOrUpdate) {
+  std::map<int, std::string> m = numbers();
+
+  EXPECT_EQ("one", stl_map_utils::getOrCall(m, 1, []() { return "?"; }));
+  EXPECT_EQ("?", stl_map_utils::getOrCall(m, 4, []() { return "?"; }));
+  EXPECT_EQ(3, m.size());
+
+  EXPECT_EQ("four",
+	    stl_map_utils::getOrUpdate(m, 4, []() { return "four"; }));
+  EXPECT_EQ("four", m[4]);
+  EXPECT_EQ("four",
+	    stl_map_utils::getOrUpdate(m, 4, []() { return "quatre"; }));
+}
@@ -0,0 +1,144 @@
+/** @file TypeMapTests.cpp
+ *
+ *  Unit tests for pistis::typeutil::TypeMap
+ */
+
+#include <pistis/typeutil/TypeMap.hpp>
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <string>
+
+using namespace pistis::exceptions;
+using namespace pistis::typeutil;
+
+namespace {
+  struct Login { };
+  struct Logout { };
+  struct Heartbeat { };
+
+  template <int N>
+  struct Message { };
+}
+
+TEST(TypeMapTests, InsertAndFind) {
+  TypeMap<int> m;
+
+  EXPECT_TRUE(m.empty());
+  EXPECT_EQ(nullptr, m.find<Login>());
+
+  EXPECT_TRUE(m.insert<Logout>(7));
+  EXPECT_FALSE(m.insert<Logout>(8));
+  m[typeId<Heartbeat>()] = 9;
+
+  EXPECT_EQ(2, m.size());
+  EXPECT_FALSE(m.contains<Login>());
+  EXPECT_TRUE(m.contains<Logout>());
+  EXPECT_TRUE(m.contains(typeId<Heartbeat>()));
+  ASSERT_NE(nullptr, m.find<Logout>());
+  EXPECT_EQ(7, *m.find<Logout>());
+  EXPECT_EQ(9, m.at<Heartbeat>());
+  EXPECT_EQ(9, m.at(typeId<Heartbeat>()));
+  EXPECT_EQ(0, m[typeId<Login>()]);
+  EXPECT_EQ(3, m.size());
+}
+
+TEST(TypeMapTests, AtThrowsForMissingType) {
+  TypeMap<std::string> m;
+  m.insert<Login>("login");
+
+  EXPECT_EQ("login", m.at<Login>());
+  EXPECT_THROW(m.at<Logout>(), NoSuchItem);
+  EXPECT_THROW(m.at(typeId<Logout>()), NoSuchItem);
+}
+
+TEST(TypeMapTests, EraseAndClear) {
+  TypeMap<std::string> m;
+  m.insert<Login>("login");
+  m.insert<Logout>("logout");
+
+  EXPECT_TRUE(m.erase<Login>());
+  EXPECT_FALSE(m.erase<Login>());
+  EXPECT_FALSE(m.erase<Heartbeat>());
+  EXPECT_EQ(1, m.size());
+  EXPECT_FALSE(m.contains<Login>());
+  EXPECT_EQ("logout", m.at<Logout>());
+
+  m.clear();
+  EXPECT_TRUE(m.empty());
+  EXPECT_FALSE(m.contains<Logout>());
+  m.insert<Heartbeat>("heartbeat");
+  EXPECT_EQ("heartbeat", m.at<Heartbeat>());
+}
+
+TEST(TypeMapTests, RejectsIdZero) {
+  // Zero marks empty slots, and typeId() never returns it
+  TypeMap<int> m;
+  EXPECT_THROW(m.insert(0, 1), IllegalValueError);
+  EXPECT_THROW(m[0], IllegalValueError);
+  EXPECT_TRUE(m.empty());
+
+  m.insert<Login>(1);
+  EXPECT_THROW(m.insert(0, 2), IllegalValueError);
+  EXPECT_THROW(m[0], IllegalValueError);
+  EXPECT_FALSE(m.contains(0));
+  EXPECT_EQ(nullptr, m.find(0));
+  EXPECT_FALSE(m.erase(0));
+  EXPECT_THROW(m.at(0), NoSuchItem);
+  EXPECT_EQ(1, m.size());
+  EXPECT_EQ(1, m.at<Login>());
+}
+
+TEST(TypeMapTests, ForEach) {
+  TypeMap<int> m;
+  m.insert<Login>(1);
+  m.insert< Message<3> >(3);
+
+  std::map<TypeId, int> seen;
+  m.forEach([&seen](TypeId id, int& v) { seen[id] = v++; });
+  EXPECT_EQ((std::map<TypeId, int>{ { typeId<Login>(), 1 },
+				    { typeId< Message<3> >(), 3 } }),
+	    seen);
+  EXPECT_EQ(2, m.at<Login>());
+}
+
+TEST(TypeMapTests, AgreesWithStdMap) {
+  TypeMap<int> m;
+  std::map<TypeId, int> expected;
+  std::mt19937 rng(1);
+
+  // Inserts outnumber erases, so the map grows and rehashes while
+  // erases shift entries back along long probe sequences
+  for (int i = 0; i < 20000; ++i) {
+    const TypeId id = typeIdOfName(std::to_string(rng() % 1024));
+    if (rng() % 3) {
+      m[id] = i;
+      expected[id] = i;
+    } else {
+      EXPECT_EQ(expected.erase(id) > 0, m.erase(id));
+    }
+  }
+
+  ASSERT_EQ(expected.size(), m.size());
+  for (int i = 0; i < 1024; ++i) {
+    const TypeId id = typeIdOfName(std::to_string(i));
+    auto j = expected.find(id);
+    if (j == expected.end()) {
+      EXPECT_FALSE(m.contains(id));
+    } else {
+      EXPECT_EQ(j->second, m.at(id));
+    }
+  }
+}
+
+TEST(TypeMapTests, Reserve) {
+  TypeMap<int> m;
+  m.reserve(3000);
+  for (int i = 0; i < 3000; ++i) {
+    m[typeIdOfName(std::to_string(i))] = i;
+  }
+
+  EXPECT_EQ(3000, m.size());
+  EXPECT_EQ(2999, m.at(typeIdOfName("2999")));
+  EXPECT_FALSE(m.contains(typeIdOfName("3000")));
+}
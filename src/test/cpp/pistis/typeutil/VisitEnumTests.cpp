@@ -0,0 +1,110 @@
+/** @file VisitEnumTests.cpp
+ *
+ *  Unit tests for pistis::typeutil::visitEnum
+ */
+
+#include <pistis/typeutil/VisitEnum.hpp>
+#include <pistis/typeutil/ConstexprEnum.hpp>
+#include <pistis/typeutil/Enum.hpp>
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace pistis::exceptions;
+using namespace pistis::typeutil;
+
+namespace {
+  class Light : public ConstexprEnum<Light> {
+  public:
+    static const Light RED;
+    static const Light YELLOW;
+    static const Light GREEN;
+
+    static constexpr auto TABLE = makeConstexprEnumTable<int>({
+      { 10, "RED" }, { 20, "YELLOW" }, { 30, "GREEN" }
+    });
+
+  private:
+    friend class ConstexprEnum<Light>;
+    constexpr Light(uint32_t ordinal): ConstexprEnum(ordinal) { }
+  };
+
+  constexpr decltype(Light::TABLE) Light::TABLE;
+  constexpr Light Light::RED(TABLE.findName("RED"));
+  constexpr Light Light::YELLOW(TABLE.findName("YELLOW"));
+  constexpr Light Light::GREEN(TABLE.findName("GREEN"));
+
+  class Direction : public Enum<Direction> {
+  public:
+    static const Direction NORTH;
+    static const Direction SOUTH;
+    static const Direction EAST;
+
+  private:
+    Direction(int value, const std::string& name): Enum(value, name) { }
+  };
+
+  const Direction Direction::NORTH(0, "NORTH");
+  const Direction Direction::SOUTH(1, "SOUTH");
+  const Direction Direction::EAST(2, "EAST");
+}
+
+TEST(VisitEnumTests, VisitWithOverloadedLambdas) {
+  auto action = [](const Light& light) {
+    return visitEnum(light, overloadLambda(
+	[](EnumOrdinal<Light::RED.ordinal()>) { return std::string("stop"); },
+	[](EnumOrdinal<Light::GREEN.ordinal()>) { return std::string("go"); },
+	[](auto) { return std::string("slow down"); }
+    ));
+  };
+
+  EXPECT_EQ(action(Light::RED), "stop");
+  EXPECT_EQ(action(Light::YELLOW), "slow down");
+  EXPECT_EQ(action(Light::GREEN), "go");
+}
+
+TEST(VisitEnumTests, VisitorReceivesOrdinal) {
+  auto ordinalOf = [](const Light& light) {
+    return visitEnum(light, [](auto ordinal) { return ordinal.value; });
+  };
+
+  for (const Light light : Light::values()) {
+    EXPECT_EQ(ordinalOf(light), light.ordinal());
+  }
+}
+
+TEST(VisitEnumTests, HandlerPerConstexprMember) {
+  int red = 0;
+  int yellow = 0;
+  int green = 0;
+  auto count = [&](const Light& light) {
+    visitEnum(light, [&]() { ++red; }, [&]() { ++yellow; },
+	      [&]() { ++green; });
+  };
+
+  count(Light::GREEN);
+  count(Light::RED);
+  count(Light::GREEN);
+  EXPECT_EQ(red, 1);
+  EXPECT_EQ(yellow, 0);
+  EXPECT_EQ(green, 2);
+}
+
+TEST(VisitEnumTests, HandlerPerRuntimeMember) {
+  auto heading = [](const Direction& d) {
+    return visitEnum(d, []() { return 0; }, []() { return 180; },
+		     []() { return 90; });
+  };
+
+  EXPECT_EQ(heading(Direction::NORTH), 0);
+  EXPECT_EQ(heading(Direction::SOUTH), 180);
+  EXPECT_EQ(heading(Direction::EAST), 90);
+}
+
+TEST(VisitEnumTests, MissingRuntimeHandler) {
+  auto heading = [](const Direction& d) {
+    return visitEnum(d, []() { return 0; }, []() { return 180; });
+  };
+
+  EXPECT_EQ(heading(Direction::SOUTH), 180);
+  EXPECT_THROW(heading(Direction::EAST), NoSuchItem);
+}